@@ -43,8 +43,11 @@
 from __future__ import print_function
 from __future__ import absolute_import
 
+import math
+
 import m5
 from m5.objects import *
+from m5.util import fatal
 from common.Caches import *
 from common import ObjectList
 
@@ -100,7 +103,10 @@ def config_cache(options, system):
     if options.l2cache and options.elastic_trace_en:
         fatal("When elastic trace is enabled, do not configure L2 caches.")
 
-    if options.l2cache:
+    num_l2_slices = getattr(options, "l2_slices", 1)
+    if options.l2cache and num_l2_slices > 1:
+        config_l2_slices(options, system, l2_cache_class, num_l2_slices)
+    elif options.l2cache:
         # Provide a clock for the L2 and the L1-to-L2 bus here as they
         # are not connected using addTwoLevelCacheHierarchy. Use the
         # same clock as the CPUs.
@@ -201,7 +207,20 @@ def config_cache(options, system):
                         ExternalCache("cpu%d.dcache" % i))
 
         system.cpu[i].createInterruptController()
-        if options.l2cache:
+        if options.l2cache and num_l2_slices > 1:
+            # each CPU reaches the slices through a router of its own,
+            # anything outside of the memory goes around the L2
+            system.cpu[i].l2_router = L2SliceRouter(
+                clk_domain = system.cpu_clk_domain)
+            for l2_xbar in system.tol2bus:
+                system.cpu[i].l2_router.master = l2_xbar.slave
+            system.cpu[i].l2_io_bridge = Bridge()
+            system.cpu[i].l2_router.default = \
+                system.cpu[i].l2_io_bridge.slave
+            system.cpu[i].l2_io_bridge.master = system.membus.slave
+            system.cpu[i].connectAllPorts(system.cpu[i].l2_router,
+                                          system.membus)
+        elif options.l2cache:
             system.cpu[i].connectAllPorts(system.tol2bus, system.membus)
         elif options.external_memory_system:
             system.cpu[i].connectUncachedPorts(system.membus)
@@ -210,6 +229,57 @@ def config_cache(options, system):
 
     return system
 
+def config_l2_slices(options, system, l2_cache_class, num_slices):
+    """
+    Split the L2 and the crossbar in front of it into slices. Each slice
+    is an L2XBar, with its own layers and snoop filter, and an L2 bank
+    that handle the part of the memory selected by hashing the address
+    bits right above the cache line offset. All the slices stay on the
+    event queue of the system.
+    """
+
+    intlv_bits = int(math.log(num_slices, 2))
+    if 2 ** intlv_bits != num_slices:
+        fatal("Number of L2 slices must be a power of 2")
+
+    intlv_low_bit = int(math.log(system.cache_line_size.value, 2))
+    # fold in the bits above a 1 MByte stride to spread strided
+    # accesses across the slices, as done for the memory channels
+    xor_high_bit = 20 + intlv_bits - 1
+
+    bank_size = MemorySize(options.l2_size).value // num_slices
+    sf_capacity = MemorySize(SnoopFilter.max_capacity).value // num_slices
+
+    l2_xbars = []
+    l2_banks = []
+    for i in range(num_slices):
+        ranges = [AddrRange(r.start, size = r.size(),
+                            intlvHighBit = intlv_low_bit + intlv_bits - 1,
+                            xorHighBit = xor_high_bit,
+                            intlvBits = intlv_bits,
+                            intlvMatch = i)
+                  for r in system.mem_ranges]
+
+        l2_xbar = L2XBar(clk_domain = system.cpu_clk_domain,
+                         snoop_filter = SnoopFilter(
+                             lookup_latency = 0,
+                             max_capacity = "%dB" % sf_capacity))
+        l2_bank = l2_cache_class(clk_domain = system.cpu_clk_domain,
+                                 size = "%dB" % bank_size,
+                                 assoc = options.l2_assoc,
+                                 addr_ranges = ranges)
+        l2_bank.cpu_side = l2_xbar.master
+        l2_bank.mem_side = system.membus.slave
+        if options.l2_hwp_type:
+            hwpClass = ObjectList.hwp_list.get(options.l2_hwp_type)
+            l2_bank.prefetcher = hwpClass()
+
+        l2_xbars.append(l2_xbar)
+        l2_banks.append(l2_bank)
+
+    system.tol2bus = l2_xbars
+    system.l2 = l2_banks
+
 # ExternalSlave provides a "port", but when that port connects to a cache,
 # the connecting CPU SimObject wants to refer to its "cpu_side".
 # The 'ExternalCache' class provides this adaptation by rewriting the name,
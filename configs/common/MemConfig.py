@@ -137,6 +137,7 @@ def config_mem(options, system):
     opt_dram_powerdown = getattr(options, "enable_dram_powerdown", None)
     opt_mem_channels_intlv = getattr(options, "mem_channels_intlv", 128)
     opt_xor_low_bit = getattr(options, "xor_low_bit", 0)
+    opt_mem_multi_channel = getattr(options, "mem_multi_channel", False)
 
     if opt_mem_type == "HMC_2500_1x32":
         HMChost = HMC.config_hmc_host_ctrl(options, system)
@@ -261,6 +262,19 @@ def config_mem(options, system):
     for i in range(len(nvm_intfs)):
         mem_ctrls[i].nvm = nvm_intfs[i];
 
+    if opt_mem_multi_channel:
+        if opt_mem_type in ("HMC_2500_1x32", "SimpleMemory"):
+            fatal("--mem-multi-channel is not supported with %s" %
+                  opt_mem_type)
+
+        # Hand the requests straight to the channels rather than
+        # routing them through the xbar
+        subsystem.mem_ctrls = mem_ctrls
+        subsystem.mem_channels_ctrl = \
+            m5.objects.MultiChannelMemCtrl(channels = mem_ctrls)
+        subsystem.mem_channels_ctrl.port = xbar.master
+        return
+
     # Connect the controller to the xbar port
     for i in range(len(mem_ctrls)):
         if opt_mem_type == "HMC_2500_1x32":
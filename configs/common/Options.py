@@ -115,6 +115,10 @@ def addNoISAOptions(parser):
                        help="Enable low-power states in DRAMInterface")
     parser.add_option("--mem-channels-intlv", type="int", default=0,
                       help="Memory channels interleave")
+    parser.add_option("--mem-multi-channel", action="store_true",
+                      help="Group the memory channels in a single "
+                      "multi-channel controller instead of connecting "
+                      "each of them to the memory bus")
 
 
     parser.add_option("--memchecker", action="store_true")
@@ -128,6 +132,9 @@ def addNoISAOptions(parser):
     parser.add_option("--l2cache", action="store_true", default=True)
     parser.add_option("--num-dirs", type="int", default=1)
     parser.add_option("--num-l2caches", type="int", default=1)
+    parser.add_option("--l2-slices", type="int", default=1,
+                      help="Number of slices of the classic L2 and its "
+                      "crossbar, interleaved by cache line (power of 2)")
     parser.add_option("--num-l3caches", type="int", default=1)
     parser.add_option("--l1d_size", type="string", default="32kB")
     parser.add_option("--l1i_size", type="string", default="32kB")
@@ -312,6 +319,12 @@ def addCommonOptions(parser):
         help="restore from a simpoint checkpoint taken with " +
              "--take-simpoint-checkpoints")
 
+    # Branch trace options
+    parser.add_option("--branch-trace-file", action="store", type="string",
+                      help="""Write the committed branches of every CPU to
+                              this file in the output directory, to be
+                              replayed with branch_trace_replay.py""")
+
     # Checkpointing options
     ###Note that performing checkpointing via python script files will override
     ###checkpoint instructions built into binaries.
@@ -81,6 +81,9 @@ parser.add_option("--addr-map", type="choice",
                   choices=ObjectList.dram_addr_map_list.get_names(),
                   default="RoRaBaCoCh", help = "DRAM address map policy")
 
+parser.add_option("--analytical", action="store_true", default=False,
+                  help = "Use the analytical DRAM timing model")
+
 (options, args) = parser.parse_args()
 
 if args:
@@ -126,6 +129,10 @@ system.mem_ctrls[0].dram.null = True
 # Set the address mapping based on input argument
 system.mem_ctrls[0].dram.addr_mapping = options.addr_map
 
+# optionally use the analytical timing model, e.g. to compare it
+# against the detailed model across the sweep
+system.mem_ctrls[0].dram.analytical = options.analytical
+
 # stay in each state for 0.25 ms, long enough to warm things up, and
 # short enough to avoid hitting a refresh
 period = 250000000
@@ -0,0 +1,84 @@
+# Copyright (c) 2020 The Regents of the University of California
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# Replays a branch trace captured with --branch-trace-file through a branch
+# predictor, without simulating a CPU, e.g.:
+#
+#   gem5.opt configs/example/branch_trace_replay.py --bp-type=TAGE_SC_L_64KB \
+#       m5out/system.cpu.branchTraceRecorder.branch_trace.pb.gz
+
+from __future__ import print_function
+from __future__ import absolute_import
+
+import optparse
+import sys
+
+import m5
+from m5.objects import *
+from m5.util import addToPath, fatal
+
+addToPath('../')
+
+from common import ObjectList
+
+parser = optparse.OptionParser(usage="%prog [options] <branch trace>")
+
+parser.add_option("--bp-type", type="choice", default="TAGE_SC_L_64KB",
+                  choices=ObjectList.bp_list.get_names(),
+                  help="type of branch predictor to evaluate")
+parser.add_option("--indirect-bp-type", type="choice", default=None,
+                  choices=ObjectList.indirect_bp_list.get_names(),
+                  help="type of indirect branch predictor to evaluate")
+parser.add_option("--max-branches", type="int", default=0,
+                  help="replay at most this many branches")
+parser.add_option("--update-delay", type="int", default=0,
+                  help="number of branches predicted before a prediction "
+                       "is committed to the predictor")
+
+(options, args) = parser.parse_args()
+
+if len(args) != 1:
+    parser.print_usage()
+    sys.exit(1)
+
+bpClass = ObjectList.bp_list.get(options.bp_type)
+replay = BranchTraceReplay(branchPred=bpClass(),
+                           traceFile=args[0],
+                           maxBranches=options.max_branches,
+                           updateDelay=options.update_delay)
+
+if options.indirect_bp_type:
+    indirectBPClass = \
+        ObjectList.indirect_bp_list.get(options.indirect_bp_type)
+    replay.branchPred.indirectBranchPred = indirectBPClass()
+
+root = Root(full_system=False, replay=replay)
+
+m5.instantiate()
+
+exit_event = m5.simulate()
+print('Exiting @ tick %i because %s' %
+      (m5.curTick(), exit_event.getCause()))
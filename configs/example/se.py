@@ -230,6 +230,10 @@ for i in range(np):
     if options.simpoint_profile:
         system.cpu[i].addSimPointProbe(options.simpoint_interval)
 
+    if options.branch_trace_file:
+        system.cpu[i].branchTraceRecorder = BranchTraceRecorder(
+            traceFile=options.branch_trace_file)
+
     if options.checker:
         system.cpu[i].addCheckerCpu()
 
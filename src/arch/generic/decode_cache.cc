@@ -40,16 +40,22 @@ StaticInstPtr
 BasicDecodeCache::decode(TheISA::Decoder *decoder,
         TheISA::ExtMachInst mach_inst, Addr addr)
 {
-    StaticInstPtr &si = decodePages.lookup(addr);
-    if (si && (si->machInst == mach_inst))
+    DecodeCache::Counts &counts = decoder->decodeCounts;
+
+    StaticInstPtr &si = decodePages.lookup(addr, decoder->recentDecodePages);
+    if (si && (si->machInst == mach_inst)) {
+        ++counts.addrHits;
         return si;
+    }
 
     auto iter = instMap.find(mach_inst);
     if (iter != instMap.end()) {
+        ++counts.instHits;
         si = iter->second;
         return si;
     }
 
+    ++counts.instMisses;
     si = decoder->decodeInst(mach_inst);
     instMap[mach_inst] = si;
     return si;
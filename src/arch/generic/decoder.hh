@@ -29,11 +29,20 @@
 #define __ARCH_GENERIC_DECODER_HH__
 
 #include "base/types.hh"
+#include "cpu/decode_cache.hh"
 #include "cpu/static_inst_fwd.hh"
 
 class InstDecoder
 {
   public:
+    /// Lookup counts of the decode caches used by this decoder.
+    DecodeCache::Counts decodeCounts;
+
+    /// Recently used pages of a decode cache shared with other decoders.
+    DecodeCache::AddrMap<StaticInstPtr>::Recent recentDecodePages;
+
+    InstDecoder() : recentDecodePages(decodeCounts) {}
+
     virtual StaticInstPtr fetchRomMicroop(
             MicroPC micropc, StaticInstPtr curMacroop);
 };
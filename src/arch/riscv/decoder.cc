@@ -81,13 +81,16 @@ Decoder::decode(ExtMachInst mach_inst, Addr addr)
 {
     DPRINTF(Decode, "Decoding instruction 0x%08x at address %#x\n",
             mach_inst, addr);
-    if (instMap.find(mach_inst) != instMap.end())
-        return instMap[mach_inst];
-    else {
-        StaticInstPtr si = decodeInst(mach_inst);
-        instMap[mach_inst] = si;
-        return si;
+    auto iter = instMap.find(mach_inst);
+    if (iter != instMap.end()) {
+        ++decodeCounts.instHits;
+        return iter->second;
     }
+
+    ++decodeCounts.instMisses;
+    StaticInstPtr si = decodeInst(mach_inst);
+    instMap[mach_inst] = si;
+    return si;
 }
 
 StaticInstPtr
@@ -44,7 +44,7 @@ Decoder::doResetState()
 {
     origPC = basePC + offset;
     DPRINTF(Decoder, "Setting origPC to %#x\n", origPC);
-    instBytes = &decodePages->lookup(origPC);
+    instBytes = &decodePages->lookup(origPC, recentPages);
     chunkIdx = 0;
 
     emi.rex = 0;
@@ -675,9 +675,12 @@ StaticInstPtr
 Decoder::decode(ExtMachInst mach_inst, Addr addr)
 {
     auto iter = instMap->find(mach_inst);
-    if (iter != instMap->end())
+    if (iter != instMap->end()) {
+        ++decodeCounts.instHits;
         return iter->second;
+    }
 
+    ++decodeCounts.instMisses;
     StaticInstPtr si = decodeInst(mach_inst);
     (*instMap)[mach_inst] = si;
     return si;
@@ -692,8 +695,10 @@ Decoder::decode(PCState &nextPC)
     updateNPC(nextPC);
 
     StaticInstPtr &si = instBytes->si;
-    if (si)
+    if (si) {
+        ++decodeCounts.addrHits;
         return si;
+    }
 
     // We didn't match in the AddrMap, but we still populated an entry. Fix
     // up its byte masks.
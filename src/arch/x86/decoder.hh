@@ -233,6 +233,7 @@ class Decoder : public InstDecoder
 
     typedef DecodeCache::AddrMap<Decoder::InstBytes> DecodePages;
     DecodePages *decodePages = nullptr;
+    DecodePages::Recent recentPages{decodeCounts};
     typedef std::unordered_map<CacheKey, DecodePages *> AddrCacheMap;
     AddrCacheMap addrCacheMap;
 
@@ -269,6 +270,7 @@ class Decoder : public InstDecoder
             decodePages = new DecodePages;
             addrCacheMap[m5Reg] = decodePages;
         }
+        recentPages.clear();
 
         InstCacheMap::iterator imIter = instCacheMap.find(m5Reg);
         if (imIter != instCacheMap.end()) {
@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2020 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BASE_INTRUSIVE_LIST_HH__
+#define __BASE_INTRUSIVE_LIST_HH__
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+
+template <class Ptr>
+class IntrusiveList;
+
+/**
+ * Links of an element of an IntrusiveList. An element derives from the
+ * hook to be put on a list, and can be on a single list at a time.
+ *
+ * @tparam Ptr Pointer type the list holds the elements with, e.g. a
+ *             RefCountingPtr. The list keeps a pointer to every element
+ *             on it, so a reference counted element stays alive until
+ *             it is erased.
+ */
+template <class Ptr>
+class IntrusiveListHook
+{
+  public:
+    IntrusiveListHook() : _listPrev(nullptr), _listNext(nullptr) {}
+
+    /** The hook is not copied along with the element. */
+    IntrusiveListHook(const IntrusiveListHook &)
+        : _listPrev(nullptr), _listNext(nullptr)
+    {}
+
+    IntrusiveListHook &operator=(const IntrusiveListHook &) { return *this; }
+
+    /** Is the element on a list? */
+    bool onList() const { return _listNext != nullptr; }
+
+  private:
+    friend class IntrusiveList<Ptr>;
+
+    /** Pointer the list holds the element with */
+    Ptr _listRef;
+
+    IntrusiveListHook *_listPrev;
+    IntrusiveListHook *_listNext;
+};
+
+/**
+ * A doubly linked list whose links are embedded in its elements, so
+ * that adding and removing an element does not allocate. The interface
+ * follows std::list, and as with std::list the iterator to an element
+ * stays valid until the element is erased. An iterator to an element
+ * on the list can also be made from the element itself.
+ *
+ * @tparam Ptr Pointer type of the elements, which must derive from
+ *             IntrusiveListHook<Ptr>.
+ */
+template <class Ptr>
+class IntrusiveList
+{
+  public:
+    typedef IntrusiveListHook<Ptr> Hook;
+
+    class iterator
+    {
+      public:
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef Ptr value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const Ptr *pointer;
+        typedef const Ptr &reference;
+
+        iterator() : hook(nullptr) {}
+
+        reference operator*() const { return hook->_listRef; }
+        pointer operator->() const { return &hook->_listRef; }
+
+        iterator &operator++() { hook = hook->_listNext; return *this; }
+        iterator &operator--() { hook = hook->_listPrev; return *this; }
+
+        iterator
+        operator++(int)
+        {
+            iterator it = *this;
+            hook = hook->_listNext;
+            return it;
+        }
+
+        iterator
+        operator--(int)
+        {
+            iterator it = *this;
+            hook = hook->_listPrev;
+            return it;
+        }
+
+        bool operator==(const iterator &it) const { return hook == it.hook; }
+        bool operator!=(const iterator &it) const { return hook != it.hook; }
+
+      private:
+        friend class IntrusiveList;
+
+        explicit iterator(Hook *_hook) : hook(_hook) {}
+
+        Hook *hook;
+    };
+
+    IntrusiveList() : _size(0)
+    {
+        head._listPrev = &head;
+        head._listNext = &head;
+    }
+
+    IntrusiveList(const IntrusiveList &) = delete;
+    IntrusiveList &operator=(const IntrusiveList &) = delete;
+
+    ~IntrusiveList() { clear(); }
+
+    iterator begin() { return iterator(head._listNext); }
+    iterator end() { return iterator(&head); }
+
+    bool empty() const { return _size == 0; }
+    size_t size() const { return _size; }
+
+    const Ptr &front() const { return head._listNext->_listRef; }
+    const Ptr &back() const { return head._listPrev->_listRef; }
+
+    /**
+     * Iterator to an element on the list.
+     *
+     * @param elem Element, which must be on this list
+     */
+    static iterator
+    iteratorTo(Hook &elem)
+    {
+        assert(elem.onList());
+        return iterator(&elem);
+    }
+
+    /** Insert an element before pos. */
+    iterator
+    insert(iterator pos, const Ptr &elem)
+    {
+        Hook *hook = &static_cast<Hook &>(*elem);
+        assert(!hook->onList());
+
+        hook->_listRef = elem;
+        hook->_listNext = pos.hook;
+        hook->_listPrev = pos.hook->_listPrev;
+        pos.hook->_listPrev->_listNext = hook;
+        pos.hook->_listPrev = hook;
+        ++_size;
+
+        return iterator(hook);
+    }
+
+    void push_back(const Ptr &elem) { insert(end(), elem); }
+    void push_front(const Ptr &elem) { insert(begin(), elem); }
+
+    /**
+     * Remove an element from the list.
+     *
+     * @return Iterator to the element after it
+     */
+    iterator
+    erase(iterator pos)
+    {
+        Hook *hook = pos.hook;
+        assert(hook != &head);
+
+        Hook *next = hook->_listNext;
+        hook->_listPrev->_listNext = next;
+        next->_listPrev = hook->_listPrev;
+        hook->_listPrev = nullptr;
+        hook->_listNext = nullptr;
+        --_size;
+
+        // Dropping the reference may destroy the element and its hook
+        Ptr elem;
+        std::swap(elem, hook->_listRef);
+
+        return iterator(next);
+    }
+
+    void pop_front() { erase(begin()); }
+    void pop_back() { erase(iterator(head._listPrev)); }
+
+    void
+    clear()
+    {
+        while (!empty())
+            pop_back();
+    }
+
+  private:
+    /** Sentinel of the circular list of hooks */
+    Hook head;
+
+    size_t _size;
+};
+
+#endif // __BASE_INTRUSIVE_LIST_HH__
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2020 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "base/intrusive_list.hh"
+#include "base/refcnt.hh"
+
+namespace
+{
+
+class Elem : public RefCounted,
+             public IntrusiveListHook<RefCountingPtr<Elem>>
+{
+  public:
+    Elem(int _value, int &_live) : value(_value), live(_live) { ++live; }
+    ~Elem() { --live; }
+
+    const int value;
+
+  private:
+    int &live;
+};
+
+typedef RefCountingPtr<Elem> ElemPtr;
+typedef IntrusiveList<ElemPtr> ElemList;
+
+std::vector<int>
+values(ElemList &list)
+{
+    std::vector<int> result;
+    for (auto it = list.begin(); it != list.end(); ++it)
+        result.push_back((*it)->value);
+    return result;
+}
+
+} // anonymous namespace
+
+/** A new list is empty */
+TEST(IntrusiveListTest, Empty)
+{
+    ElemList list;
+
+    ASSERT_TRUE(list.empty());
+    ASSERT_EQ(list.size(), 0);
+    ASSERT_TRUE(list.begin() == list.end());
+}
+
+/** Elements are kept in insertion order */
+TEST(IntrusiveListTest, PushBackFront)
+{
+    int live = 0;
+    ElemList list;
+
+    list.push_back(new Elem(1, live));
+    list.push_back(new Elem(2, live));
+    list.push_front(new Elem(0, live));
+
+    ASSERT_EQ(list.size(), 3);
+    ASSERT_EQ(list.front()->value, 0);
+    ASSERT_EQ(list.back()->value, 2);
+    ASSERT_EQ(values(list), std::vector<int>({0, 1, 2}));
+    ASSERT_EQ((*--list.end())->value, 2);
+}
+
+/** The list holds a reference to its elements */
+TEST(IntrusiveListTest, Lifetime)
+{
+    int live = 0;
+    {
+        ElemList list;
+        ElemPtr elem = new Elem(0, live);
+        list.push_back(elem);
+        list.push_back(new Elem(1, live));
+
+        ASSERT_TRUE(elem->onList());
+        elem = nullptr;
+        ASSERT_EQ(live, 2);
+
+        list.pop_front();
+        ASSERT_EQ(live, 1);
+    }
+
+    // Destroying the list releases the remaining elements
+    ASSERT_EQ(live, 0);
+}
+
+/** Erasing returns the next element and keeps other iterators valid */
+TEST(IntrusiveListTest, Erase)
+{
+    int live = 0;
+    ElemList list;
+    std::vector<ElemList::iterator> its;
+
+    for (int i = 0; i < 5; ++i) {
+        list.push_back(new Elem(i, live));
+        its.push_back(--list.end());
+    }
+
+    auto next = list.erase(its[2]);
+    ASSERT_EQ((*next)->value, 3);
+    ASSERT_EQ(values(list), std::vector<int>({0, 1, 3, 4}));
+
+    list.erase(its[4]);
+    list.erase(its[0]);
+    ASSERT_EQ(values(list), std::vector<int>({1, 3}));
+    ASSERT_EQ(live, 2);
+
+    list.clear();
+    ASSERT_TRUE(list.empty());
+    ASSERT_EQ(live, 0);
+}
+
+/** An iterator can be made from an element on the list */
+TEST(IntrusiveListTest, IteratorTo)
+{
+    int live = 0;
+    ElemList list;
+    ElemPtr elem = new Elem(1, live);
+
+    list.push_back(new Elem(0, live));
+    list.push_back(elem);
+    list.push_back(new Elem(2, live));
+
+    auto it = ElemList::iteratorTo(*elem);
+    ASSERT_TRUE(*it == elem);
+    ASSERT_EQ((*--it)->value, 0);
+
+    list.erase(ElemList::iteratorTo(*elem));
+    ASSERT_FALSE(elem->onList());
+    ASSERT_EQ(values(list), std::vector<int>({0, 2}));
+
+    // An element can be put on a list again once erased
+    list.push_front(elem);
+    ASSERT_EQ(values(list), std::vector<int>({1, 0, 2}));
+}
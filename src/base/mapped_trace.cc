@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2020 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "base/mapped_trace.hh"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include "base/logging.hh"
+
+const char MappedTrace::Magic[8] = { 'g', 'e', 'm', '5', 'm', 't', 'r', 'c' };
+
+namespace
+{
+
+/** Return a column of n elements and advance the offset past it. */
+template <class T>
+const T *
+column(const uint8_t *data, size_t &offset, size_t n)
+{
+    const T *col = reinterpret_cast<const T *>(data + offset);
+    offset += n * sizeof(T);
+    return col;
+}
+
+} // anonymous namespace
+
+MappedTrace::PacketBlock::PacketBlock(const MappedTrace &trace,
+                                      uint64_t block)
+    : index(&trace.block(block))
+{
+    const uint8_t *data = trace.blockData(block);
+    const size_t n = index->numRecords;
+
+    size_t offset = 0;
+    _addr = column<uint64_t>(data, offset, n);
+    _pc = column<uint64_t>(data, offset, n);
+    _id = column<uint64_t>(data, offset, n);
+    _tick = column<uint32_t>(data, offset, n);
+    _size = column<uint32_t>(data, offset, n);
+    _flags = column<uint32_t>(data, offset, n);
+    _cmd = column<uint8_t>(data, offset, n);
+
+    fatal_if(offset > index->size, "Block %d of trace %s is truncated.\n",
+             block, trace.fileName);
+}
+
+MappedTrace::InstDepBlock::InstDepBlock(const MappedTrace &trace,
+                                        uint64_t block)
+    : index(&trace.block(block))
+{
+    const uint8_t *data = trace.blockData(block);
+    const size_t n = index->numRecords;
+
+    size_t offset = 0;
+    _compDelay = column<uint64_t>(data, offset, n);
+    _physAddr = column<uint64_t>(data, offset, n);
+    _virtAddr = column<uint64_t>(data, offset, n);
+    _pc = column<uint64_t>(data, offset, n);
+    _seqNum = column<uint32_t>(data, offset, n);
+    _size = column<uint32_t>(data, offset, n);
+    _flags = column<uint32_t>(data, offset, n);
+    _weight = column<uint32_t>(data, offset, n);
+    _asid = column<uint32_t>(data, offset, n);
+    _robDepStart = column<uint32_t>(data, offset, n + 1);
+    _regDepStart = column<uint32_t>(data, offset, n + 1);
+
+    // The sizes of the dependency columns are only known once the start
+    // columns are known to be within the block.
+    fatal_if(offset > index->size, "Block %d of trace %s is truncated.\n",
+             block, trace.fileName);
+    for (size_t i = 0; i < n; ++i) {
+        fatal_if(_robDepStart[i] > _robDepStart[i + 1] ||
+                 _regDepStart[i] > _regDepStart[i + 1],
+                 "Block %d of trace %s has corrupt dependencies.\n",
+                 block, trace.fileName);
+    }
+    fatal_if(_robDepStart[0] != 0 || _regDepStart[0] != 0,
+             "Block %d of trace %s has corrupt dependencies.\n",
+             block, trace.fileName);
+
+    _robDep = column<uint32_t>(data, offset, _robDepStart[n]);
+    _regDep = column<uint32_t>(data, offset, _regDepStart[n]);
+    _type = column<uint8_t>(data, offset, n);
+
+    fatal_if(offset > index->size, "Block %d of trace %s is truncated.\n",
+             block, trace.fileName);
+}
+
+MappedTrace::MappedTrace(const std::string &filename, Kind kind)
+    : fileName(filename), data(nullptr), length(0), header(nullptr),
+      index(nullptr)
+{
+    const uint16_t endian_test = 1;
+    fatal_if(*reinterpret_cast<const uint8_t *>(&endian_test) != 1,
+             "Mapped traces are only supported on little endian hosts.\n");
+
+    int fd = open(filename.c_str(), O_RDONLY);
+    fatal_if(fd < 0, "Could not open %s for reading.\n", filename);
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        fatal("Could not stat %s.\n", filename);
+    }
+    length = st.st_size;
+    if (length < sizeof(FileHeader)) {
+        close(fd);
+        fatal("Trace %s is too short to be a mapped trace.\n", filename);
+    }
+
+    void *map = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    fatal_if(map == MAP_FAILED, "Could not map trace %s.\n", filename);
+    data = static_cast<const uint8_t *>(map);
+
+    header = reinterpret_cast<const FileHeader *>(data);
+    fatal_if(memcmp(header->magic, Magic, sizeof(Magic)) != 0,
+             "Trace %s is not a mapped trace.\n", filename);
+    fatal_if(header->version != Version,
+             "Trace %s has unsupported version %d.\n", filename,
+             header->version);
+    fatal_if(header->kind != kind,
+             "Trace %s has records of type %d, expected type %d.\n",
+             filename, header->kind, kind);
+
+    fatal_if(header->indexOffset % sizeof(uint64_t) != 0 ||
+             header->indexOffset > length ||
+             header->numBlocks >
+             (length - header->indexOffset) / sizeof(BlockIndex),
+             "Trace %s has a corrupt block index.\n", filename);
+    index = reinterpret_cast<const BlockIndex *>(data + header->indexOffset);
+
+    // Check that the blocks tile the records, so that seeking only has
+    // to look at the index.
+    uint64_t records = 0;
+    for (uint64_t i = 0; i < header->numBlocks; ++i) {
+        fatal_if(index[i].firstRecord != records ||
+                 index[i].numRecords == 0 ||
+                 index[i].numRecords > header->blockRecords,
+                 "Trace %s has a corrupt block index.\n", filename);
+        records += index[i].numRecords;
+        blockData(i);
+    }
+    fatal_if(records != header->numRecords,
+             "Trace %s has a corrupt block index.\n", filename);
+
+    madvise(map, length, MADV_SEQUENTIAL);
+}
+
+MappedTrace::~MappedTrace()
+{
+    if (data)
+        munmap(const_cast<uint8_t *>(data), length);
+}
+
+bool
+MappedTrace::isMappedTrace(const std::string &filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    char magic[sizeof(Magic)];
+    return file.read(magic, sizeof(magic)) &&
+        memcmp(magic, Magic, sizeof(Magic)) == 0;
+}
+
+uint64_t
+MappedTrace::findRecord(uint64_t record) const
+{
+    if (record >= numRecords())
+        return numBlocks();
+
+    auto it = std::upper_bound(index, index + numBlocks(), record,
+                               [](uint64_t r, const BlockIndex &b) {
+                                   return r < b.firstRecord;
+                               });
+    return it - index - 1;
+}
+
+uint64_t
+MappedTrace::findKey(uint64_t key) const
+{
+    auto it = std::upper_bound(index, index + numBlocks(), key,
+                               [](uint64_t k, const BlockIndex &b) {
+                                   return k < b.firstKey;
+                               });
+    return it == index ? 0 : it - index - 1;
+}
+
+const uint8_t *
+MappedTrace::blockData(uint64_t i) const
+{
+    const BlockIndex &b = index[i];
+    fatal_if(b.offset % sizeof(uint64_t) != 0 ||
+             b.offset < sizeof(FileHeader) ||
+             b.offset > header->indexOffset ||
+             b.size > header->indexOffset - b.offset,
+             "Block %d of trace %s is out of bounds.\n", i, fileName);
+    return data + b.offset;
+}
@@ -0,0 +1,347 @@
+/*
+ * Copyright (c) 2020 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * A memory-mapped, seekable binary trace format for packet traces and
+ * elastic instruction dependency traces.
+ *
+ * The format is an alternative to the protobuf streams described in
+ * packet.proto and inst_dep_record.proto. The records are stored in
+ * blocks of fixed-width, delta-encoded columns, and a block index at the
+ * end of the file records the first key of every block. Records can
+ * therefore be decoded straight from the mapped file, and a reader can
+ * start at any tick (packet traces) or sequence number (dependency
+ * traces) by a binary search over the index. util/mapped_trace.py
+ * converts protobuf traces to and from this format.
+ *
+ * All fields are little endian. A file starts with a FileHeader,
+ * followed by the blocks and the BlockIndex array at indexOffset. Every
+ * block starts at an eight byte aligned offset, and its columns are
+ * stored back to back, widest first, so that every column is naturally
+ * aligned. For a block of n records the columns are:
+ *
+ * Packet trace:
+ *   uint64_t addr[n], pc[n], id[n];
+ *   uint32_t tick[n], size[n], flags[n];
+ *   uint8_t cmd[n];
+ *
+ * Dependency trace:
+ *   uint64_t compDelay[n], physAddr[n], virtAddr[n], pc[n];
+ *   uint32_t seqNum[n], size[n], flags[n], weight[n], asid[n];
+ *   uint32_t robDepStart[n + 1], regDepStart[n + 1];
+ *   uint32_t robDep[robDepStart[n]], regDep[regDepStart[n]];
+ *   uint8_t type[n];
+ *
+ * Ticks and sequence numbers are stored as the difference to the first
+ * key of the block, and the dependencies of a record as the difference
+ * to its own sequence number. Optional protobuf fields that are absent
+ * are stored as zero.
+ */
+
+#ifndef __BASE_MAPPED_TRACE_HH__
+#define __BASE_MAPPED_TRACE_HH__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class MappedTrace
+{
+  public:
+    /** Type of the records in a trace. */
+    enum Kind : uint32_t
+    {
+        PacketTrace = 1,
+        InstDepTrace = 2,
+    };
+
+    /** Version of the format written by this code. */
+    static const uint32_t Version = 1;
+
+    /** Magic number at the start of every mapped trace. */
+    static const char Magic[8];
+
+    struct FileHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t kind;
+        uint64_t tickFreq;
+        /** Window size of a dependency trace, zero otherwise. */
+        uint32_t windowSize;
+        /** Maximum number of records in a block. */
+        uint32_t blockRecords;
+        uint64_t numRecords;
+        uint64_t numBlocks;
+        uint64_t indexOffset;
+        uint64_t reserved;
+    };
+
+    struct BlockIndex
+    {
+        /** Tick or sequence number of the first record. */
+        uint64_t firstKey;
+        /** Position of the first record in the trace. */
+        uint64_t firstRecord;
+        /** Offset of the block from the start of the file. */
+        uint64_t offset;
+        uint32_t numRecords;
+        /** Size of the block in bytes. */
+        uint32_t size;
+    };
+
+    /** Decoded view of a block of a packet trace. */
+    class PacketBlock
+    {
+      public:
+        PacketBlock() : index(nullptr) {}
+        PacketBlock(const MappedTrace &trace, uint64_t block);
+
+        uint32_t size() const { return index ? index->numRecords : 0; }
+
+        uint64_t tick(uint32_t i) const
+        {
+            return index->firstKey + _tick[i];
+        }
+        uint32_t cmd(uint32_t i) const { return _cmd[i]; }
+        uint64_t addr(uint32_t i) const { return _addr[i]; }
+        uint32_t blockSize(uint32_t i) const { return _size[i]; }
+        uint32_t flags(uint32_t i) const { return _flags[i]; }
+        uint64_t pc(uint32_t i) const { return _pc[i]; }
+        uint64_t id(uint32_t i) const { return _id[i]; }
+
+        /** The key used to seek in a packet trace is the tick. */
+        uint64_t key(uint32_t i) const { return tick(i); }
+
+      private:
+        const BlockIndex *index;
+        const uint64_t *_addr;
+        const uint64_t *_pc;
+        const uint64_t *_id;
+        const uint32_t *_tick;
+        const uint32_t *_size;
+        const uint32_t *_flags;
+        const uint8_t *_cmd;
+    };
+
+    /** Decoded view of a block of a dependency trace. */
+    class InstDepBlock
+    {
+      public:
+        InstDepBlock() : index(nullptr) {}
+        InstDepBlock(const MappedTrace &trace, uint64_t block);
+
+        uint32_t size() const { return index ? index->numRecords : 0; }
+
+        uint64_t seqNum(uint32_t i) const
+        {
+            return index->firstKey + _seqNum[i];
+        }
+        uint32_t type(uint32_t i) const { return _type[i]; }
+        uint64_t compDelay(uint32_t i) const { return _compDelay[i]; }
+        uint64_t physAddr(uint32_t i) const { return _physAddr[i]; }
+        uint64_t virtAddr(uint32_t i) const { return _virtAddr[i]; }
+        uint32_t accessSize(uint32_t i) const { return _size[i]; }
+        uint32_t flags(uint32_t i) const { return _flags[i]; }
+        uint32_t weight(uint32_t i) const { return _weight[i]; }
+        uint32_t asid(uint32_t i) const { return _asid[i]; }
+        uint64_t pc(uint32_t i) const { return _pc[i]; }
+
+        uint32_t
+        numRobDeps(uint32_t i) const
+        {
+            return _robDepStart[i + 1] - _robDepStart[i];
+        }
+        uint64_t
+        robDep(uint32_t i, uint32_t j) const
+        {
+            return seqNum(i) - _robDep[_robDepStart[i] + j];
+        }
+
+        uint32_t
+        numRegDeps(uint32_t i) const
+        {
+            return _regDepStart[i + 1] - _regDepStart[i];
+        }
+        uint64_t
+        regDep(uint32_t i, uint32_t j) const
+        {
+            return seqNum(i) - _regDep[_regDepStart[i] + j];
+        }
+
+        /** The key used to seek in a dependency trace is the seq. num. */
+        uint64_t key(uint32_t i) const { return seqNum(i); }
+
+      private:
+        const BlockIndex *index;
+        const uint64_t *_compDelay;
+        const uint64_t *_physAddr;
+        const uint64_t *_virtAddr;
+        const uint64_t *_pc;
+        const uint32_t *_seqNum;
+        const uint32_t *_size;
+        const uint32_t *_flags;
+        const uint32_t *_weight;
+        const uint32_t *_asid;
+        const uint32_t *_robDepStart;
+        const uint32_t *_regDepStart;
+        const uint32_t *_robDep;
+        const uint32_t *_regDep;
+        const uint8_t *_type;
+    };
+
+    /**
+     * Sequential reader over the records of a trace. The position can be
+     * moved to any record or key, e.g., to replay a shard of a trace.
+     */
+    template <class Block>
+    class Cursor
+    {
+      public:
+        Cursor(const MappedTrace &trace)
+            : trace(trace), blockIdx(0), pos(0)
+        {
+            load();
+        }
+
+        /** Is the cursor pointing at a record? */
+        bool valid() const { return pos < block.size(); }
+
+        /** The block of the current record. */
+        const Block &current() const { return block; }
+
+        /** Index of the current record in its block. */
+        uint32_t index() const { return pos; }
+
+        /** Position of the current record in the trace. */
+        uint64_t
+        record() const
+        {
+            return blockIdx < trace.numBlocks() ?
+                trace.block(blockIdx).firstRecord + pos : trace.numRecords();
+        }
+
+        /** Move to the next record. */
+        void
+        next()
+        {
+            if (++pos == block.size() && blockIdx < trace.numBlocks()) {
+                ++blockIdx;
+                pos = 0;
+                load();
+            }
+        }
+
+        /** Move to the given record, or past the end. */
+        void
+        seekRecord(uint64_t record)
+        {
+            blockIdx = trace.findRecord(record);
+            load();
+            pos = blockIdx < trace.numBlocks() ?
+                record - trace.block(blockIdx).firstRecord : 0;
+        }
+
+        /**
+         * Move to the first record whose key is not less than the given
+         * one. This assumes that the keys increase through the trace.
+         */
+        void
+        seekKey(uint64_t key)
+        {
+            blockIdx = trace.findKey(key);
+            load();
+            pos = 0;
+            while (valid() && block.key(pos) < key)
+                next();
+        }
+
+      private:
+        void
+        load()
+        {
+            block = blockIdx < trace.numBlocks() ?
+                Block(trace, blockIdx) : Block();
+        }
+
+        const MappedTrace &trace;
+        uint64_t blockIdx;
+        uint32_t pos;
+        Block block;
+    };
+
+    typedef Cursor<PacketBlock> PacketCursor;
+    typedef Cursor<InstDepBlock> InstDepCursor;
+
+    /**
+     * Map a trace file. Fails if the file cannot be mapped or is not a
+     * valid trace of the expected kind.
+     *
+     * @param filename Path to the trace
+     * @param kind Expected type of the records
+     */
+    MappedTrace(const std::string &filename, Kind kind);
+    ~MappedTrace();
+
+    MappedTrace(const MappedTrace &) = delete;
+    MappedTrace &operator=(const MappedTrace &) = delete;
+
+    /** Does the file start with the magic number of a mapped trace? */
+    static bool isMappedTrace(const std::string &filename);
+
+    Kind kind() const { return static_cast<Kind>(header->kind); }
+    uint64_t tickFreq() const { return header->tickFreq; }
+    uint32_t windowSize() const { return header->windowSize; }
+    uint64_t numRecords() const { return header->numRecords; }
+    uint64_t numBlocks() const { return header->numBlocks; }
+    const BlockIndex &block(uint64_t i) const { return index[i]; }
+
+    /** Find the block holding a record, or numBlocks() past the end. */
+    uint64_t findRecord(uint64_t record) const;
+
+    /**
+     * Find the block where a search for the first record with a key not
+     * less than the given one has to start.
+     */
+    uint64_t findKey(uint64_t key) const;
+
+  private:
+    /** Return a pointer to a block after checking its bounds. */
+    const uint8_t *blockData(uint64_t i) const;
+
+    const std::string fileName;
+
+    const uint8_t *data;
+    size_t length;
+
+    const FileHeader *header;
+    const BlockIndex *index;
+};
+
+#endif // __BASE_MAPPED_TRACE_HH__
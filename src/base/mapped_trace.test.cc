@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) 2020 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "base/mapped_trace.hh"
+
+namespace
+{
+
+/** A packet record as written by the test writer. */
+struct Packet
+{
+    uint64_t tick;
+    uint32_t cmd;
+    uint64_t addr;
+    uint32_t size;
+};
+
+/** A dependency record as written by the test writer. */
+struct InstDep
+{
+    uint64_t seqNum;
+    uint32_t type;
+    uint64_t compDelay;
+    std::vector<uint64_t> robDeps;
+    std::vector<uint64_t> regDeps;
+};
+
+template <class T>
+void
+append(std::vector<uint8_t> &buf, const T &val)
+{
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(&val);
+    buf.insert(buf.end(), p, p + sizeof(T));
+}
+
+void
+pad(std::vector<uint8_t> &buf)
+{
+    while (buf.size() % 8)
+        buf.push_back(0);
+}
+
+/**
+ * Write a trace with the given blocks, the way util/mapped_trace.py
+ * lays them out.
+ */
+class TraceWriter
+{
+  public:
+    TraceWriter(MappedTrace::Kind kind, uint32_t block_records)
+        : kind(kind), blockRecords(block_records), numRecords(0),
+          buf(sizeof(MappedTrace::FileHeader))
+    {}
+
+    void
+    addBlock(const std::vector<Packet> &pkts)
+    {
+        const uint64_t first = pkts.front().tick;
+        const size_t start = beginBlock(first, pkts.size());
+        for (const auto &p : pkts) append(buf, p.addr);
+        for (const auto &p : pkts) append(buf, p.addr + 1); // pc
+        for (const auto &p : pkts) append(buf, p.addr + 2); // id
+        for (const auto &p : pkts) append(buf, uint32_t(p.tick - first));
+        for (const auto &p : pkts) append(buf, p.size);
+        for (const auto &p : pkts) append(buf, uint32_t(p.size + 3));
+        for (const auto &p : pkts) append(buf, uint8_t(p.cmd));
+        endBlock(start);
+    }
+
+    void
+    addBlock(const std::vector<InstDep> &recs)
+    {
+        const uint64_t first = recs.front().seqNum;
+        const size_t start = beginBlock(first, recs.size());
+        for (const auto &r : recs) append(buf, r.compDelay);
+        for (const auto &r : recs) append(buf, r.seqNum * 64); // physAddr
+        for (const auto &r : recs) append(buf, r.seqNum * 32); // virtAddr
+        for (const auto &r : recs) append(buf, r.seqNum * 4); // pc
+        for (const auto &r : recs) append(buf, uint32_t(r.seqNum - first));
+        for (const auto &r : recs) append(buf, uint32_t(r.type * 4)); // size
+        for (const auto &r : recs) append(buf, r.type); // flags
+        for (const auto &r : recs) append(buf, uint32_t(r.seqNum % 3));
+        for (const auto &r : recs) append(buf, uint32_t(r.seqNum % 2));
+        uint32_t rob = 0, reg = 0;
+        append(buf, rob);
+        for (const auto &r : recs) append(buf, rob += r.robDeps.size());
+        append(buf, reg);
+        for (const auto &r : recs) append(buf, reg += r.regDeps.size());
+        for (const auto &r : recs)
+            for (auto d : r.robDeps) append(buf, uint32_t(r.seqNum - d));
+        for (const auto &r : recs)
+            for (auto d : r.regDeps) append(buf, uint32_t(r.seqNum - d));
+        for (const auto &r : recs) append(buf, uint8_t(r.type));
+        endBlock(start);
+    }
+
+    /** Write the file and return its name. */
+    std::string
+    write()
+    {
+        MappedTrace::FileHeader header = {};
+        std::copy(MappedTrace::Magic, MappedTrace::Magic + 8, header.magic);
+        header.version = MappedTrace::Version;
+        header.kind = kind;
+        header.tickFreq = 1000000000000;
+        header.windowSize = kind == MappedTrace::InstDepTrace ? 64 : 0;
+        header.blockRecords = blockRecords;
+        header.numRecords = numRecords;
+        header.numBlocks = index.size();
+        header.indexOffset = buf.size();
+        for (const auto &b : index)
+            append(buf, b);
+        std::copy(reinterpret_cast<const uint8_t *>(&header),
+                  reinterpret_cast<const uint8_t *>(&header + 1),
+                  buf.begin());
+
+        char name[] = "/tmp/mapped_trace.test.XXXXXX";
+        int fd = mkstemp(name);
+        EXPECT_GE(fd, 0);
+        EXPECT_EQ(::write(fd, buf.data(), buf.size()), buf.size());
+        close(fd);
+        return name;
+    }
+
+  private:
+    size_t
+    beginBlock(uint64_t first_key, size_t n)
+    {
+        index.push_back({first_key, numRecords, buf.size(), uint32_t(n), 0});
+        numRecords += n;
+        return buf.size();
+    }
+
+    void
+    endBlock(size_t start)
+    {
+        pad(buf);
+        index.back().size = buf.size() - start;
+    }
+
+    const MappedTrace::Kind kind;
+    const uint32_t blockRecords;
+    uint64_t numRecords;
+    std::vector<uint8_t> buf;
+    std::vector<MappedTrace::BlockIndex> index;
+};
+
+/** Three blocks of packets with ticks 100, 110, ..., 190. */
+std::string
+writePacketTrace()
+{
+    TraceWriter writer(MappedTrace::PacketTrace, 4);
+    std::vector<Packet> pkts;
+    for (uint64_t i = 0; i < 10; ++i) {
+        pkts.push_back({100 + 10 * i, uint32_t(1 + i % 2), 0x1000 + 64 * i,
+                        uint32_t(4 << (i % 3))});
+        if (pkts.size() == 4 || i == 9) {
+            writer.addBlock(pkts);
+            pkts.clear();
+        }
+    }
+    return writer.write();
+}
+
+} // anonymous namespace
+
+TEST(MappedTraceTest, IsMappedTrace)
+{
+    std::string name = writePacketTrace();
+    EXPECT_TRUE(MappedTrace::isMappedTrace(name));
+    EXPECT_FALSE(MappedTrace::isMappedTrace("/dev/null"));
+    EXPECT_FALSE(MappedTrace::isMappedTrace("/nonexistent/trace"));
+    unlink(name.c_str());
+}
+
+TEST(MappedTraceTest, ReadPackets)
+{
+    std::string name = writePacketTrace();
+    MappedTrace trace(name, MappedTrace::PacketTrace);
+    EXPECT_EQ(trace.tickFreq(), 1000000000000);
+    EXPECT_EQ(trace.numRecords(), 10);
+    EXPECT_EQ(trace.numBlocks(), 3);
+
+    MappedTrace::PacketCursor cursor(trace);
+    for (uint64_t i = 0; i < 10; ++i) {
+        ASSERT_TRUE(cursor.valid());
+        EXPECT_EQ(cursor.record(), i);
+        const auto &block = cursor.current();
+        const uint32_t j = cursor.index();
+        EXPECT_EQ(block.tick(j), 100 + 10 * i);
+        EXPECT_EQ(block.cmd(j), 1 + i % 2);
+        EXPECT_EQ(block.addr(j), 0x1000 + 64 * i);
+        EXPECT_EQ(block.blockSize(j), 4 << (i % 3));
+        EXPECT_EQ(block.flags(j), (4 << (i % 3)) + 3);
+        EXPECT_EQ(block.pc(j), 0x1000 + 64 * i + 1);
+        EXPECT_EQ(block.id(j), 0x1000 + 64 * i + 2);
+        cursor.next();
+    }
+    EXPECT_FALSE(cursor.valid());
+    EXPECT_EQ(cursor.record(), 10);
+    unlink(name.c_str());
+}
+
+TEST(MappedTraceTest, SeekPackets)
+{
+    std::string name = writePacketTrace();
+    MappedTrace trace(name, MappedTrace::PacketTrace);
+    MappedTrace::PacketCursor cursor(trace);
+
+    cursor.seekRecord(5);
+    ASSERT_TRUE(cursor.valid());
+    EXPECT_EQ(cursor.current().tick(cursor.index()), 150);
+
+    cursor.seekRecord(10);
+    EXPECT_FALSE(cursor.valid());
+
+    // Keys before the first record, on a block boundary, between
+    // records and past the end.
+    cursor.seekKey(0);
+    EXPECT_EQ(cursor.record(), 0);
+    cursor.seekKey(140);
+    EXPECT_EQ(cursor.record(), 4);
+    cursor.seekKey(175);
+    EXPECT_EQ(cursor.record(), 8);
+    cursor.seekKey(131);
+    EXPECT_EQ(cursor.record(), 4);
+    cursor.seekKey(1000);
+    EXPECT_FALSE(cursor.valid());
+    unlink(name.c_str());
+}
+
+TEST(MappedTraceTest, ReadInstDeps)
+{
+    TraceWriter writer(MappedTrace::InstDepTrace, 8);
+    writer.addBlock(std::vector<InstDep>{
+        {1, 3, 500, {}, {}},
+        {2, 1, 0, {1}, {}},
+        {4, 2, 1000, {2}, {1, 2}}});
+    writer.addBlock(std::vector<InstDep>{
+        {7, 3, 300, {}, {4}},
+        {9, 1, 20, {7, 4}, {2}}});
+    std::string name = writer.write();
+
+    MappedTrace trace(name, MappedTrace::InstDepTrace);
+    EXPECT_EQ(trace.windowSize(), 64);
+    EXPECT_EQ(trace.numRecords(), 5);
+
+    MappedTrace::InstDepCursor cursor(trace);
+    cursor.seekKey(5);
+    ASSERT_TRUE(cursor.valid());
+    EXPECT_EQ(cursor.current().seqNum(cursor.index()), 7);
+
+    cursor.seekRecord(2);
+    const auto &block = cursor.current();
+    uint32_t i = cursor.index();
+    EXPECT_EQ(block.seqNum(i), 4);
+    EXPECT_EQ(block.type(i), 2);
+    EXPECT_EQ(block.compDelay(i), 1000);
+    EXPECT_EQ(block.physAddr(i), 4 * 64);
+    EXPECT_EQ(block.virtAddr(i), 4 * 32);
+    EXPECT_EQ(block.pc(i), 4 * 4);
+    EXPECT_EQ(block.accessSize(i), 8);
+    EXPECT_EQ(block.flags(i), 2);
+    EXPECT_EQ(block.weight(i), 1);
+    EXPECT_EQ(block.asid(i), 0);
+    ASSERT_EQ(block.numRobDeps(i), 1);
+    EXPECT_EQ(block.robDep(i, 0), 2);
+    ASSERT_EQ(block.numRegDeps(i), 2);
+    EXPECT_EQ(block.regDep(i, 0), 1);
+    EXPECT_EQ(block.regDep(i, 1), 2);
+
+    cursor.next();
+    cursor.next();
+    i = cursor.index();
+    EXPECT_EQ(cursor.current().seqNum(i), 9);
+    ASSERT_EQ(cursor.current().numRobDeps(i), 2);
+    EXPECT_EQ(cursor.current().robDep(i, 0), 7);
+    EXPECT_EQ(cursor.current().robDep(i, 1), 4);
+    EXPECT_EQ(cursor.current().numRegDeps(i), 1);
+    EXPECT_EQ(cursor.current().regDep(i, 0), 2);
+    unlink(name.c_str());
+}
+
+TEST(MappedTraceTest, WrongKind)
+{
+    std::string name = writePacketTrace();
+    EXPECT_ANY_THROW(MappedTrace(name, MappedTrace::InstDepTrace));
+    unlink(name.c_str());
+}
@@ -464,6 +464,13 @@ Formula::operator/=(Temp r)
 }
 
 
+const VResult &
+Formula::result() const
+{
+    static const VResult empty;
+    return root ? root->result() : empty;
+}
+
 void
 Formula::result(VResult &vec) const
 {
@@ -494,8 +501,7 @@ Formula::reset()
 bool
 Formula::zero() const
 {
-    VResult vec;
-    result(vec);
+    const VResult &vec = result();
     for (VResult::size_type i = 0; i < vec.size(); ++i)
         if (vec[i] != 0.0)
             return false;
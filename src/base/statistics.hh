@@ -2815,7 +2815,6 @@ template <class Stat>
 class FormulaInfoProxy : public InfoProxy<Stat, FormulaInfo>
 {
   protected:
-    mutable VResult vec;
     mutable VCounter cvec;
 
   public:
@@ -2823,12 +2822,7 @@ class FormulaInfoProxy : public InfoProxy<Stat, FormulaInfo>
 
     size_type size() const { return this->s.size(); }
 
-    const VResult &
-    result() const
-    {
-        this->s.result(vec);
-        return vec;
-    }
+    const VResult &result() const { return this->s.result(); }
     Result total() const { return this->s.total(); }
     VCounter &value() const { return cvec; }
 
@@ -3088,6 +3082,13 @@ class Formula : public DataWrapVec<Formula, FormulaInfoProxy>
      */
     void result(VResult &vec) const;
 
+    /**
+     * Return a reference to the result vector of the Formula, which is
+     * held by the root of the tree, rather than copying it.
+     * @return The result vector, valid until the next evaluation.
+     */
+    const VResult &result() const;
+
     /**
      * Return the total Formula result.  If there is a Vector
      * component to this Formula, then this is the result of the
@@ -3124,13 +3125,12 @@ class FormulaNode : public Node
 {
   private:
     const Formula &formula;
-    mutable VResult vec;
 
   public:
     FormulaNode(const Formula &f) : formula(f) {}
 
     size_type size() const { return formula.size(); }
-    const VResult &result() const { formula.result(vec); return vec; }
+    const VResult &result() const { return formula.result(); }
     Result total() const { return formula.total(); }
 
     std::string str() const { return formula.str(); }
@@ -48,6 +48,7 @@
 #include <string>
 
 #include "arch/generic/tlb.hh"
+#include "arch/utility.hh"
 #include "base/cprintf.hh"
 #include "base/loader/symtab.hh"
 #include "base/logging.hh"
@@ -342,6 +343,8 @@ BaseCPU::regProbePoints()
     ppRetiredLoads = pmuProbePoint("RetiredLoads");
     ppRetiredStores = pmuProbePoint("RetiredStores");
     ppRetiredBranches = pmuProbePoint("RetiredBranches");
+    ppRetiredBranchInfo = new ProbePointArg<RetiredBranch>(
+        getProbeManager(), "RetiredBranchInfo");
 
     ppSleeping = new ProbePointArg<bool>(this->getProbeManager(),
                                          "Sleeping");
@@ -365,6 +368,18 @@ BaseCPU::probeInstCommit(const StaticInstPtr &inst, Addr pc)
         ppRetiredBranches->notify(1);
 }
 
+void
+BaseCPU::notifyBranchCommit(const StaticInstPtr &inst,
+                            const TheISA::PCState &pc)
+{
+    // The instruction has set the next PC of its PC state, as in the
+    // branch resolution of the O3 CPU.
+    TheISA::PCState next = pc;
+    TheISA::advancePC(next, inst);
+    ppRetiredBranchInfo->notify(
+        RetiredBranch{inst, pc.instAddr(), next.instAddr(), pc.branching()});
+}
+
 void
 BaseCPU::regStats()
 {
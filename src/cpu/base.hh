@@ -458,7 +458,41 @@ class BaseCPU : public ClockedObject
      */
     virtual void probeInstCommit(const StaticInstPtr &inst, Addr pc);
 
+    /** A committed control instruction, see ppRetiredBranchInfo. */
+    struct RetiredBranch
+    {
+        StaticInstPtr inst;
+        /** Address of the branch */
+        Addr pc;
+        /** Address of the instruction executed after the branch */
+        Addr target;
+        /** Did the branch leave the sequential path? */
+        bool taken;
+    };
+
+    /**
+     * Helper method to trigger the branch probe for a committed
+     * instruction. Like the instruction probes, it only fires for the last
+     * microop of an instruction. It must be called before the PC of the
+     * thread is advanced past the instruction.
+     *
+     * @param inst Instruction that just committed
+     * @param pc PC state of the instruction after it executed
+     */
+    void
+    probeBranchCommit(const StaticInstPtr &inst, const TheISA::PCState &pc)
+    {
+        if (inst->isControl() &&
+            (!inst->isMicroop() || inst->isLastMicroop()) &&
+            ppRetiredBranchInfo->hasListeners())
+            notifyBranchCommit(inst, pc);
+    }
+
    protected:
+    /** Build the RetiredBranch of an instruction and notify it. */
+    void notifyBranchCommit(const StaticInstPtr &inst,
+                            const TheISA::PCState &pc);
+
     /**
      * Helper method to instantiate probe points belonging to this
      * object.
@@ -487,6 +521,12 @@ class BaseCPU : public ClockedObject
     /** Retired branches (any type) */
     ProbePoints::PMUUPtr ppRetiredBranches;
 
+    /**
+     * Retired branches with their outcome, e.g., to capture branch traces
+     * that are independent of the CPU model.
+     */
+    ProbePointArg<RetiredBranch> *ppRetiredBranchInfo;
+
     /** CPU cycle counter even if any thread Context is suspended*/
     ProbePoints::PMUUPtr ppAllCycles;
 
@@ -51,6 +51,7 @@
 
 #include "arch/generic/tlb.hh"
 #include "arch/utility.hh"
+#include "base/intrusive_list.hh"
 #include "base/trace.hh"
 #include "config/the_isa.hh"
 #include "cpu/checker/cpu.hh"
@@ -73,7 +74,8 @@
  */
 
 template <class Impl>
-class BaseDynInst : public ExecContext, public RefCounted
+class BaseDynInst : public ExecContext, public RefCounted,
+                    public IntrusiveListHook<typename Impl::DynInstPtr>
 {
   public:
     // Typedef for the CPU.
@@ -90,7 +92,7 @@ class BaseDynInst : public ExecContext, public RefCounted
     typedef RefCountingPtr<BaseDynInst<Impl> > BaseDynInstPtr;
 
     // The list of instructions iterator type.
-    typedef typename std::list<DynInstPtr>::iterator ListIt;
+    typedef typename IntrusiveList<DynInstPtr>::iterator ListIt;
 
     enum {
         MaxInstSrcRegs = TheISA::MaxInstSrcRegs,        /// Max source regs
@@ -192,9 +194,6 @@ class BaseDynInst : public ExecContext, public RefCounted
     /** The thread this instruction is from. */
     ThreadID threadNumber;
 
-    /** Iterator pointing to this BaseDynInst in the list of all insts. */
-    ListIt instListIt;
-
     ////////////////////// Branch Data ///////////////
     /** Predicted PC state after this instruction. */
     TheISA::PCState predPC;
@@ -230,6 +229,9 @@ class BaseDynInst : public ExecContext, public RefCounted
     int16_t sqIdx;
     SQIterator sqIt;
 
+    /** Entry in the matrices of a matrix scheduled IQ. */
+    int16_t iqEntry;
+
 
     /////////////////////// TLB Miss //////////////////////
     /**
@@ -1022,10 +1024,11 @@ class BaseDynInst : public ExecContext, public RefCounted
     void setRequest() { instFlags[ReqMade] = true; }
 
     /** Returns iterator to this instruction in the list of all insts. */
-    ListIt &getInstListIt() { return instListIt; }
-
-    /** Sets iterator for this instruction in the list of all insts. */
-    void setInstListIt(ListIt _instListIt) { instListIt = _instListIt; }
+    ListIt
+    getInstListIt()
+    {
+        return IntrusiveList<DynInstPtr>::iteratorTo(*this);
+    }
 
   public:
     /** Returns the number of consecutive store conditional failures. */
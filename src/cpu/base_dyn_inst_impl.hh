@@ -108,6 +108,7 @@ BaseDynInst<Impl>::initVars()
 
     lqIdx = -1;
     sqIdx = -1;
+    iqEntry = -1;
 
     // Eventually make this a parameter.
     threadNumber = 0;
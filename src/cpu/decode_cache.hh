@@ -29,19 +29,127 @@
 #ifndef __CPU_DECODE_CACHE_HH__
 #define __CPU_DECODE_CACHE_HH__
 
+#include <cassert>
+#include <functional>
+#include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include "base/bitfield.hh"
+#include "base/types.hh"
 #include "cpu/static_inst_fwd.hh"
 
 namespace DecodeCache
 {
 
-/// Hash for decoded instructions.
+/// Lookup counts of the decode caches used by a decoder.
+struct Counts
+{
+    /// Page lookups served by the L0 of recently used pages.
+    Counter pageL0Hits = 0;
+    /// Page lookups served by the page table.
+    Counter pageTableHits = 0;
+    /// Page lookups that had to search or extend the page map.
+    Counter pageMisses = 0;
+    /// Instructions found at their address.
+    Counter addrHits = 0;
+    /// Instructions found in the map of decoded instructions.
+    Counter instHits = 0;
+    /// Instructions that had to be decoded.
+    Counter instMisses = 0;
+};
+
+/// Hash for decoded instructions. Open addressing with linear probing
+/// keeps lookups to a few adjacent entries. Entries are never removed.
 template <typename EMI>
-using InstMap = std::unordered_map<EMI, StaticInstPtr>;
+class InstMap
+{
+  public:
+    struct Entry
+    {
+        EMI first;
+        StaticInstPtr second;
+        bool used = false;
+    };
+
+    typedef Entry *iterator;
+
+  protected:
+    std::vector<Entry> entries;
+    size_t numUsed;
+    unsigned shift;
+
+    size_t
+    slot(const EMI &emi) const
+    {
+        // Spread the bits of the hash, as the hashes of some machine
+        // instructions are the instructions themselves.
+        uint64_t hash = std::hash<EMI>()(emi);
+        return (hash * ULL(0x9e3779b97f4a7c15)) >> shift;
+    }
+
+    size_t mask() const { return entries.size() - 1; }
+
+    /// Find the entry of a machine instruction or the free entry it
+    /// would be inserted in.
+    Entry *
+    probe(const EMI &emi)
+    {
+        size_t idx = slot(emi);
+        while (entries[idx].used && !(entries[idx].first == emi))
+            idx = (idx + 1) & mask();
+        return &entries[idx];
+    }
+
+    void
+    grow()
+    {
+        std::vector<Entry> old(entries.size() * 2);
+        old.swap(entries);
+        --shift;
+        for (auto &entry : old) {
+            if (entry.used)
+                *probe(entry.first) = std::move(entry);
+        }
+    }
+
+  public:
+    InstMap() : entries(1024), numUsed(0), shift(64 - 10) {}
+
+    iterator end() { return nullptr; }
+
+    iterator
+    find(const EMI &emi)
+    {
+        Entry *entry = probe(emi);
+        return entry->used ? entry : end();
+    }
+
+    StaticInstPtr &
+    operator[](const EMI &emi)
+    {
+        Entry *entry = probe(emi);
+        if (entry->used)
+            return entry->second;
+
+        // Keep the load factor at or below 3/4
+        if ((numUsed + 1) * 4 > entries.size() * 3) {
+            grow();
+            entry = probe(emi);
+        }
+
+        entry->first = emi;
+        entry->used = true;
+        ++numUsed;
+        return entry->second;
+    }
 
-/// A sparse map from an Addr to a Value, stored in page chunks.
+    size_t size() const { return numUsed; }
+};
+
+/// A sparse map from an Addr to a Value, stored in page chunks. Chunks
+/// are found through a two level page table whose first level is direct
+/// mapped, and are never freed, so references to values stay valid.
 template<class Value, Addr CacheChunkShift = 12>
 class AddrMap
 {
@@ -65,69 +173,131 @@ class AddrMap
     {
         Value items[CacheChunkBytes];
     };
-    // A map of cache chunks which allows a sparse mapping.
-    typedef typename std::unordered_map<Addr, CacheChunk *> ChunkMap;
-    typedef typename ChunkMap::iterator ChunkIt;
-    // Mini cache of recent lookups.
-    ChunkIt recent[2];
-    ChunkMap chunkMap;
-
-    /// Update the mini cache of recent lookups.
-    /// @param recentest The most recent result;
-    void
-    update(ChunkIt recentest)
+
+    // Second level of the page table, mapping a region of chunks.
+    static constexpr unsigned TableShift = 10;
+    static constexpr Addr TableChunks = 1ULL << TableShift;
+    static constexpr unsigned RegionShift = CacheChunkShift + TableShift;
+
+    struct Table
     {
-        recent[1] = recent[0];
-        recent[0] = recentest;
-    }
+        std::unique_ptr<CacheChunk> chunks[TableChunks];
+    };
 
-    /// Attempt to find the CacheChunk which goes with a particular
-    /// address. First check the small cache of recent results, then
-    /// actually look in the hash map.
+    // First level of the page table. Regions that conflict in it are
+    // looked up in the map of all tables.
+    static constexpr unsigned DirectoryEntries = 256;
+
+    struct DirectoryEntry
+    {
+        Addr region;
+        Table *table;
+    };
+
+    DirectoryEntry directory[DirectoryEntries];
+    std::unordered_map<Addr, std::unique_ptr<Table>> tables;
+
+    /// Find the CacheChunk which goes with a particular address, creating
+    /// it if needed.
     /// @param addr The address to look up.
+    /// @param counts Lookup counts to update.
     CacheChunk *
-    getChunk(Addr addr)
+    getChunk(Addr addr, Counts &counts)
     {
-        Addr chunk_addr = chunkStart(addr);
-
-        // Check against recent lookups.
-        if (recent[0] != chunkMap.end()) {
-            if (recent[0]->first == chunk_addr)
-                return recent[0]->second;
-            if (recent[1] != chunkMap.end() &&
-                    recent[1]->first == chunk_addr) {
-                update(recent[1]);
-                // recent[1] has just become recent[0].
-                return recent[0]->second;
-            }
+        Addr region = addr >> RegionShift;
+        DirectoryEntry &entry = directory[region % DirectoryEntries];
+        bool hit = entry.table && entry.region == region;
+        if (!hit) {
+            std::unique_ptr<Table> &table = tables[region];
+            if (!table)
+                table.reset(new Table);
+            entry.region = region;
+            entry.table = table.get();
         }
 
-        // Actually look in the hash_map.
-        ChunkIt it = chunkMap.find(chunk_addr);
-        if (it != chunkMap.end()) {
-            update(it);
-            return it->second;
+        std::unique_ptr<CacheChunk> &chunk =
+            entry.table->chunks[(addr >> CacheChunkShift) & (TableChunks - 1)];
+        if (!chunk) {
+            chunk.reset(new CacheChunk);
+            hit = false;
         }
 
-        // Didn't find an existing chunk, so add a new one.
-        CacheChunk *newChunk = new CacheChunk;
-        typename ChunkMap::value_type to_insert(chunk_addr, newChunk);
-        update(chunkMap.insert(to_insert).first);
-        return newChunk;
+        if (hit)
+            ++counts.pageTableHits;
+        else
+            ++counts.pageMisses;
+        return chunk.get();
     }
 
   public:
+    /// A small cache of the most recently used chunks, which is kept by
+    /// each user of a shared map and checked before the page table.
+    class Recent
+    {
+      protected:
+        friend class AddrMap;
+
+        static const int Entries = 8;
+
+        Counts &counts;
+        Addr chunkAddrs[Entries];
+        CacheChunk *chunks[Entries];
+
+      public:
+        Recent(Counts &_counts) : counts(_counts) { clear(); }
+
+        /// Forget all chunks, e.g., when switching to another map.
+        void
+        clear()
+        {
+            for (int i = 0; i < Entries; ++i) {
+                chunkAddrs[i] = 0;
+                chunks[i] = nullptr;
+            }
+        }
+    };
+
     /// Constructor
     AddrMap()
     {
-        recent[0] = recent[1] = chunkMap.end();
+        for (auto &entry : directory)
+            entry = {0, nullptr};
     }
 
     Value &
-    lookup(Addr addr)
+    lookup(Addr addr, Recent &recent)
     {
-        CacheChunk *chunk = getChunk(addr);
-        return chunk->items[chunkOffset(addr)];
+        Addr chunk_addr = chunkStart(addr);
+        Addr offset = chunkOffset(addr);
+
+        if (recent.chunks[0] && recent.chunkAddrs[0] == chunk_addr) {
+            ++recent.counts.pageL0Hits;
+            return recent.chunks[0]->items[offset];
+        }
+
+        // Move the chunk to the front, whether it was recent or not.
+        int idx = 1;
+        while (idx < Recent::Entries - 1 && recent.chunks[idx] &&
+               recent.chunkAddrs[idx] != chunk_addr) {
+            ++idx;
+        }
+
+        CacheChunk *chunk;
+        if (recent.chunks[idx] && recent.chunkAddrs[idx] == chunk_addr) {
+            ++recent.counts.pageL0Hits;
+            chunk = recent.chunks[idx];
+        } else {
+            chunk = getChunk(addr, recent.counts);
+        }
+
+        for (; idx > 0; --idx) {
+            recent.chunkAddrs[idx] = recent.chunkAddrs[idx - 1];
+            recent.chunks[idx] = recent.chunks[idx - 1];
+        }
+        recent.chunkAddrs[0] = chunk_addr;
+        recent.chunks[0] = chunk;
+
+        return chunk->items[offset];
     }
 };
 
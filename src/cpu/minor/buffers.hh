@@ -47,6 +47,7 @@
 #include <iostream>
 #include <queue>
 #include <sstream>
+#include <utility>
 
 #include "base/logging.hh"
 #include "cpu/activity.hh"
@@ -361,8 +362,7 @@ class SelfStallingPipeline : public MinorBuffer<ElemType, ReportTraits>
             /* Insert a bubble into the empty input slot to make sure that
              *  element is correct in the case where the default constructor
              *  for ElemType doesn't produce a bubble */
-            ElemType bubble = BubbleTraits::bubble();
-            *pushWire = bubble;
+            *pushWire = BubbleTraits::bubble();
         }
     }
 };
@@ -428,15 +428,33 @@ class Queue : public Named, public Reservable
         if (!BubbleTraits::isBubble(data)) {
             freeReservation();
             queue.push_back(data);
+            checkCapacity();
+        }
+    }
 
-            if (queue.size() > capacity) {
-                warn("%s: No space to push data into queue of capacity"
-                    " %u, pushing anyway\n", name(), capacity);
-            }
+    /** Like push, but moves the data into the buffer */
+    void
+    push(ElemType &&data)
+    {
+        if (!BubbleTraits::isBubble(data)) {
+            freeReservation();
+            queue.push_back(std::move(data));
+            checkCapacity();
+        }
+    }
 
+  protected:
+    /** Warn if a push has overfilled the queue */
+    void
+    checkCapacity() const
+    {
+        if (queue.size() > capacity) {
+            warn("%s: No space to push data into queue of capacity"
+                " %u, pushing anyway\n", name(), capacity);
         }
     }
 
+  public:
     /** Clear all allocated space.  Be careful how this is used */
     void clearReservedSpace() { numReservedSlots = 0; }
 
@@ -620,12 +638,18 @@ class InputBuffer : public Reservable
 
     /** Push the single element (if any) into the queue proper.  If the
      *  element's reference points to a transient object, remember to
-     *  always do this before the end of that object's life */
+     *  always do this before the end of that object's life.  The element
+     *  is moved out of its latch slot, which is only read again by
+     *  MinorTrace reporting the latches after the stages have evaluated */
     void
     pushTail() const
     {
-        if (elementPtr)
-            queue.push(*elementPtr);
+        if (elementPtr) {
+            if (DTRACE(MinorTrace))
+                queue.push(*elementPtr);
+            else
+                queue.push(std::move(*elementPtr));
+        }
         elementPtr = NULL;
     }
 
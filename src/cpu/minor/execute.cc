@@ -635,7 +635,7 @@ Execute::issue(ThreadID thread_id)
                     /* Push the instruction onto the inFlight queue so
                      *  it can be committed in order */
                     QueuedInst fu_inst(inst);
-                    thread.inFlightInsts->push(fu_inst);
+                    thread.inFlightInsts->push(std::move(fu_inst));
 
                     issued = true;
 
@@ -761,7 +761,7 @@ Execute::issue(ThreadID thread_id)
 
                         /* Push the instruction onto the inFlight queue so
                          *  it can be committed in order */
-                        thread.inFlightInsts->push(fu_inst);
+                        thread.inFlightInsts->push(std::move(fu_inst));
 
                         issued = true;
                     }
@@ -883,6 +883,8 @@ Execute::doInstCommitAccounting(MinorDynInstPtr inst)
         inst->traceData->setCPSeq(thread->numOp);
 
     cpu.probeInstCommit(inst->staticInst, inst->pc.instAddr());
+    cpu.probeBranchCommit(inst->staticInst,
+                          cpu.getContext(inst->id.threadId)->pcState());
 }
 
 bool
@@ -1558,8 +1560,13 @@ Execute::evaluate()
                 head_inst_might_commit = true;
             } else {
                 FUPipeline *fu = funcUnits[head_inst.inst->fuIndex];
+                /* A memory reference at the end of its FU can't be
+                 *  issued while the LSQ is full.  Space is made there by
+                 *  stepping the LSQ, which lsq.needsToTick() accounts
+                 *  for, or by memory system events which wake the CPU */
                 if ((fu->stalled &&
-                     fu->front().inst->id == head_inst.inst->id) ||
+                     fu->front().inst->id == head_inst.inst->id &&
+                     (!head_inst.inst->isMemRef() || lsq.canRequest())) ||
                      lsq.findResponse(head_inst.inst))
                 {
                     head_inst_might_commit = true;
@@ -453,6 +453,10 @@ Fetch1::recvReqRetry()
 
     if (tryToSend(retryRequest))
         moveFromRequestsToTransfers(retryRequest);
+
+    /* Wake up the processor to issue the fetches queued behind the
+     *  retried one */
+    cpu.wakeupOnEvent(Pipeline::Fetch1StageId);
 }
 
 std::ostream &
@@ -912,6 +912,28 @@ LSQ::StoreBuffer::step()
     }
 }
 
+bool
+LSQ::StoreBuffer::needsToStep() const
+{
+    if (numUnissuedAccesses == 0)
+        return false;
+
+    /* Follow step(): leading complete barriers can be cleared and the
+     *  first store which hasn't sent all its packets can be issued
+     *  unless there's a barrier before it */
+    for (auto i = slots.begin(); i != slots.end(); i++) {
+        LSQRequestPtr request = *i;
+
+        if (request->isBarrier() && request->isComplete())
+            return i == slots.begin();
+        else if (!(request->state == LSQRequest::StoreBufferIssuing &&
+            request->sentAllPackets()))
+            return true;
+    }
+
+    return false;
+}
+
 void
 LSQ::completeMemBarrierInst(MinorDynInstPtr inst,
     bool committed)
@@ -961,6 +983,8 @@ LSQ::StoreBuffer::minorTrace() const
 void
 LSQ::tryToSendToTransfers(LSQRequestPtr request)
 {
+    requestWaitsForMemory = false;
+
     if (state == MemoryNeedsRetry) {
         DPRINTF(MinorMem, "Request needs retry, not issuing to"
             " memory until retry arrives\n");
@@ -1005,6 +1029,7 @@ LSQ::tryToSendToTransfers(LSQRequestPtr request)
         if (request->hasPacketsInMemSystem()) {
             DPRINTF(MinorMem, "Request's inst. is from the wrong stream,"
                 " waiting for responses before aborting request\n");
+            requestWaitsForMemory = true;
         } else {
             DPRINTF(MinorMem, "Request's inst. is from the wrong stream,"
                 " aborting request\n");
@@ -1057,6 +1082,7 @@ LSQ::tryToSendToTransfers(LSQRequestPtr request)
         !storeBuffer.isDrained()) {
         DPRINTF(MinorMem, "Memory access needs to wait for store buffer"
                           " to drain\n");
+        requestWaitsForMemory = true;
         return;
     }
 
@@ -1085,6 +1111,7 @@ LSQ::tryToSendToTransfers(LSQRequestPtr request)
             DPRINTF(MinorMem, "Memory access can receive forwarded data"
                 " from the store buffer, but need to wait for store buffer"
                 " to drain\n");
+            requestWaitsForMemory = true;
             return;
         }
     }
@@ -1116,6 +1143,7 @@ LSQ::tryToSendToTransfers(LSQRequestPtr request)
               case PartialAddrRangeCoverage:
                 DPRINTF(MinorMem, "Load partly satisfied by store buffer"
                     " data. Must wait for the store to complete\n");
+                requestWaitsForMemory = true;
                 return;
                 break;
               case NoAddrRangeCoverage:
@@ -1286,6 +1314,7 @@ LSQ::moveFromRequestsToTransfers(LSQRequestPtr request)
 
     requests.pop();
     transfers.push(request);
+    requestWaitsForMemory = false;
 }
 
 bool
@@ -1400,6 +1429,10 @@ LSQ::recvReqRetry()
 
         retryRequest = NULL;
     }
+
+    /* Wake up the processor to step the queues behind the retried
+     *  request, they were left alone while the memory system was busy */
+    cpu.wakeupOnEvent(Pipeline::ExecuteStageId);
 }
 
 LSQ::LSQ(std::string name_, std::string dcache_port_name_,
@@ -1425,6 +1458,7 @@ LSQ::LSQ(std::string name_, std::string dcache_port_name_,
     numStoresInTransfers(0),
     numAccessesIssuedToMemory(0),
     retryRequest(NULL),
+    requestWaitsForMemory(false),
     cacheBlockMask(~(cpu_.cacheLineSize() - 1))
 {
     if (in_memory_system_limit < 1) {
@@ -1570,10 +1604,10 @@ LSQ::needsToTick()
     if (canSendToMemorySystem()) {
         bool have_translated_requests = !requests.empty() &&
             requests.front()->state != LSQRequest::InTranslation &&
+            !requestWaitsForMemory &&
             transfers.unreservedRemainingSpace() != 0;
 
-        ret = have_translated_requests ||
-            storeBuffer.numUnissuedStores() != 0;
+        ret = have_translated_requests || storeBuffer.needsToStep();
     }
 
     if (ret)
@@ -522,6 +522,11 @@ class LSQ : public Named
         /** Try to issue more stores to memory */
         void step();
 
+        /** Can step() issue a store or clear a barrier?  Stores held
+         *  behind a barrier and barriers waiting for older stores to
+         *  complete can only move on when a response arrives */
+        bool needsToStep() const;
+
         /** Report queue contents for MinorTrace */
         void minorTrace() const;
     };
@@ -610,6 +615,11 @@ class LSQ : public Named
      *  currently waiting have its memory access retried */
     LSQRequestPtr retryRequest;
 
+    /** The head of the requests queue can't be issued until responses
+     *  arrive from the memory system, e.g. for the store buffer to
+     *  drain.  Set by tryToSendToTransfers */
+    bool requestWaitsForMemory;
+
     /** Address Mask for a cache block (e.g. ~(cache_block_size-1)) */
     Addr cacheBlockMask;
 
@@ -694,7 +704,9 @@ class LSQ : public Named
     bool isDrained();
 
     /** May need to be ticked next cycle as one of the queues contains
-     *  an actionable transfers or address translation */
+     *  an actionable transfers or address translation.  Requests which
+     *  are only waiting for memory responses don't need ticking as the
+     *  responses wake the CPU */
     bool needsToTick();
 
     /** Complete a barrier instruction.  Where committed, makes a
@@ -268,6 +268,9 @@ class ForwardInstData /* : public ReportIF, public BubbleIF */
 
     ForwardInstData(const ForwardInstData &src);
 
+    /** Take the insts of src, leaving it a bubble */
+    ForwardInstData(ForwardInstData &&src);
+
   public:
     /** Number of instructions carried by this object */
     unsigned int width() const { return numInsts; }
@@ -275,6 +278,10 @@ class ForwardInstData /* : public ReportIF, public BubbleIF */
     /** Copy the inst array only as far as numInsts */
     ForwardInstData &operator =(const ForwardInstData &src);
 
+    /** Move the inst array only as far as numInsts, leaving src a
+     *  bubble */
+    ForwardInstData &operator =(ForwardInstData &&src);
+
     /** Resize a bubble/empty ForwardInstData and fill with bubbles */
     void resize(unsigned int width);
 
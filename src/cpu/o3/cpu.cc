@@ -90,6 +90,9 @@ FullO3CPU<Impl>::FullO3CPU(DerivO3CPUParams *params)
 #ifndef NDEBUG
       instcount(0),
 #endif
+      instPool(new DynInstPool(sizeof(typename Impl::DynInst),
+                               params->numROBEntries +
+                               params->fetchQueueSize * params->numThreads)),
       removeInstsThisCycle(false),
       fetch(this, params),
       decode(this, params),
@@ -359,6 +362,8 @@ FullO3CPU<Impl>::FullO3CPU(DerivO3CPUParams *params)
 template <class Impl>
 FullO3CPU<Impl>::~FullO3CPU()
 {
+    // The pool goes away with the last instruction
+    instPool->release();
 }
 
 template <class Impl>
@@ -1524,6 +1529,7 @@ FullO3CPU<Impl>::instDone(ThreadID tid, const DynInstPtr &inst)
     committedOps[tid]++;
 
     probeInstCommit(inst->staticInst, inst->instAddr());
+    probeBranchCommit(inst->staticInst, inst->pcState());
 }
 
 template <class Impl>
@@ -51,10 +51,12 @@
 
 #include "arch/generic/types.hh"
 #include "arch/types.hh"
+#include "base/intrusive_list.hh"
 #include "base/statistics.hh"
 #include "config/the_isa.hh"
 #include "cpu/o3/comm.hh"
 #include "cpu/o3/cpu_policy.hh"
+#include "cpu/o3/dyn_inst_pool.hh"
 #include "cpu/o3/scoreboard.hh"
 #include "cpu/o3/thread_state.hh"
 #include "cpu/activity.hh"
@@ -106,7 +108,7 @@ class FullO3CPU : public BaseO3CPU
     typedef O3ThreadState<Impl> ImplState;
     typedef O3ThreadState<Impl> Thread;
 
-    typedef typename std::list<DynInstPtr>::iterator ListIt;
+    typedef typename IntrusiveList<DynInstPtr>::iterator ListIt;
 
     friend class O3ThreadContext<Impl>;
 
@@ -536,8 +538,11 @@ class FullO3CPU : public BaseO3CPU
     int instcount;
 #endif
 
+    /** Allocator of the instructions in flight. */
+    DynInstPool *instPool;
+
     /** List of all the instructions in flight. */
-    std::list<DynInstPtr> instList;
+    IntrusiveList<DynInstPtr> instList;
 
     /** List of all the instructions that will be removed at the end of this
      *  cycle.
@@ -46,6 +46,7 @@
 
 #include "config/the_isa.hh"
 #include "cpu/o3/cpu.hh"
+#include "cpu/o3/dyn_inst_pool.hh"
 #include "cpu/o3/isa_specific.hh"
 #include "cpu/base_dyn_inst.hh"
 #include "cpu/inst_seq.hh"
@@ -85,6 +86,23 @@ class BaseO3DynInst : public BaseDynInst<Impl>
 
     ~BaseO3DynInst();
 
+    /** Allocate an instruction from the pool of its CPU. */
+    static void *
+    operator new(size_t size, DynInstPool &pool)
+    {
+        return pool.allocate(size);
+    }
+
+    /** Return an instruction to the pool it was allocated from. */
+    static void operator delete(void *ptr) { DynInstPool::deallocate(ptr); }
+
+    /** Used if the constructor throws. */
+    static void
+    operator delete(void *ptr, DynInstPool &pool)
+    {
+        DynInstPool::deallocate(ptr);
+    }
+
     /** Executes the instruction.*/
     Fault execute();
 
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2020 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cpu/o3/dyn_inst_pool.hh"
+
+#include "base/logging.hh"
+#include "base/trace.hh"
+#include "debug/O3CPU.hh"
+
+DynInstPool::DynInstPool(size_t block_size, size_t slab_blocks)
+    : blockSize(headerSize + ((block_size + alignof(std::max_align_t) - 1) &
+                              ~(alignof(std::max_align_t) - 1))),
+      slabBlocks(slab_blocks), freeList(nullptr), outstanding(0),
+      released(false)
+{
+    fatal_if(slab_blocks == 0, "Dynamic instruction pool without blocks.\n");
+    grow();
+}
+
+void
+DynInstPool::grow()
+{
+    slabs.emplace_back(new char[blockSize * slabBlocks]);
+    char *slab = slabs.back().get();
+
+    // Thread the new blocks on the free list, lowest address first
+    for (size_t i = slabBlocks; i > 0; --i) {
+        Header *header = reinterpret_cast<Header *>(slab +
+                                                    (i - 1) * blockSize);
+        header->pool = this;
+        header->nextFree = freeList;
+        freeList = header;
+    }
+
+    DPRINTF(O3CPU, "Dynamic instruction pool grown to %d blocks.\n",
+            capacity());
+}
+
+void *
+DynInstPool::allocate(size_t size)
+{
+    panic_if(headerSize + size > blockSize,
+             "Allocating %d bytes from a pool of %d byte blocks.\n",
+             size, blockSize - headerSize);
+    assert(!released);
+
+    // More instructions are alive than the window holds, e.g. squashed
+    // ones still referenced by memory requests
+    if (!freeList)
+        grow();
+
+    Header *header = freeList;
+    freeList = header->nextFree;
+    ++outstanding;
+
+    return reinterpret_cast<char *>(header) + headerSize;
+}
+
+void
+DynInstPool::deallocate(void *ptr)
+{
+    if (!ptr)
+        return;
+
+    Header *header = reinterpret_cast<Header *>(
+        static_cast<char *>(ptr) - headerSize);
+    DynInstPool *pool = header->pool;
+
+    assert(pool->outstanding > 0);
+    header->nextFree = pool->freeList;
+    pool->freeList = header;
+    --pool->outstanding;
+
+    if (pool->released && pool->outstanding == 0)
+        delete pool;
+}
+
+void
+DynInstPool::release()
+{
+    assert(!released);
+    released = true;
+
+    if (outstanding == 0)
+        delete this;
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2020 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CPU_O3_DYN_INST_POOL_HH__
+#define __CPU_O3_DYN_INST_POOL_HH__
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+ * Fixed-size block allocator for the dynamic instructions of a CPU.
+ *
+ * The blocks are carved out of slabs sized to the instruction window of
+ * the CPU and recycled through a free list, so creating an instruction
+ * does not go to the heap and the instructions in flight share a few
+ * contiguous slabs. Every block starts with a header pointing back to
+ * its pool, which lets an instruction be returned to the right pool
+ * from operator delete when its last reference is dropped.
+ *
+ * Instructions may outlive their CPU (e.g. when held by an outstanding
+ * memory request), so the owner does not delete the pool but releases
+ * it, and the pool deletes itself once all of its blocks are free.
+ */
+class DynInstPool
+{
+  public:
+    /**
+     * @param block_size Size of the objects allocated
+     * @param slab_blocks Number of blocks allocated at a time
+     */
+    DynInstPool(size_t block_size, size_t slab_blocks);
+
+    DynInstPool(const DynInstPool &) = delete;
+    DynInstPool &operator=(const DynInstPool &) = delete;
+
+    /** Allocate a block of at most the block size of the pool. */
+    void *allocate(size_t size);
+
+    /** Return a block to the pool it was allocated from. */
+    static void deallocate(void *ptr);
+
+    /** Give up ownership, the pool is deleted once all blocks are free. */
+    void release();
+
+    /** Number of blocks in use. */
+    size_t inUse() const { return outstanding; }
+
+    /** Number of blocks allocated from the heap. */
+    size_t capacity() const { return slabs.size() * slabBlocks; }
+
+  private:
+    ~DynInstPool() = default;
+
+    struct Header
+    {
+        DynInstPool *pool;
+        Header *nextFree;
+    };
+
+    /** Offset of an object from the start of its block */
+    static constexpr size_t headerSize =
+        (sizeof(Header) + alignof(std::max_align_t) - 1) &
+        ~(alignof(std::max_align_t) - 1);
+
+    /** Add a slab of blocks to the free list. */
+    void grow();
+
+    const size_t blockSize;
+    const size_t slabBlocks;
+
+    std::vector<std::unique_ptr<char[]>> slabs;
+
+    Header *freeList;
+    size_t outstanding;
+    bool released;
+};
+
+#endif // __CPU_O3_DYN_INST_POOL_HH__
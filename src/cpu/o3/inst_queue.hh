@@ -44,12 +44,14 @@
 
 #include <list>
 #include <map>
+#include <memory>
 #include <queue>
 #include <vector>
 
 #include "base/statistics.hh"
 #include "base/types.hh"
 #include "cpu/o3/dep_graph.hh"
+#include "cpu/o3/iq_matrix.hh"
 #include "cpu/inst_seq.hh"
 #include "cpu/op_class.hh"
 #include "cpu/timebuf.hh"
@@ -395,6 +397,46 @@ class InstructionQueue
 
     DependencyGraph<DynInstPtr> dependGraph;
 
+    /**
+     * Dependency and age matrices replacing the dependency graph and the
+     * ready lists, if the matrix scheduler is used.
+     */
+    std::unique_ptr<IQMatrix> matrix;
+
+    /** Instruction in each entry of the matrices. */
+    std::vector<DynInstPtr> matrixInsts;
+
+    /** Take an entry in the matrices for a new instruction. */
+    void allocateEntry(const DynInstPtr &inst);
+
+    /** Free the entry of an instruction leaving the IQ. */
+    void releaseEntry(const DynInstPtr &inst);
+
+    /** Mark an instruction as ready to issue in the matrices. */
+    void addToMatrixReady(const DynInstPtr &inst);
+
+    /**
+     * Wake the instructions waiting on a register in the dependency
+     * matrix.
+     *
+     * @return The number of source operands woken up.
+     */
+    int wakeMatrixDependents(PhysRegIndex flat_idx);
+
+    /**
+     * Issue the oldest ready instructions selected with the age matrix.
+     *
+     * @return The number of instructions issued.
+     */
+    int scheduleFromMatrix(IssueStruct *i2e_info);
+
+    /**
+     * Try to get a FU for an instruction and issue it.
+     *
+     * @return Whether the instruction was issued.
+     */
+    bool issueInst(const DynInstPtr &issuing_inst, IssueStruct *i2e_info);
+
     //////////////////////////////////////
     // Various parameters
     //////////////////////////////////////
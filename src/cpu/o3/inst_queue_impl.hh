@@ -42,6 +42,8 @@
 #ifndef __CPU_O3_INST_QUEUE_IMPL_HH__
 #define __CPU_O3_INST_QUEUE_IMPL_HH__
 
+#include <algorithm>
+#include <array>
 #include <limits>
 #include <vector>
 
@@ -108,6 +110,11 @@ InstructionQueue<Impl>::InstructionQueue(O3CPU *cpu_ptr, IEW *iew_ptr,
     //dependency graph.
     dependGraph.resize(numPhysRegs);
 
+    if (params->iqMatrixScheduler) {
+        matrix.reset(new IQMatrix(numEntries, numPhysRegs));
+        matrixInsts.resize(numEntries);
+    }
+
     // Resize the register scoreboard.
     regScoreboard.resize(numPhysRegs);
 
@@ -423,6 +430,10 @@ InstructionQueue<Impl>::resetState()
     }
     nonSpecInsts.clear();
     listOrder.clear();
+    if (matrix) {
+        matrix->clear();
+        std::fill(matrixInsts.begin(), matrixInsts.end(), nullptr);
+    }
     deferredMemInsts.clear();
     blockedMemInsts.clear();
     retryMemInsts.clear();
@@ -559,7 +570,7 @@ template <class Impl>
 bool
 InstructionQueue<Impl>::hasReadyInsts()
 {
-    if (!listOrder.empty()) {
+    if (!listOrder.empty() || (matrix && matrix->anyReady())) {
         return true;
     }
 
@@ -596,6 +607,7 @@ InstructionQueue<Impl>::insert(const DynInstPtr &new_inst)
     --freeEntries;
 
     new_inst->setInIQ();
+    allocateEntry(new_inst);
 
     // Look through its source registers (physical regs), and mark any
     // dependencies.
@@ -647,6 +659,7 @@ InstructionQueue<Impl>::insertNonSpec(const DynInstPtr &new_inst)
     --freeEntries;
 
     new_inst->setInIQ();
+    allocateEntry(new_inst);
 
     // Have this instruction set itself as the producer of its destination
     // register(s).
@@ -799,6 +812,10 @@ InstructionQueue<Impl>::scheduleReadyInsts()
     ListOrderIt order_it = listOrder.begin();
     ListOrderIt order_end_it = listOrder.end();
 
+    // The ready lists are not used with the matrix scheduler
+    if (matrix)
+        total_issued = scheduleFromMatrix(i2e_info);
+
     while (total_issued < totalWidth && order_it != order_end_it) {
         OpClass op_class = (*order_it).queueType;
 
@@ -833,60 +850,7 @@ InstructionQueue<Impl>::scheduleReadyInsts()
             continue;
         }
 
-        int idx = FUPool::NoCapableFU;
-        Cycles op_latency = Cycles(1);
-        ThreadID tid = issuing_inst->threadNumber;
-
-        if (op_class != No_OpClass) {
-            idx = fuPool->getUnit(op_class);
-            if (issuing_inst->isFloating()) {
-                fpAluAccesses++;
-            } else if (issuing_inst->isVector()) {
-                vecAluAccesses++;
-            } else {
-                intAluAccesses++;
-            }
-            if (idx > FUPool::NoFreeFU) {
-                op_latency = fuPool->getOpLatency(op_class);
-            }
-        }
-
-        // If we have an instruction that doesn't require a FU, or a
-        // valid FU, then schedule for execution.
-        if (idx != FUPool::NoFreeFU) {
-            if (op_latency == Cycles(1)) {
-                i2e_info->size++;
-                instsToExecute.push_back(issuing_inst);
-
-                // Add the FU onto the list of FU's to be freed next
-                // cycle if we used one.
-                if (idx >= 0)
-                    fuPool->freeUnitNextCycle(idx);
-            } else {
-                bool pipelined = fuPool->isPipelined(op_class);
-                // Generate completion event for the FU
-                ++wbOutstanding;
-                FUCompletion *execution = new FUCompletion(issuing_inst,
-                                                           idx, this);
-
-                cpu->schedule(execution,
-                              cpu->clockEdge(Cycles(op_latency - 1)));
-
-                if (!pipelined) {
-                    // If FU isn't pipelined, then it must be freed
-                    // upon the execution completing.
-                    execution->setFreeFU();
-                } else {
-                    // Add the FU onto the list of FU's to be freed next cycle.
-                    fuPool->freeUnitNextCycle(idx);
-                }
-            }
-
-            DPRINTF(IQ, "Thread %i: Issuing instruction PC %s "
-                    "[sn:%llu]\n",
-                    tid, issuing_inst->pcState(),
-                    issuing_inst->seqNum);
-
+        if (issueInst(issuing_inst, i2e_info)) {
             readyInsts[op_class].pop();
 
             if (!readyInsts[op_class].empty()) {
@@ -896,28 +860,10 @@ InstructionQueue<Impl>::scheduleReadyInsts()
                 queueOnList[op_class] = false;
             }
 
-            issuing_inst->setIssued();
             ++total_issued;
 
-#if TRACING_ON
-            issuing_inst->issueTick = curTick() - issuing_inst->fetchTick;
-#endif
-
-            if (!issuing_inst->isMemRef()) {
-                // Memory instructions can not be freed from the IQ until they
-                // complete.
-                ++freeEntries;
-                count[tid]--;
-                issuing_inst->clearInIQ();
-            } else {
-                memDepUnit[tid].issue(issuing_inst);
-            }
-
             listOrder.erase(order_it++);
-            statIssuedInstType[tid][op_class]++;
         } else {
-            statFuBusy[op_class]++;
-            fuBusy[tid]++;
             ++order_it;
         }
     }
@@ -936,6 +882,216 @@ InstructionQueue<Impl>::scheduleReadyInsts()
     }
 }
 
+template <class Impl>
+bool
+InstructionQueue<Impl>::issueInst(const DynInstPtr &issuing_inst,
+                                  IssueStruct *i2e_info)
+{
+    OpClass op_class = issuing_inst->opClass();
+    int idx = FUPool::NoCapableFU;
+    Cycles op_latency = Cycles(1);
+    ThreadID tid = issuing_inst->threadNumber;
+
+    if (op_class != No_OpClass) {
+        idx = fuPool->getUnit(op_class);
+        if (issuing_inst->isFloating()) {
+            fpAluAccesses++;
+        } else if (issuing_inst->isVector()) {
+            vecAluAccesses++;
+        } else {
+            intAluAccesses++;
+        }
+        if (idx > FUPool::NoFreeFU) {
+            op_latency = fuPool->getOpLatency(op_class);
+        }
+    }
+
+    // If we have an instruction that doesn't require a FU, or a
+    // valid FU, then schedule for execution.
+    if (idx == FUPool::NoFreeFU) {
+        statFuBusy[op_class]++;
+        fuBusy[tid]++;
+        return false;
+    }
+
+    if (op_latency == Cycles(1)) {
+        i2e_info->size++;
+        instsToExecute.push_back(issuing_inst);
+
+        // Add the FU onto the list of FU's to be freed next
+        // cycle if we used one.
+        if (idx >= 0)
+            fuPool->freeUnitNextCycle(idx);
+    } else {
+        bool pipelined = fuPool->isPipelined(op_class);
+        // Generate completion event for the FU
+        ++wbOutstanding;
+        FUCompletion *execution = new FUCompletion(issuing_inst,
+                                                   idx, this);
+
+        cpu->schedule(execution,
+                      cpu->clockEdge(Cycles(op_latency - 1)));
+
+        if (!pipelined) {
+            // If FU isn't pipelined, then it must be freed
+            // upon the execution completing.
+            execution->setFreeFU();
+        } else {
+            // Add the FU onto the list of FU's to be freed next cycle.
+            fuPool->freeUnitNextCycle(idx);
+        }
+    }
+
+    DPRINTF(IQ, "Thread %i: Issuing instruction PC %s "
+            "[sn:%llu]\n",
+            tid, issuing_inst->pcState(),
+            issuing_inst->seqNum);
+
+    issuing_inst->setIssued();
+
+#if TRACING_ON
+    issuing_inst->issueTick = curTick() - issuing_inst->fetchTick;
+#endif
+
+    if (!issuing_inst->isMemRef()) {
+        // Memory instructions can not be freed from the IQ until they
+        // complete.
+        ++freeEntries;
+        count[tid]--;
+        issuing_inst->clearInIQ();
+        releaseEntry(issuing_inst);
+    } else {
+        memDepUnit[tid].issue(issuing_inst);
+    }
+
+    statIssuedInstType[tid][op_class]++;
+
+    return true;
+}
+
+template <class Impl>
+int
+InstructionQueue<Impl>::scheduleFromMatrix(IssueStruct *i2e_info)
+{
+    int total_issued = 0;
+
+    // Select the oldest ready instruction until the issue width is
+    // used up. Once an op class finds no free FU, its instructions
+    // are not considered again this cycle.
+    IQMatrix::Row candidates = matrix->ready();
+    std::array<bool, Num_OpClasses> fu_busy;
+    fu_busy.fill(false);
+
+    while (total_issued < totalWidth) {
+        const int entry = matrix->oldest(candidates);
+        if (entry < 0)
+            break;
+
+        IQMatrix::remove(candidates, entry);
+
+        DynInstPtr issuing_inst = matrixInsts[entry];
+        OpClass op_class = issuing_inst->opClass();
+
+        if (fu_busy[op_class])
+            continue;
+
+        if (issuing_inst->isFloating()) {
+            fpInstQueueReads++;
+        } else if (issuing_inst->isVector()) {
+            vecInstQueueReads++;
+        } else {
+            intInstQueueReads++;
+        }
+
+        if (issuing_inst->isSquashed()) {
+            // The entry is freed when the IQ squashes the instruction
+            matrix->clearReady(entry);
+            ++iqSquashedInstsIssued;
+            continue;
+        }
+
+        if (issueInst(issuing_inst, i2e_info)) {
+            if (issuing_inst->iqEntry >= 0)
+                matrix->clearReady(entry);
+            ++total_issued;
+        } else {
+            fu_busy[op_class] = true;
+        }
+    }
+
+    return total_issued;
+}
+
+template <class Impl>
+void
+InstructionQueue<Impl>::allocateEntry(const DynInstPtr &inst)
+{
+    if (!matrix)
+        return;
+
+    inst->iqEntry = matrix->allocate();
+    matrixInsts[inst->iqEntry] = inst;
+}
+
+template <class Impl>
+void
+InstructionQueue<Impl>::releaseEntry(const DynInstPtr &inst)
+{
+    if (!matrix)
+        return;
+
+    assert(inst->iqEntry >= 0);
+    matrix->free(inst->iqEntry);
+    matrixInsts[inst->iqEntry] = nullptr;
+    inst->iqEntry = -1;
+}
+
+template <class Impl>
+void
+InstructionQueue<Impl>::addToMatrixReady(const DynInstPtr &inst)
+{
+    // Squashed instructions may have given up their entry already, they
+    // are dropped as they would be when reaching the head of a ready list
+    if (inst->isSquashed()) {
+        ++iqSquashedInstsIssued;
+        return;
+    }
+
+    assert(inst->iqEntry >= 0);
+    matrix->setReady(inst->iqEntry);
+}
+
+template <class Impl>
+int
+InstructionQueue<Impl>::wakeMatrixDependents(PhysRegIndex flat_idx)
+{
+    int dependents = 0;
+
+    matrix->wakeup(flat_idx, [this, flat_idx, &dependents](unsigned entry) {
+        DynInstPtr dep_inst = matrixInsts[entry];
+
+        DPRINTF(IQ, "Waking up a dependent instruction, [sn:%llu] "
+                "PC %s.\n", dep_inst->seqNum, dep_inst->pcState());
+
+        // The instruction waits once on the register, but it may read
+        // it through several of its sources
+        for (int src_reg_idx = 0; src_reg_idx < dep_inst->numSrcRegs();
+             src_reg_idx++) {
+            PhysRegIdPtr src_reg = dep_inst->renamedSrcRegIdx(src_reg_idx);
+            if (!dep_inst->isReadySrcRegIdx(src_reg_idx) &&
+                !src_reg->isFixedMapping() &&
+                src_reg->flatIndex() == flat_idx) {
+                dep_inst->markSrcRegReady();
+                ++dependents;
+            }
+        }
+
+        addIfReady(dep_inst);
+    });
+
+    return dependents;
+}
+
 template <class Impl>
 void
 InstructionQueue<Impl>::scheduleNonSpec(const InstSeqNum &inst)
@@ -1014,6 +1170,7 @@ InstructionQueue<Impl>::wakeDependents(const DynInstPtr &completed_inst)
         ++freeEntries;
         completed_inst->memOpDone(true);
         count[tid]--;
+        releaseEntry(completed_inst);
     } else if (completed_inst->isMemBarrier() ||
                completed_inst->isWriteBarrier()) {
         // Completes a non mem ref barrier
@@ -1050,6 +1207,10 @@ InstructionQueue<Impl>::wakeDependents(const DynInstPtr &completed_inst)
                 dest_reg->index(),
                 dest_reg->className());
 
+        if (matrix) {
+            dependents += wakeMatrixDependents(dest_reg->flatIndex());
+        }
+
         //Go through the dependency chain, marking the registers as
         //ready within the waiting instructions.
         DynInstPtr dep_inst = dependGraph.pop(dest_reg->flatIndex());
@@ -1088,6 +1249,11 @@ InstructionQueue<Impl>::addReadyMemInst(const DynInstPtr &ready_inst)
 {
     OpClass op_class = ready_inst->opClass();
 
+    if (matrix) {
+        addToMatrixReady(ready_inst);
+        return;
+    }
+
     readyInsts[op_class].push(ready_inst);
 
     // Will need to reorder the list if either a queue is not on the list,
@@ -1276,8 +1442,13 @@ InstructionQueue<Impl>::doSquash(ThreadID tid)
 
                     if (!squashed_inst->isReadySrcRegIdx(src_reg_idx) &&
                         !src_reg->isFixedMapping()) {
-                        dependGraph.remove(src_reg->flatIndex(),
-                                           squashed_inst);
+                        if (matrix) {
+                            matrix->removeWaiter(src_reg->flatIndex(),
+                                                 squashed_inst->iqEntry);
+                        } else {
+                            dependGraph.remove(src_reg->flatIndex(),
+                                               squashed_inst);
+                        }
                     }
 
                     ++iqSquashedOperandsExamined;
@@ -1322,6 +1493,7 @@ InstructionQueue<Impl>::doSquash(ThreadID tid)
             count[squashed_inst->threadNumber]--;
 
             ++freeEntries;
+            releaseEntry(squashed_inst);
         }
 
         // IQ clears out the heads of the dependency graph only when
@@ -1377,7 +1549,12 @@ InstructionQueue<Impl>::addToDependents(const DynInstPtr &new_inst)
                         new_inst->pcState(), src_reg->index(),
                         src_reg->className());
 
-                dependGraph.insert(src_reg->flatIndex(), new_inst);
+                if (matrix) {
+                    matrix->addWaiter(src_reg->flatIndex(),
+                                      new_inst->iqEntry);
+                } else {
+                    dependGraph.insert(src_reg->flatIndex(), new_inst);
+                }
 
                 // Change the return value to indicate that something
                 // was added to the dependency graph.
@@ -1458,6 +1635,11 @@ InstructionQueue<Impl>::addIfReady(const DynInstPtr &inst)
                 "the ready list, PC %s opclass:%i [sn:%llu].\n",
                 inst->pcState(), op_class, inst->seqNum);
 
+        if (matrix) {
+            addToMatrixReady(inst);
+            return;
+        }
+
         readyInsts[op_class].push(inst);
 
         // Will need to reorder the list if either a queue is not on the list,
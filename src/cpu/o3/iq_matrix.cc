@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2020 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cpu/o3/iq_matrix.hh"
+
+#include <algorithm>
+#include <cassert>
+
+#include "base/logging.hh"
+
+IQMatrix::IQMatrix(unsigned num_entries, unsigned num_regs)
+    : numEntries(num_entries), words((num_entries + 63) / 64),
+      dependency(num_regs * words, 0), age(num_entries * words, 0),
+      valid(words, 0), readyRow(words, 0)
+{
+}
+
+unsigned
+IQMatrix::allocate()
+{
+    for (unsigned w = 0; w < words; ++w) {
+        if (~valid[w] == 0)
+            continue;
+
+        const unsigned entry = w * 64 + findLsbSet(~valid[w]);
+        panic_if(entry >= numEntries, "No free IQ matrix entry.\n");
+
+        // Everything in the queue is older than the new entry, and the
+        // new entry is older than nothing. The rows of free entries are
+        // rewritten when they are allocated, so only the column bits of
+        // the entries in use need clearing.
+        std::copy(valid.begin(), valid.end(), older(entry));
+        for (unsigned v = 0; v < words; ++v) {
+            for (uint64_t bits = valid[v]; bits; bits &= bits - 1)
+                reset(older(v * 64 + findLsbSet(bits)), entry);
+        }
+
+        set(valid.data(), entry);
+        return entry;
+    }
+
+    panic("No free IQ matrix entry.\n");
+}
+
+void
+IQMatrix::free(unsigned entry)
+{
+    assert(valid[entry / 64] & (1ULL << (entry % 64)));
+    reset(valid.data(), entry);
+    reset(readyRow.data(), entry);
+}
+
+void
+IQMatrix::clear()
+{
+    std::fill(dependency.begin(), dependency.end(), 0);
+    std::fill(valid.begin(), valid.end(), 0);
+    std::fill(readyRow.begin(), readyRow.end(), 0);
+}
+
+bool
+IQMatrix::anyReady() const
+{
+    for (unsigned w = 0; w < words; ++w) {
+        if (readyRow[w])
+            return true;
+    }
+    return false;
+}
+
+int
+IQMatrix::oldest(const Row &candidates) const
+{
+    for (unsigned w = 0; w < words; ++w) {
+        for (uint64_t bits = candidates[w]; bits; bits &= bits - 1) {
+            const unsigned entry = w * 64 + findLsbSet(bits);
+            const uint64_t *row = older(entry);
+
+            bool is_oldest = true;
+            for (unsigned v = 0; v < words && is_oldest; ++v)
+                is_oldest = !(row[v] & candidates[v]);
+            if (is_oldest)
+                return entry;
+        }
+    }
+
+    return -1;
+}
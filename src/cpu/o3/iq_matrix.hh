@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2020 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CPU_O3_IQ_MATRIX_HH__
+#define __CPU_O3_IQ_MATRIX_HH__
+
+#include <cstdint>
+#include <vector>
+
+#include "base/bitfield.hh"
+
+/**
+ * Wakeup and select state of an instruction queue, kept as bit matrices
+ * in the way hardware schedulers do.
+ *
+ * Every instruction in the queue occupies an entry. The dependency
+ * matrix has a row per physical register with a bit set for each entry
+ * waiting on it, so a completing register wakes up all its consumers
+ * with a walk over a single row. The age matrix has a row per entry with
+ * a bit set for each entry allocated before it, and an entry is the
+ * oldest of a set of candidates when none of the candidates is in its
+ * row.
+ *
+ * Waking up the consumers of a register and tracking the ready entries
+ * take one operation per 64-entry word. Allocating an entry clears its
+ * column in the rows of the entries in use, and selecting the oldest of
+ * a set of candidates scans the rows of the candidates until it finds
+ * one with no older candidate, so both are linear in the occupancy of
+ * the queue, times the number of words for the selection.
+ */
+class IQMatrix
+{
+  public:
+    typedef std::vector<uint64_t> Row;
+
+    /**
+     * @param num_entries Number of entries in the queue
+     * @param num_regs Number of physical registers
+     */
+    IQMatrix(unsigned num_entries, unsigned num_regs);
+
+    /**
+     * Take a free entry, which becomes the youngest one. Linear in the
+     * number of entries in use.
+     */
+    unsigned allocate();
+
+    /** Free an entry, it must not be waiting on any register. */
+    void free(unsigned entry);
+
+    /** Free all entries and clear the dependency matrix. */
+    void clear();
+
+    /** Make an entry wait on a register. */
+    void
+    addWaiter(unsigned reg, unsigned entry)
+    {
+        set(waiters(reg), entry);
+    }
+
+    /** Stop an entry from waiting on a register. */
+    void
+    removeWaiter(unsigned reg, unsigned entry)
+    {
+        reset(waiters(reg), entry);
+    }
+
+    /**
+     * Wake up the entries waiting on a register.
+     *
+     * @param reg Register that is ready
+     * @param wake Called with every entry waiting on the register
+     */
+    template <class F>
+    void
+    wakeup(unsigned reg, F wake)
+    {
+        uint64_t *row = waiters(reg);
+        for (unsigned w = 0; w < words; ++w) {
+            uint64_t bits = row[w];
+            row[w] = 0;
+            for (; bits; bits &= bits - 1)
+                wake(w * 64 + findLsbSet(bits));
+        }
+    }
+
+    /** Mark an entry as ready to issue. */
+    void setReady(unsigned entry) { set(readyRow.data(), entry); }
+
+    /** Mark an entry as not ready to issue. */
+    void clearReady(unsigned entry) { reset(readyRow.data(), entry); }
+
+    /** Entries that are ready to issue. */
+    const Row &ready() const { return readyRow; }
+
+    /** Is any entry ready to issue? */
+    bool anyReady() const;
+
+    /**
+     * Select the oldest of a set of entries. Linear in the number of
+     * candidates times the number of words in a row.
+     *
+     * @param candidates Set of entries to select from
+     * @return The oldest entry, or -1 if there are no candidates
+     */
+    int oldest(const Row &candidates) const;
+
+    /** Remove an entry from a set of entries. */
+    static void
+    remove(Row &entries, unsigned entry)
+    {
+        reset(entries.data(), entry);
+    }
+
+  private:
+    static void
+    set(uint64_t *row, unsigned entry)
+    {
+        row[entry / 64] |= 1ULL << (entry % 64);
+    }
+
+    static void
+    reset(uint64_t *row, unsigned entry)
+    {
+        row[entry / 64] &= ~(1ULL << (entry % 64));
+    }
+
+    uint64_t *waiters(unsigned reg) { return &dependency[reg * words]; }
+    uint64_t *older(unsigned entry) { return &age[entry * words]; }
+
+    const uint64_t *
+    older(unsigned entry) const
+    {
+        return &age[entry * words];
+    }
+
+    const unsigned numEntries;
+
+    /** Number of 64-bit words in a row */
+    const unsigned words;
+
+    /** Dependency matrix, a row per register */
+    std::vector<uint64_t> dependency;
+
+    /** Age matrix, a row per entry */
+    std::vector<uint64_t> age;
+
+    /** Entries in use */
+    Row valid;
+
+    /** Entries ready to issue */
+    Row readyRow;
+};
+
+#endif // __CPU_O3_IQ_MATRIX_HH__
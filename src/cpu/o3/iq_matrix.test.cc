@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2020 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <deque>
+#include <random>
+#include <vector>
+
+#include "cpu/o3/iq_matrix.hh"
+
+namespace
+{
+
+IQMatrix::Row
+makeRow(unsigned num_entries, const std::vector<unsigned> &entries)
+{
+    IQMatrix::Row row((num_entries + 63) / 64, 0);
+    for (auto e : entries)
+        row[e / 64] |= 1ULL << (e % 64);
+    return row;
+}
+
+} // anonymous namespace
+
+TEST(IQMatrixTest, AllocateAll)
+{
+    IQMatrix matrix(70, 8);
+    std::vector<bool> used(70, false);
+    for (unsigned i = 0; i < 70; ++i) {
+        unsigned entry = matrix.allocate();
+        ASSERT_LT(entry, 70);
+        EXPECT_FALSE(used[entry]);
+        used[entry] = true;
+    }
+    EXPECT_ANY_THROW(matrix.allocate());
+
+    matrix.free(65);
+    EXPECT_EQ(matrix.allocate(), 65);
+
+    matrix.clear();
+    for (unsigned i = 0; i < 70; ++i)
+        matrix.allocate();
+}
+
+TEST(IQMatrixTest, Wakeup)
+{
+    IQMatrix matrix(130, 8);
+    for (unsigned i = 0; i < 130; ++i)
+        matrix.allocate();
+
+    matrix.addWaiter(3, 1);
+    matrix.addWaiter(3, 70);
+    matrix.addWaiter(3, 129);
+    matrix.addWaiter(5, 70);
+    matrix.removeWaiter(3, 129);
+
+    std::vector<unsigned> woken;
+    auto wake = [&woken](unsigned entry) { woken.push_back(entry); };
+
+    matrix.wakeup(3, wake);
+    EXPECT_EQ(woken, std::vector<unsigned>({ 1, 70 }));
+
+    // the row of a register is consumed by its wakeup
+    woken.clear();
+    matrix.wakeup(3, wake);
+    EXPECT_TRUE(woken.empty());
+
+    matrix.wakeup(5, wake);
+    EXPECT_EQ(woken, std::vector<unsigned>({ 70 }));
+
+    woken.clear();
+    matrix.addWaiter(4, 2);
+    matrix.clear();
+    matrix.wakeup(4, wake);
+    EXPECT_TRUE(woken.empty());
+}
+
+TEST(IQMatrixTest, Ready)
+{
+    IQMatrix matrix(100, 1);
+    for (unsigned i = 0; i < 100; ++i)
+        matrix.allocate();
+    EXPECT_FALSE(matrix.anyReady());
+
+    matrix.setReady(10);
+    matrix.setReady(80);
+    EXPECT_TRUE(matrix.anyReady());
+    EXPECT_EQ(matrix.ready(), makeRow(100, { 10, 80 }));
+
+    matrix.clearReady(10);
+    EXPECT_EQ(matrix.ready(), makeRow(100, { 80 }));
+
+    // freeing an entry takes it out of the ready set
+    matrix.free(80);
+    EXPECT_FALSE(matrix.anyReady());
+}
+
+TEST(IQMatrixTest, OldestNoCandidates)
+{
+    IQMatrix matrix(16, 1);
+    matrix.allocate();
+    EXPECT_EQ(matrix.oldest(makeRow(16, {})), -1);
+}
+
+TEST(IQMatrixTest, OldestAfterReuse)
+{
+    IQMatrix matrix(4, 1);
+    for (unsigned i = 0; i < 4; ++i)
+        EXPECT_EQ(matrix.allocate(), i);
+
+    // entry 0 comes back as the youngest entry
+    matrix.free(0);
+    EXPECT_EQ(matrix.allocate(), 0);
+    EXPECT_EQ(matrix.oldest(makeRow(4, { 0, 1, 2, 3 })), 1);
+    EXPECT_EQ(matrix.oldest(makeRow(4, { 0, 3 })), 3);
+
+    matrix.free(1);
+    matrix.free(2);
+    EXPECT_EQ(matrix.oldest(makeRow(4, { 0, 3 })), 3);
+    EXPECT_EQ(matrix.allocate(), 1);
+    EXPECT_EQ(matrix.oldest(makeRow(4, { 0, 1 })), 0);
+}
+
+/**
+ * Allocate and free entries at random, and check the selection against
+ * the order in which the entries in use were allocated.
+ */
+TEST(IQMatrixTest, OldestRandom)
+{
+    const unsigned num_entries = 150;
+    IQMatrix matrix(num_entries, 1);
+    std::deque<unsigned> order;
+    std::mt19937 rng(42);
+
+    for (unsigned step = 0; step < 20000; ++step) {
+        const bool full = order.size() == num_entries;
+        if (!full && (order.empty() || rng() % 3)) {
+            order.push_back(matrix.allocate());
+        } else {
+            auto it = order.begin() + rng() % order.size();
+            matrix.free(*it);
+            order.erase(it);
+        }
+
+        std::vector<unsigned> candidates;
+        for (auto e : order) {
+            if (rng() % 4 == 0)
+                candidates.push_back(e);
+        }
+        const int expected = candidates.empty() ? -1 : candidates.front();
+        std::shuffle(candidates.begin(), candidates.end(), rng);
+        ASSERT_EQ(matrix.oldest(makeRow(num_entries, candidates)),
+                  expected);
+    }
+}
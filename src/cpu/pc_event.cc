@@ -41,6 +41,7 @@
 using namespace std;
 
 PCEventQueue::PCEventQueue()
+    : _generation(0)
 {}
 
 PCEventQueue::~PCEventQueue()
@@ -63,6 +64,9 @@ PCEventQueue::remove(PCEvent *event)
         }
     }
 
+    if (removed > 0)
+        ++_generation;
+
     return removed > 0;
 }
 
@@ -71,6 +75,7 @@ PCEventQueue::schedule(PCEvent *event)
 {
     pcMap.push_back(event);
     sort(pcMap.begin(), pcMap.end(), MapCompare());
+    ++_generation;
 
     DPRINTF(PCEvent, "PC based event scheduled for %#x: %s\n",
             event->pc(), event->descr());
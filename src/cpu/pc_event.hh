@@ -102,6 +102,9 @@ class PCEventQueue : public PCEventScope
   protected:
     Map pcMap;
 
+    /** Incremented whenever an event is scheduled or removed */
+    uint64_t _generation;
+
     bool doService(Addr pc, ThreadContext *tc);
 
   public:
@@ -121,6 +124,12 @@ class PCEventQueue : public PCEventScope
     range_t equal_range(Addr pc);
     range_t equal_range(PCEvent *event) { return equal_range(event->pc()); }
 
+    /**
+     * Get a value that changes whenever the set of scheduled events
+     * changes. Lets users that skip PC checks know when to recheck.
+     */
+    uint64_t generation() const { return _generation; }
+
     void dump() const;
 };
 
@@ -0,0 +1,60 @@
+# Copyright (c) 2020 The Regents of the University of California
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+from m5.params import *
+from m5.objects.Probe import ProbeListenerObject
+from m5.SimObject import SimObject
+
+class BranchTraceRecorder(ProbeListenerObject):
+    """Writes the committed branches of a CPU to a branch trace in the
+    output directory."""
+
+    type = 'BranchTraceRecorder'
+    cxx_header = 'cpu/pred/branch_trace.hh'
+
+    traceFile = Param.String("branch_trace.pb.gz", "Protobuf trace file "
+                             "name, created in the output directory")
+
+class BranchTraceReplay(SimObject):
+    """Replays a branch trace through a branch predictor and exits the
+    simulation when the trace has been consumed."""
+
+    type = 'BranchTraceReplay'
+    cxx_header = 'cpu/pred/branch_trace_replay.hh'
+
+    branchPred = Param.BranchPredictor("Branch predictor to evaluate")
+    numThreads = Param.Unsigned(1, "Number of threads of the predictor, "
+                                "only single-threaded traces are supported")
+    traceFile = Param.String("Protobuf branch trace file path")
+    maxBranches = Param.UInt64(0, "Number of branches to replay, 0 replays "
+                               "the whole trace")
+    updateDelay = Param.Unsigned(0, "Number of branches predicted before "
+                                 "a prediction is committed")
+    prefetchBatches = Param.Unsigned(4, "Number of trace batches read "
+                                     "ahead by a helper thread, 0 reads "
+                                     "the trace synchronously")
+    prefetchBatchSize = Param.Unsigned(4096, "Number of records in a "
+                                       "prefetched batch")
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2020 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cpu/pred/branch_trace.hh"
+
+#include "base/callback.hh"
+#include "base/output.hh"
+#include "proto/branch_trace.pb.h"
+
+BranchTraceRecorder::BranchTraceRecorder(
+        const BranchTraceRecorderParams *params)
+    : ProbeListenerObject(params), traceStream(nullptr), numInsts(0)
+{
+    fatal_if(!dynamic_cast<BaseCPU *>(params->manager),
+             "Manager of %s is not a CPU.\n", name());
+    fatal_if(params->traceFile == "", "Assign the branch trace file path "
+             "to traceFile");
+
+    traceStream = new ProtoOutputStream(
+        simout.resolve(name() + "." + params->traceFile));
+
+    ProtoMessage::BranchTraceHeader header;
+    header.set_obj_id(name());
+    traceStream->write(header);
+
+    registerExitCallback([this]() { closeStream(); });
+}
+
+void
+BranchTraceRecorder::regProbeListeners()
+{
+    typedef ProbeListenerArg<BranchTraceRecorder, uint64_t> InstListener;
+    typedef ProbeListenerArg<BranchTraceRecorder, BaseCPU::RetiredBranch>
+        BranchListener;
+
+    listeners.push_back(new InstListener(this, "RetiredInsts",
+        &BranchTraceRecorder::retiredInsts));
+    listeners.push_back(new BranchListener(this, "RetiredBranchInfo",
+        &BranchTraceRecorder::retiredBranch));
+}
+
+void
+BranchTraceRecorder::retiredInsts(const uint64_t &count)
+{
+    numInsts += count;
+}
+
+void
+BranchTraceRecorder::retiredBranch(const BaseCPU::RetiredBranch &branch)
+{
+    if (!traceStream)
+        return;
+
+    const StaticInstPtr &inst = branch.inst;
+    uint32_t flags = 0;
+    if (inst->isCondCtrl())
+        flags |= ProtoMessage::Branch::COND;
+    if (inst->isDirectCtrl())
+        flags |= ProtoMessage::Branch::DIRECT;
+    if (inst->isCall())
+        flags |= ProtoMessage::Branch::CALL;
+    if (inst->isReturn())
+        flags |= ProtoMessage::Branch::RETURN;
+
+    ProtoMessage::Branch rec;
+    rec.set_pc(branch.pc);
+    rec.set_target(branch.target);
+    rec.set_taken(branch.taken);
+    if (flags)
+        rec.set_flags(flags);
+    if (numInsts != 1)
+        rec.set_inst_delta(numInsts);
+    traceStream->write(rec);
+
+    numInsts = 0;
+}
+
+void
+BranchTraceRecorder::closeStream()
+{
+    delete traceStream;
+    traceStream = nullptr;
+}
+
+BranchTraceRecorder *
+BranchTraceRecorderParams::create()
+{
+    return new BranchTraceRecorder(this);
+}
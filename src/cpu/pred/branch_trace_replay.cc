@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2020 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cpu/pred/branch_trace_replay.hh"
+
+#include <chrono>
+
+#include "arch/isa_traits.hh"
+#include "base/logging.hh"
+#include "sim/core.hh"
+#include "sim/sim_exit.hh"
+
+namespace
+{
+
+TheISA::ExtMachInst traceMachInst;
+
+/**
+ * A stand-in for a traced branch. The predictor only looks at the flags of
+ * the instruction and advances the PC past it to get the fallthrough
+ * address, which the replay sets as the next PC of the branch.
+ */
+class TraceBranchInst : public StaticInst
+{
+  public:
+    TraceBranchInst(uint32_t flags)
+        : StaticInst("trace_branch", traceMachInst, No_OpClass)
+    {
+        setFlag(IsControl);
+        setFlag(flags & ProtoMessage::Branch::COND ?
+                IsCondControl : IsUncondControl);
+        setFlag(flags & ProtoMessage::Branch::DIRECT ?
+                IsDirectControl : IsIndirectControl);
+        if (flags & ProtoMessage::Branch::CALL)
+            setFlag(IsCall);
+        if (flags & ProtoMessage::Branch::RETURN)
+            setFlag(IsReturn);
+    }
+
+    Fault
+    execute(ExecContext *xc, Trace::InstRecord *traceData) const override
+    {
+        panic("Traced branches cannot be executed.\n");
+    }
+
+    void
+    advancePC(TheISA::PCState &pcState) const override
+    {
+        pcState.advance();
+    }
+
+    std::string
+    generateDisassembly(Addr pc,
+            const Loader::SymbolTable *symtab) const override
+    {
+        return mnemonic;
+    }
+};
+
+} // anonymous namespace
+
+BranchTraceReplay::BranchTraceReplay(const BranchTraceReplayParams *params)
+    : SimObject(params),
+      bpred(params->branchPred),
+      traceFile(params->traceFile),
+      maxBranches(params->maxBranches),
+      updateDelay(params->updateDelay),
+      traceStream(new ProtoPrefetchStream<ProtoMessage::Branch>(
+          params->traceFile, params->prefetchBatches,
+          params->prefetchBatchSize)),
+      replayEvent([this]{ replay(); }, name()),
+      stats(this)
+{
+    fatal_if(params->numThreads != 1, "%s only replays single-threaded "
+             "traces.\n", name());
+
+    ProtoMessage::BranchTraceHeader header;
+    fatal_if(!traceStream->readHeader(header), "Failed to read the header "
+             "of branch trace %s.\n", traceFile);
+    inform("%s: replaying branch trace of %s\n", name(), header.obj_id());
+}
+
+void
+BranchTraceReplay::startup()
+{
+    schedule(replayEvent, curTick());
+}
+
+BranchTraceReplay::Kind
+BranchTraceReplay::kind(uint32_t flags)
+{
+    if (flags & ProtoMessage::Branch::COND)
+        return Conditional;
+    if (flags & ProtoMessage::Branch::RETURN)
+        return Return;
+    if (flags & ProtoMessage::Branch::DIRECT)
+        return DirectUncond;
+    return Indirect;
+}
+
+BranchTraceReplay::BranchInfo &
+BranchTraceReplay::lookup(Addr pc, uint32_t flags)
+{
+    auto it = branches.find(pc);
+    if (it == branches.end()) {
+        it = branches.emplace(pc, BranchInfo{nullptr, flags,
+            pc + sizeof(TheISA::MachInst)}).first;
+    }
+
+    // Self-modifying code may place a different branch at an address.
+    BranchInfo &info = it->second;
+    if (!info.inst || info.flags != flags) {
+        info.inst = new TraceBranchInst(flags);
+        info.flags = flags;
+    }
+    return info;
+}
+
+void
+BranchTraceReplay::learn(const ProtoMessage::Branch &rec)
+{
+    if (!rec.taken()) {
+        branches[rec.pc()].fallthrough = rec.target();
+        return;
+    }
+
+    if (rec.flags() & ProtoMessage::Branch::CALL) {
+        if (callStack.size() == maxCallDepth)
+            callStack.erase(callStack.begin());
+        callStack.push_back(rec.pc());
+    } else if ((rec.flags() & ProtoMessage::Branch::RETURN) &&
+               !callStack.empty()) {
+        auto it = branches.find(callStack.back());
+        if (it != branches.end())
+            it->second.fallthrough = rec.target();
+        callStack.pop_back();
+    }
+}
+
+void
+BranchTraceReplay::predict(const ProtoMessage::Branch &rec,
+                           InstSeqNum seq_num)
+{
+    const BranchInfo &info = lookup(rec.pc(), rec.flags());
+
+    TheISA::PCState pc(rec.pc());
+    pc.npc(info.fallthrough);
+    bool pred_taken = bpred->predict(info.inst, seq_num, pc, 0);
+
+    Kind k = kind(rec.flags());
+    stats.branches[k]++;
+    if (pred_taken != rec.taken() ||
+        (rec.taken() && pc.instAddr() != rec.target())) {
+        stats.mispredicts[k]++;
+        bpred->squash(seq_num, TheISA::PCState(rec.target()), rec.taken(),
+                      0);
+    }
+
+    if (seq_num > updateDelay)
+        bpred->update(seq_num - updateDelay, 0);
+}
+
+void
+BranchTraceReplay::replay()
+{
+    auto start = std::chrono::steady_clock::now();
+
+    ProtoMessage::Branch rec;
+    InstSeqNum seq_num = 0;
+    while ((maxBranches == 0 || seq_num < maxBranches) &&
+           traceStream->read(rec)) {
+        predict(rec, ++seq_num);
+        learn(rec);
+        stats.insts += rec.inst_delta();
+    }
+    bpred->update(seq_num, 0);
+
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    stats.hostSeconds = elapsed.count();
+
+    inform("%s: replayed %d branches in %.2fs (%.0f branches/s)\n", name(),
+           seq_num, elapsed.count(),
+           elapsed.count() > 0 ? seq_num / elapsed.count() : 0.0);
+    exitSimLoop("branch trace replay complete");
+}
+
+BranchTraceReplay::BranchTraceReplayStats::BranchTraceReplayStats(
+        Stats::Group *parent)
+    : Stats::Group(parent),
+      ADD_STAT(branches, "Number of replayed branches"),
+      ADD_STAT(mispredicts, "Number of mispredicted branches"),
+      ADD_STAT(insts, "Number of instructions covered by the trace"),
+      ADD_STAT(hostSeconds, "Host time spent replaying the trace"),
+      ADD_STAT(mpki, "Mispredicted branches per thousand instructions"),
+      ADD_STAT(accuracy, "Fraction of correctly predicted branches"),
+      ADD_STAT(branchRate, "Replayed branches per host second")
+{
+    branches.init(NumKinds);
+    mispredicts.init(NumKinds);
+    for (auto stat : {&branches, &mispredicts}) {
+        stat->subname(Conditional, "conditional")
+            .subname(DirectUncond, "directUncond")
+            .subname(Indirect, "indirect")
+            .subname(Return, "return");
+    }
+    branches.flags(Stats::total);
+    mispredicts.flags(Stats::total);
+
+    mpki = 1000 * sum(mispredicts) / insts;
+    mpki.precision(4);
+    accuracy = 1 - sum(mispredicts) / sum(branches);
+    accuracy.precision(6);
+    branchRate = sum(branches) / hostSeconds;
+    branchRate.precision(0);
+}
+
+BranchTraceReplay *
+BranchTraceReplayParams::create()
+{
+    return new BranchTraceReplay(this);
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2020 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Replays a branch trace captured by the BranchTraceRecorder through a
+ * branch predictor, without any CPU model.
+ *
+ * Every branch is predicted through the BPredUnit interface used by the
+ * CPU models, so the BTB, RAS and indirect predictor take part in the
+ * prediction. Mispredicted branches are squashed with their traced outcome
+ * and predictions are committed updateDelay branches after they were made,
+ * which approximates the update delay of a pipeline. The replay runs in a
+ * single event and ends the simulation when the trace has been consumed.
+ *
+ * The trace does not contain the instructions, so every branch address is
+ * given a synthetic instruction with the flags of the traced branch. The
+ * fallthrough address of a branch is learned from its not-taken outcomes
+ * and, for calls, from the target of the matching return. Until then it is
+ * assumed to be the next MachInst, so the first return to a call site may
+ * be mispredicted on ISAs with variable instruction sizes.
+ */
+
+#ifndef __CPU_PRED_BRANCH_TRACE_REPLAY_HH__
+#define __CPU_PRED_BRANCH_TRACE_REPLAY_HH__
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "base/statistics.hh"
+#include "cpu/pred/bpred_unit.hh"
+#include "cpu/static_inst.hh"
+#include "params/BranchTraceReplay.hh"
+#include "proto/branch_trace.pb.h"
+#include "proto/protoio.hh"
+#include "sim/eventq.hh"
+#include "sim/sim_object.hh"
+
+class BranchTraceReplay : public SimObject
+{
+  public:
+    BranchTraceReplay(const BranchTraceReplayParams *params);
+
+    void startup() override;
+
+  private:
+    /** Kinds of branches the statistics are split by. */
+    enum Kind
+    {
+        Conditional,
+        DirectUncond,
+        Indirect,
+        Return,
+        NumKinds
+    };
+
+    /** What is known about the branch at an address. */
+    struct BranchInfo
+    {
+        StaticInstPtr inst;
+        /** Trace flags the instruction was created for */
+        uint32_t flags;
+        /** Address of the next sequential instruction */
+        Addr fallthrough;
+    };
+
+    /** Replay the whole trace. */
+    void replay();
+
+    /** Predict a traced branch and resolve it with its outcome. */
+    void predict(const ProtoMessage::Branch &rec, InstSeqNum seq_num);
+
+    /** Look up the branch at an address, creating it if necessary. */
+    BranchInfo &lookup(Addr pc, uint32_t flags);
+
+    /** Learn the fallthrough addresses from the outcome of a branch. */
+    void learn(const ProtoMessage::Branch &rec);
+
+    static Kind kind(uint32_t flags);
+
+    BPredUnit *bpred;
+
+    const std::string traceFile;
+
+    const uint64_t maxBranches;
+
+    const unsigned updateDelay;
+
+    std::unique_ptr<ProtoPrefetchStream<ProtoMessage::Branch>> traceStream;
+
+    std::unordered_map<Addr, BranchInfo> branches;
+
+    /** Addresses of the calls that have not returned yet. */
+    std::vector<Addr> callStack;
+
+    /** Depth beyond which the oldest calls are forgotten. */
+    static const size_t maxCallDepth = 1024;
+
+    EventFunctionWrapper replayEvent;
+
+    struct BranchTraceReplayStats : public Stats::Group
+    {
+        BranchTraceReplayStats(Stats::Group *parent);
+
+        /** Number of replayed branches */
+        Stats::Vector branches;
+        /** Number of mispredicted branches */
+        Stats::Vector mispredicts;
+        /** Number of instructions covered by the replayed branches */
+        Stats::Scalar insts;
+        /** Host time spent in the replay */
+        Stats::Scalar hostSeconds;
+        Stats::Formula mpki;
+        Stats::Formula accuracy;
+        Stats::Formula branchRate;
+    } stats;
+};
+
+#endif // __CPU_PRED_BRANCH_TRACE_REPLAY_HH__
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2014 The University of Wisconsin
+ *
+ * Copyright (c) 2006 INRIA (Institut National de Recherche en
+ * Informatique et en Automatique  / French National Research Institute
+ * for Computer Science and Applied Mathematics)
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cpu/pred/folded_histories.hh"
+
+#include <algorithm>
+#include <cassert>
+
+#include "base/types.hh"
+
+void
+FoldedHistories::init(unsigned num_banks)
+{
+    numBanks = num_banks;
+    comp.assign(3 * num_banks, 0);
+    origLengths.assign(3 * num_banks, 0);
+    outpoints.assign(3 * num_banks, 0);
+    compLengths.assign(3 * num_banks, 0);
+    // A zero mask keeps the histories of bank 0 at zero.
+    masks.assign(3 * num_banks, 0);
+}
+
+void
+FoldedHistories::initBank(int bank, int original_length,
+                          int index_length, int tag0_length,
+                          int tag1_length)
+{
+    assert(bank > 0 && bank < (int)numBanks);
+    const int lengths[3] = { index_length, tag0_length, tag1_length };
+    for (int j = 0; j < 3; j++) {
+        const int i = j * numBanks + bank;
+        origLengths[i] = original_length;
+        compLengths[i] = lengths[j];
+        outpoints[i] = original_length % lengths[j];
+        masks[i] = (ULL(1) << lengths[j]) - 1;
+    }
+}
+
+void
+FoldedHistories::save(int *dst) const
+{
+    for (int j = 0; j < 3; j++) {
+        std::copy(comp.begin() + j * numBanks + 1,
+                  comp.begin() + (j + 1) * numBanks,
+                  dst + j * numBanks + 1);
+    }
+}
+
+void
+FoldedHistories::restore(const int *src)
+{
+    for (int j = 0; j < 3; j++) {
+        std::copy(src + j * numBanks + 1, src + (j + 1) * numBanks,
+                  comp.begin() + j * numBanks + 1);
+    }
+}
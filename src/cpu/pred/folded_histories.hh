@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2014 The University of Wisconsin
+ *
+ * Copyright (c) 2006 INRIA (Institut National de Recherche en
+ * Informatique et en Automatique  / French National Research Institute
+ * for Computer Science and Applied Mathematics)
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* @file
+ * Folded global histories of the TAGE tagged tables
+ */
+
+#ifndef __CPU_PRED_FOLDED_HISTORIES_HH__
+#define __CPU_PRED_FOLDED_HISTORIES_HH__
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Folded (compressed) histories of all the tagged tables of a thread,
+ * mixed with the instruction PC to index the tables and compute their
+ * partial tags. Every bank has a history for its index and two for its
+ * tag. They are stored as a structure of arrays laid out as
+ * [indices | tags 0 | tags 1], so that a new outcome is folded into all
+ * of them in a single pass over contiguous arrays, which the compiler
+ * can vectorize, instead of one call per history. The histories of
+ * bank 0 (the bimodal table) are unused and always zero.
+ */
+class FoldedHistories
+{
+  public:
+    FoldedHistories() : numBanks(0) { }
+
+    /** Allocate the histories of num_banks banks, all zero. */
+    void init(unsigned num_banks);
+
+    /**
+     * Set the lengths of the histories of a bank.
+     * @param original_length Length of the global history folded.
+     * @param index_length Length of the index history.
+     * @param tag0_length Length of the first tag history.
+     * @param tag1_length Length of the second tag history.
+     */
+    void initBank(int bank, int original_length, int index_length,
+                  int tag0_length, int tag1_length);
+
+    unsigned index(int bank) const { return comp[bank]; }
+    unsigned tag0(int bank) const { return comp[numBanks + bank]; }
+    unsigned tag1(int bank) const { return comp[2 * numBanks + bank]; }
+
+    /** Length of the global history folded into a bank. */
+    int origLength(int bank) const { return origLengths[bank]; }
+
+    /**
+     * Fold the most recent outcome into all the histories.
+     * @param h Pointer to the most recent outcome in the global
+     * history buffer.
+     */
+    void
+    update(const uint8_t *h)
+    {
+        const unsigned newest = h[0];
+        const unsigned num_folds = comp.size();
+        for (unsigned i = 0; i < num_folds; i++) {
+            unsigned c = (comp[i] << 1) | newest;
+            c ^= unsigned(h[origLengths[i]]) << outpoints[i];
+            c ^= c >> compLengths[i];
+            comp[i] = c & masks[i];
+        }
+    }
+
+    /**
+     * Save the histories of all banks but bank 0 to three consecutive
+     * arrays of numBanks entries, e.g., BranchInfo::ci, ct0 and ct1.
+     */
+    void save(int *dst) const;
+
+    /** Restore the histories saved by save(). */
+    void restore(const int *src);
+
+  private:
+    unsigned numBanks;
+    std::vector<unsigned> comp;
+    std::vector<int> origLengths;
+    std::vector<unsigned> outpoints;
+    std::vector<unsigned> compLengths;
+    std::vector<unsigned> masks;
+};
+
+#endif // __CPU_PRED_FOLDED_HISTORIES_HH__
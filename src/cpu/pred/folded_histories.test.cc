@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2014 The University of Wisconsin
+ *
+ * Copyright (c) 2006 INRIA (Institut National de Recherche en
+ * Informatique et en Automatique  / French National Research Institute
+ * for Computer Science and Applied Mathematics)
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "base/types.hh"
+#include "cpu/pred/folded_histories.hh"
+
+namespace
+{
+
+/** A single folded history, updated one at a time as TAGE used to. */
+struct FoldedHistory
+{
+    unsigned comp;
+    int compLength;
+    int origLength;
+    int outpoint;
+
+    FoldedHistory()
+    {
+        comp = 0;
+    }
+
+    void init(int original_length, int compressed_length)
+    {
+        origLength = original_length;
+        compLength = compressed_length;
+        outpoint = original_length % compressed_length;
+    }
+
+    void update(const uint8_t * h)
+    {
+        comp = (comp << 1) | h[0];
+        comp ^= h[origLength] << outpoint;
+        comp ^= (comp >> compLength);
+        comp &= (ULL(1) << compLength) - 1;
+    }
+};
+
+/** The histories of a set of banks, with their reference folds. */
+struct Banks
+{
+    Banks(int num_banks, std::mt19937 &rng)
+        : numBanks(num_banks), index(num_banks), tag0(num_banks),
+          tag1(num_banks)
+    {
+        batched.init(num_banks);
+        for (int i = 1; i < num_banks; i++) {
+            const int orig = 1 + rng() % 2000;
+            const int index_len = 7 + rng() % 12;
+            const int tag_len = 7 + rng() % 10;
+            index[i].init(orig, index_len);
+            tag0[i].init(orig, tag_len);
+            tag1[i].init(orig, tag_len - 1);
+            batched.initBank(i, orig, index_len, tag_len, tag_len - 1);
+        }
+    }
+
+    void
+    update(const uint8_t *h)
+    {
+        for (int i = 1; i < numBanks; i++) {
+            index[i].update(h);
+            tag0[i].update(h);
+            tag1[i].update(h);
+        }
+        batched.update(h);
+    }
+
+    void
+    expectEqual() const
+    {
+        EXPECT_EQ(batched.index(0), 0);
+        EXPECT_EQ(batched.tag0(0), 0);
+        EXPECT_EQ(batched.tag1(0), 0);
+        for (int i = 1; i < numBanks; i++) {
+            ASSERT_EQ(batched.index(i), index[i].comp);
+            ASSERT_EQ(batched.tag0(i), tag0[i].comp);
+            ASSERT_EQ(batched.tag1(i), tag1[i].comp);
+            ASSERT_EQ(batched.origLength(i), index[i].origLength);
+        }
+    }
+
+    const int numBanks;
+    FoldedHistories batched;
+    std::vector<FoldedHistory> index;
+    std::vector<FoldedHistory> tag0;
+    std::vector<FoldedHistory> tag1;
+};
+
+} // anonymous namespace
+
+/**
+ * Fold random histories into random table geometries, and check the
+ * batched update against updating every history on its own.
+ */
+TEST(FoldedHistoriesTest, Update)
+{
+    std::mt19937 rng(1);
+    const int steps = 20000;
+    std::vector<uint8_t> history(steps + 2048);
+    for (auto &bit : history)
+        bit = rng() & 1;
+
+    for (int config = 0; config < 20; config++) {
+        Banks banks(5 + rng() % 30, rng);
+        // the global history grows towards lower addresses
+        for (int step = 1; step <= steps; step++) {
+            banks.update(&history[steps - step]);
+            banks.expectEqual();
+        }
+    }
+}
+
+/** Restoring saved histories rolls them back to the saved values. */
+TEST(FoldedHistoriesTest, SaveRestore)
+{
+    std::mt19937 rng(2);
+    const int steps = 1000;
+    std::vector<uint8_t> history(steps + 2048);
+    for (auto &bit : history)
+        bit = rng() & 1;
+
+    Banks banks(13, rng);
+    std::vector<int> saved(3 * banks.numBanks, 0);
+    std::vector<FoldedHistory> index, tag0, tag1;
+    for (int step = 1; step <= steps; step++) {
+        if (step % 97 == 1) {
+            banks.batched.save(saved.data());
+            index = banks.index;
+            tag0 = banks.tag0;
+            tag1 = banks.tag1;
+        } else if (step % 97 == 40) {
+            banks.batched.restore(saved.data());
+            banks.index = index;
+            banks.tag0 = tag0;
+            banks.tag1 = tag1;
+            banks.expectEqual();
+        }
+        banks.update(&history[steps - step]);
+        banks.expectEqual();
+    }
+
+    // bank 0 is neither saved nor restored
+    EXPECT_EQ(saved[0], 0);
+    EXPECT_EQ(saved[banks.numBanks], 0);
+    EXPECT_EQ(saved[2 * banks.numBanks], 0);
+}
@@ -37,6 +37,8 @@
 
 #include "cpu/pred/tage_base.hh"
 
+#include <algorithm>
+
 #include "base/intmath.hh"
 #include "base/logging.hh"
 #include "debug/Fetch.hh"
@@ -120,11 +122,10 @@ TAGEBase::init()
     // implementation
     assert(tagTableTagWidths[0] == 0);
 
-    for (auto& history : threadHistory) {
-        history.computeIndices = new FoldedHistory[nHistoryTables+1];
-        history.computeTags[0] = new FoldedHistory[nHistoryTables+1];
-        history.computeTags[1] = new FoldedHistory[nHistoryTables+1];
+    calculateHashConstants();
 
+    for (auto& history : threadHistory) {
+        history.folded.init(nHistoryTables + 1);
         initFoldedHistories(history);
     }
 
@@ -145,17 +146,29 @@ void
 TAGEBase::initFoldedHistories(ThreadHistory & history)
 {
     for (int i = 1; i <= nHistoryTables; i++) {
-        history.computeIndices[i].init(
-            histLengths[i], (logTagTableSizes[i]));
-        history.computeTags[0][i].init(
-            history.computeIndices[i].origLength, tagTableTagWidths[i]);
-        history.computeTags[1][i].init(
-            history.computeIndices[i].origLength, tagTableTagWidths[i]-1);
+        history.folded.initBank(i, histLengths[i], logTagTableSizes[i],
+                                tagTableTagWidths[i],
+                                tagTableTagWidths[i] - 1);
         DPRINTF(Tage, "HistLength:%d, TTSize:%d, TTTWidth:%d\n",
                 histLengths[i], logTagTableSizes[i], tagTableTagWidths[i]);
     }
 }
 
+void
+TAGEBase::calculateHashConstants()
+{
+    pathHistLengths.resize(nHistoryTables + 1, 0);
+    pcShifts.resize(nHistoryTables + 1, 0);
+    indexMasks.resize(nHistoryTables + 1, 0);
+    tagMasks.resize(nHistoryTables + 1, 0);
+    for (int i = 1; i <= nHistoryTables; i++) {
+        pathHistLengths[i] = std::min<int>(histLengths[i], pathHistBits);
+        pcShifts[i] = abs(logTagTableSizes[i] - i) + 1;
+        indexMasks[i] = (ULL(1) << logTagTableSizes[i]) - 1;
+        tagMasks[i] = (ULL(1) << tagTableTagWidths[i]) - 1;
+    }
+}
+
 void
 TAGEBase::buildTageTables()
 {
@@ -186,14 +199,8 @@ TAGEBase::btbUpdate(ThreadID tid, Addr branch_pc, BranchInfo* &bi)
         DPRINTF(Tage, "BTB miss resets prediction: %lx\n", branch_pc);
         assert(tHist.gHist == &tHist.globalHistory[tHist.ptGhist]);
         tHist.gHist[0] = 0;
-        for (int i = 1; i <= nHistoryTables; i++) {
-            tHist.computeIndices[i].comp = bi->ci[i];
-            tHist.computeTags[0][i].comp = bi->ct0[i];
-            tHist.computeTags[1][i].comp = bi->ct1[i];
-            tHist.computeIndices[i].update(tHist.gHist);
-            tHist.computeTags[0][i].update(tHist.gHist);
-            tHist.computeTags[1][i].update(tHist.gHist);
-        }
+        tHist.folded.restore(bi->ci);
+        tHist.folded.update(tHist.gHist);
     }
 }
 
@@ -223,17 +230,13 @@ TAGEBase::F(int A, int size, int bank) const
 int
 TAGEBase::gindex(ThreadID tid, Addr pc, int bank) const
 {
-    int index;
-    int hlen = (histLengths[bank] > pathHistBits) ? pathHistBits :
-                                                    histLengths[bank];
     const unsigned int shiftedPc = pc >> instShiftAmt;
-    index =
-        shiftedPc ^
-        (shiftedPc >> ((int) abs(logTagTableSizes[bank] - bank) + 1)) ^
-        threadHistory[tid].computeIndices[bank].comp ^
-        F(threadHistory[tid].pathHist, hlen, bank);
+    int index =
+        shiftedPc ^ (shiftedPc >> pcShifts[bank]) ^
+        threadHistory[tid].folded.index(bank) ^
+        F(threadHistory[tid].pathHist, pathHistLengths[bank], bank);
 
-    return (index & ((ULL(1) << (logTagTableSizes[bank])) - 1));
+    return (index & indexMasks[bank]);
 }
 
 
@@ -242,10 +245,10 @@ uint16_t
 TAGEBase::gtag(ThreadID tid, Addr pc, int bank) const
 {
     int tag = (pc >> instShiftAmt) ^
-              threadHistory[tid].computeTags[0][bank].comp ^
-              (threadHistory[tid].computeTags[1][bank].comp << 1);
+              threadHistory[tid].folded.tag0(bank) ^
+              (threadHistory[tid].folded.tag1(bank) << 1);
 
-    return (tag & ((ULL(1) << tagTableTagWidths[bank]) - 1));
+    return (tag & tagMasks[bank]);
 }
 
 
@@ -601,17 +604,10 @@ TAGEBase::updateHistories(ThreadID tid, Addr branch_pc, bool taken,
     }
 
     //prepare next index and tag computations for user branchs
-    for (int i = 1; i <= nHistoryTables; i++)
-    {
-        if (speculative) {
-            bi->ci[i]  = tHist.computeIndices[i].comp;
-            bi->ct0[i] = tHist.computeTags[0][i].comp;
-            bi->ct1[i] = tHist.computeTags[1][i].comp;
-        }
-        tHist.computeIndices[i].update(tHist.gHist);
-        tHist.computeTags[0][i].update(tHist.gHist);
-        tHist.computeTags[1][i].update(tHist.gHist);
+    if (speculative) {
+        tHist.folded.save(bi->ci);
     }
+    tHist.folded.update(tHist.gHist);
     DPRINTF(Tage, "Updating global histories with branch:%lx; taken?:%d, "
             "path Hist: %x; pointer:%d\n", branch_pc, taken, tHist.pathHist,
             tHist.ptGhist);
@@ -635,14 +631,8 @@ TAGEBase::squash(ThreadID tid, bool taken, TAGEBase::BranchInfo *bi,
     tHist.ptGhist = bi->ptGhist;
     tHist.gHist = &(tHist.globalHistory[tHist.ptGhist]);
     tHist.gHist[0] = (taken ? 1 : 0);
-    for (int i = 1; i <= nHistoryTables; i++) {
-        tHist.computeIndices[i].comp = bi->ci[i];
-        tHist.computeTags[0][i].comp = bi->ct0[i];
-        tHist.computeTags[1][i].comp = bi->ct1[i];
-        tHist.computeIndices[i].update(tHist.gHist);
-        tHist.computeTags[0][i].update(tHist.gHist);
-        tHist.computeTags[1][i].update(tHist.gHist);
-    }
+    tHist.folded.restore(bi->ci);
+    tHist.folded.update(tHist.gHist);
 }
 
 void
@@ -51,6 +51,7 @@
 #include <vector>
 
 #include "base/statistics.hh"
+#include "cpu/pred/folded_histories.hh"
 #include "cpu/static_inst.hh"
 #include "params/TAGEBase.hh"
 #include "sim/sim_object.hh"
@@ -65,44 +66,13 @@ class TAGEBase : public SimObject
     // Prediction Structures
 
     // Tage Entry
+    // The fields are ordered to avoid padding, an entry fits in 4 bytes
     struct TageEntry
     {
-        int8_t ctr;
         uint16_t tag;
+        int8_t ctr;
         uint8_t u;
-        TageEntry() : ctr(0), tag(0), u(0) { }
-    };
-
-    // Folded History Table - compressed history
-    // to mix with instruction PC to index partially
-    // tagged tables.
-    struct FoldedHistory
-    {
-        unsigned comp;
-        int compLength;
-        int origLength;
-        int outpoint;
-        int bufferSize;
-
-        FoldedHistory()
-        {
-            comp = 0;
-        }
-
-        void init(int original_length, int compressed_length)
-        {
-            origLength = original_length;
-            compLength = compressed_length;
-            outpoint = original_length % compressed_length;
-        }
-
-        void update(uint8_t * h)
-        {
-            comp = (comp << 1) | h[0];
-            comp ^= h[origLength] << outpoint;
-            comp ^= (comp >> compLength);
-            comp &= (ULL(1) << compLength) - 1;
-        }
+        TageEntry() : tag(0), ctr(0), u(0) { }
     };
 
   public:
@@ -140,7 +110,8 @@ class TAGEBase : public SimObject
         int *storage;
 
         // Pointers to actual saved array within the dynamically
-        // allocated storage.
+        // allocated storage. ci, ct0 and ct1 must be consecutive,
+        // see FoldedHistories::save().
         int *tableIndices;
         int *tableTags;
         int *ci;
@@ -448,8 +419,7 @@ class TAGEBase : public SimObject
         int ptGhist;
 
         // Speculative folded histories.
-        FoldedHistory *computeIndices;
-        FoldedHistory *computeTags[2];
+        FoldedHistories folded;
     };
 
     std::vector<ThreadHistory> threadHistory;
@@ -460,6 +430,19 @@ class TAGEBase : public SimObject
     virtual void initFoldedHistories(ThreadHistory & history);
 
     int *histLengths;
+
+    // Per bank constants of the index and tag hashes, precomputed from
+    // histLengths, logTagTableSizes and tagTableTagWidths.
+    std::vector<int> pathHistLengths;
+    std::vector<int> pcShifts;
+    std::vector<unsigned> indexMasks;
+    std::vector<unsigned> tagMasks;
+
+    /**
+     * Precompute the per bank hash constants
+     */
+    void calculateHashConstants();
+
     int *tableIndices;
     int *tableTags;
 
@@ -179,20 +179,16 @@ TAGE_SC_L_TAGE::getUseAltIdx(TAGEBase::BranchInfo* bi, Addr branch_pc)
 int
 TAGE_SC_L_TAGE::gindex(ThreadID tid, Addr pc, int bank) const
 {
-    int index;
-    int hlen = (histLengths[bank] > pathHistBits) ? pathHistBits :
-                                                    histLengths[bank];
     unsigned int shortPc = pc;
 
     // pc is not shifted by instShiftAmt in this implementation
-    index = shortPc ^
-            (shortPc >> ((int) abs(logTagTableSizes[bank] - bank) + 1)) ^
-            threadHistory[tid].computeIndices[bank].comp ^
-            F(threadHistory[tid].pathHist, hlen, bank);
+    int index = shortPc ^ (shortPc >> pcShifts[bank]) ^
+                threadHistory[tid].folded.index(bank) ^
+                F(threadHistory[tid].pathHist, pathHistLengths[bank], bank);
 
     index = gindex_ext(index, bank);
 
-    return (index & ((ULL(1) << (logTagTableSizes[bank])) - 1));
+    return (index & indexMasks[bank]);
 }
 
 int
@@ -253,11 +249,7 @@ TAGE_SC_L_TAGE::updatePathAndGlobalHistory(
             // The 8KB implementation does not do this truncation
             tHist.pathHist = (tHist.pathHist & ((ULL(1) << pathHistBits) - 1));
         }
-        for (int i = 1; i <= nHistoryTables; i++) {
-            tHist.computeIndices[i].update(tHist.gHist);
-            tHist.computeTags[0][i].update(tHist.gHist);
-            tHist.computeTags[1][i].update(tHist.gHist);
-        }
+        tHist.folded.update(tHist.gHist);
     }
 }
 
@@ -149,12 +149,8 @@ TAGE_SC_L_TAGE_8KB::initFoldedHistories(ThreadHistory & history)
     // Some hardcoded values are used here
     // (they do not seem to depend on any parameter)
     for (int i = 1; i <= nHistoryTables; i++) {
-        history.computeIndices[i].init(
-            histLengths[i], 17 + (2 * ((i - 1) / 2) % 4));
-        history.computeTags[0][i].init(
-            history.computeIndices[i].origLength, 13);
-        history.computeTags[1][i].init(
-            history.computeIndices[i].origLength, 11);
+        history.folded.initBank(i, histLengths[i],
+                                17 + (2 * ((i - 1) / 2) % 4), 13, 11);
         DPRINTF(TageSCL, "HistLength:%d, TTSize:%d, TTTWidth:%d\n",
                 histLengths[i], logTagTableSizes[i], tagTableTagWidths[i]);
     }
@@ -170,19 +166,16 @@ TAGE_SC_L_TAGE_8KB::gindex_ext(int index, int bank) const
 uint16_t
 TAGE_SC_L_TAGE_8KB::gtag(ThreadID tid, Addr pc, int bank) const
 {
-    int tag = (threadHistory[tid].computeIndices[bank - 1].comp << 2) ^ pc ^
+    int tag = (threadHistory[tid].folded.index(bank - 1) << 2) ^ pc ^
               (pc >> instShiftAmt) ^
-              threadHistory[tid].computeIndices[bank].comp;
-    int hlen = (histLengths[bank] > pathHistBits) ? pathHistBits :
-                                                    histLengths[bank];
+              threadHistory[tid].folded.index(bank);
 
     tag = (tag >> 1) ^ ((tag & 1) << 10) ^
-           F(threadHistory[tid].pathHist, hlen, bank);
-    tag ^= threadHistory[tid].computeTags[0][bank].comp ^
-           (threadHistory[tid].computeTags[1][bank].comp << 1);
+           F(threadHistory[tid].pathHist, pathHistLengths[bank], bank);
+    tag ^= threadHistory[tid].folded.tag0(bank) ^
+           (threadHistory[tid].folded.tag1(bank) << 1);
 
-    return ((tag ^ (tag >> tagTableTagWidths[bank]))
-            & ((ULL(1) << tagTableTagWidths[bank]) - 1));
+    return ((tag ^ (tag >> tagTableTagWidths[bank])) & tagMasks[bank]);
 }
 
 void
@@ -59,6 +59,18 @@ class AtomicSimpleCPU(BaseSimpleCPU):
     width = Param.Int(1, "CPU width")
     simulate_data_stalls = Param.Bool(False, "Simulate dcache stall cycles")
     simulate_inst_stalls = Param.Bool(False, "Simulate icache stall cycles")
+    use_backdoors = Param.Bool(False, "Serve plain memory accesses "
+        "through backdoors to the memories when they are handed out, which "
+        "skips the memory system and its latency. Only correct if no other "
+        "requestor caches the data.")
+    superblock_length = Param.Unsigned(0, "Max number of instructions in "
+        "a superblock, 0 to disable superblocks. Superblocks cache decoded "
+        "straight-line code by physical address and replay it without "
+        "fetching, decoding or checking for interrupts and PC events "
+        "between its instructions. Meant for fast-forwarding: replayed "
+        "instructions don't access the icache.")
+    superblock_entries = Param.Unsigned(16384, "Max number of cached "
+        "superblocks")
 
     def addSimPointProbe(self, interval):
         simpoint = SimPoint()
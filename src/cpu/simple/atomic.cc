@@ -80,16 +80,31 @@ AtomicSimpleCPU::AtomicSimpleCPU(AtomicSimpleCPUParams *p)
       width(p->width), locked(false),
       simulate_data_stalls(p->simulate_data_stalls),
       simulate_inst_stalls(p->simulate_inst_stalls),
+      useBackdoors(p->use_backdoors),
+      superblockLength(p->superblock_length),
+      superblockEntries(p->superblock_entries),
+      superblockGeneration(0), pcEventGeneration(0),
+      recordingSuperblock(false), superblockRecordAddr(0),
+      superblockRecordDone(0), superblockRecordEnd(false),
       icachePort(name() + ".icache_port", this),
       dcachePort(name() + ".dcache_port", this),
       dcache_access(false), dcache_latency(0),
-      ppCommit(nullptr)
+      ppCommit(nullptr), ppFetchRequest(nullptr), ppDataRequest(nullptr)
 {
     _status = Idle;
     ifetch_req = std::make_shared<Request>();
     data_read_req = std::make_shared<Request>();
     data_write_req = std::make_shared<Request>();
     data_amo_req = std::make_shared<Request>();
+
+    fatal_if(superblockLength && numThreads > 1,
+             "%s: Superblocks are only supported with a single thread.\n",
+             name());
+    fatal_if(superblockLength && simulate_inst_stalls,
+             "%s: Superblocks skip instruction fetch and can't simulate "
+             "icache stalls.\n", name());
+    fatal_if(superblockLength && !superblockEntries,
+             "%s: The superblock cache needs at least one entry.\n", name());
 }
 
 
@@ -150,6 +165,11 @@ AtomicSimpleCPU::drainResume()
     DPRINTF(SimpleCPU, "Resume\n");
     verifyMemoryMode();
 
+    // Memory may have been changed behind our back, e.g., by restoring
+    // a checkpoint or by another CPU.
+    if (superblockLength)
+        flushSuperblocks();
+
     assert(!threadContexts.empty());
 
     _status = BaseSimpleCPU::Idle;
@@ -198,6 +218,14 @@ AtomicSimpleCPU::switchOut()
     assert(!tickEvent.scheduled());
     assert(_status == BaseSimpleCPU::Running || _status == Idle);
     assert(isCpuDrained());
+
+    // the memory system is about to be used by another CPU, possibly
+    // with different requirements
+    backdoors.clear();
+
+    recordingSuperblock = false;
+    superblocks.clear();
+    superblockPages.clear();
 }
 
 
@@ -271,10 +299,50 @@ AtomicSimpleCPU::suspendContext(ThreadID thread_num)
     BaseCPU::suspendContext(thread_num);
 }
 
+PortProxy::SendFunctionalFunc
+AtomicSimpleCPU::getSendFunctional()
+{
+    auto send_functional = BaseSimpleCPU::getSendFunctional();
+    if (!useBackdoors && !superblockLength)
+        return send_functional;
+
+    // Functional accesses of this CPU, e.g., syscall emulation writing
+    // to guest memory, are not snooped back, so check them for code here.
+    return [this, send_functional](PacketPtr pkt)->void {
+        if (pkt->isWrite())
+            writeSuperblockPages(pkt->getAddr(), pkt->getSize());
+        if (!useBackdoors || !accessBackdoor(pkt))
+            send_functional(pkt);
+    };
+}
+
 Tick
 AtomicSimpleCPU::sendPacket(RequestPort &port, const PacketPtr &pkt)
 {
-    return port.sendAtomic(pkt);
+    if (!useBackdoors)
+        return port.sendAtomic(pkt);
+
+    // the backdoor skips the memory system and its latency
+    if (accessBackdoor(pkt))
+        return 0;
+
+    MemBackdoorPtr backdoor = nullptr;
+    Tick latency = port.sendAtomicBackdoor(pkt, backdoor);
+    if (backdoor)
+        backdoors.insert(backdoor);
+
+    return latency;
+}
+
+bool
+AtomicSimpleCPU::accessBackdoor(PacketPtr pkt)
+{
+    // writes through a backdoor are not snooped, so only make them if
+    // there is no other CPU that could be monitoring the address
+    if (pkt->isWrite() && system->threads.size() != numThreads)
+        return false;
+
+    return backdoors.access(pkt);
 }
 
 Tick
@@ -302,6 +370,7 @@ AtomicSimpleCPU::AtomicCPUDPort::recvAtomicSnoop(PacketPtr pkt)
         for (auto &t_info : cpu->threadInfo) {
             TheISA::handleLockedSnoop(t_info->thread, pkt, cacheBlockMask);
         }
+        cpu->writeSuperblockPages(pkt->getAddr(), pkt->getSize());
     }
 
     return 0;
@@ -329,6 +398,10 @@ AtomicSimpleCPU::AtomicCPUDPort::recvFunctionalSnoop(PacketPtr pkt)
             TheISA::handleLockedSnoop(t_info->thread, pkt, cacheBlockMask);
         }
     }
+
+    // Functional writes, e.g., by syscall emulation, may overwrite code
+    if (pkt->isInvalidate() || pkt->isWrite())
+        cpu->writeSuperblockPages(pkt->getAddr(), pkt->getSize());
 }
 
 bool
@@ -411,6 +484,7 @@ AtomicSimpleCPU::readMem(Addr addr, uint8_t * data, unsigned size,
                 dcache_latency += sendPacket(dcachePort, &pkt);
             }
             dcache_access = true;
+            ppDataRequest->notify(req);
 
             assert(!pkt.isError());
 
@@ -507,6 +581,8 @@ AtomicSimpleCPU::writeMem(uint8_t *data, unsigned size, Addr addr,
             }
 
             if (do_access && !req->getFlags().isSet(Request::NO_ACCESS)) {
+                writeSuperblockPages(req->getPaddr(), req->getSize());
+
                 Packet pkt(req, Packet::makeWriteCmd(req));
                 pkt.dataStatic(data);
 
@@ -520,6 +596,7 @@ AtomicSimpleCPU::writeMem(uint8_t *data, unsigned size, Addr addr,
                     threadSnoop(&pkt, curThread);
                 }
                 dcache_access = true;
+                ppDataRequest->notify(req);
                 assert(!pkt.isError());
 
                 if (req->isSwap()) {
@@ -601,6 +678,8 @@ AtomicSimpleCPU::amoMem(Addr addr, uint8_t* data, unsigned size,
 
     // Now do the access.
     if (fault == NoFault && !req->getFlags().isSet(Request::NO_ACCESS)) {
+        writeSuperblockPages(req->getPaddr(), req->getSize());
+
         // We treat AMO accesses as Write accesses with SwapReq command
         // data will hold the return data of the AMO access
         Packet pkt(req, Packet::makeWriteCmd(req));
@@ -613,6 +692,7 @@ AtomicSimpleCPU::amoMem(Addr addr, uint8_t* data, unsigned size,
         }
 
         dcache_access = true;
+        ppDataRequest->notify(req);
 
         assert(!pkt.isError());
         assert(!req->isLLSC());
@@ -626,6 +706,258 @@ AtomicSimpleCPU::amoMem(Addr addr, uint8_t* data, unsigned size,
     return fault;
 }
 
+static bool
+endsSuperblock(const StaticInstPtr &inst)
+{
+    // Besides control transfers, stop at instructions that may change
+    // how the following instructions decode or when they may run.
+    return inst->isControl() || inst->isSerializing() ||
+        inst->isNonSpeculative() || inst->isSquashAfter() ||
+        inst->isQuiesce() || inst->isSyscall() || inst->isIprAccess() ||
+        inst->isHtmStart() || inst->isHtmStop() || inst->isHtmCancel();
+}
+
+const AtomicSimpleCPU::Superblock *
+AtomicSimpleCPU::lookupSuperblock(Addr paddr, const TheISA::PCState &pc)
+{
+    SimpleThread* thread = threadInfo[curThread]->thread;
+
+    // PC events are only checked at the head of a superblock, so blocks
+    // that were recorded before an event was scheduled may cover it.
+    if (thread->pcEventQueue.generation() != pcEventGeneration) {
+        pcEventGeneration = thread->pcEventQueue.generation();
+        flushSuperblocks();
+    }
+
+    auto it = superblocks.find(paddr);
+    bool cached = it != superblocks.end() &&
+        it->second.generation == superblockGeneration;
+
+    if (recordingSuperblock) {
+        auto events = thread->pcEventQueue.equal_range(pc.instAddr());
+        if (!cached && events.first == events.second &&
+            superblockRecord.numInsts < superblockLength &&
+            roundDown(paddr, PageBytes) ==
+            roundDown(superblockRecordAddr, PageBytes)) {
+            return nullptr;
+        }
+
+        finishSuperblock();
+        it = superblocks.find(paddr);
+        cached = it != superblocks.end() &&
+            it->second.generation == superblockGeneration;
+    }
+
+    if (cached)
+        return &it->second;
+
+    recordingSuperblock = true;
+    superblockRecord.steps.clear();
+    superblockRecord.numInsts = 0;
+    superblockRecord.generation = superblockGeneration;
+    superblockRecordAddr = paddr;
+    superblockRecordDone = 0;
+    superblockRecordEnd = false;
+
+    return nullptr;
+}
+
+void
+AtomicSimpleCPU::recordSuperblockStep(const TheISA::PCState &pc)
+{
+    // Instructions that need several fetches and microcode from the ROM
+    // are left to the regular path.
+    if (!curStaticInst || isRomMicroPC(pc.microPC())) {
+        finishSuperblock();
+        return;
+    }
+
+    SuperblockStep step;
+    step.pc = pc;
+    step.decodedPC = threadInfo[curThread]->thread->pcState();
+    step.inst = curStaticInst;
+    step.macroInst = curMacroStaticInst;
+    superblockRecord.steps.push_back(step);
+}
+
+void
+AtomicSimpleCPU::endSuperblockStep(const Fault &fault)
+{
+    if (fault != NoFault || _status == Idle) {
+        finishSuperblock();
+        return;
+    }
+
+    if (endsSuperblock(curStaticInst))
+        superblockRecordEnd = true;
+
+    superblockRecordPC = threadInfo[curThread]->thread->pcState();
+
+    // Wait for the rest of the macro-op
+    if (curMacroStaticInst)
+        return;
+
+    ++superblockRecord.numInsts;
+    superblockRecordDone = superblockRecord.steps.size();
+
+    if (superblockRecordEnd)
+        finishSuperblock();
+}
+
+void
+AtomicSimpleCPU::finishSuperblock()
+{
+    recordingSuperblock = false;
+
+    // Drop the micro-ops of an incomplete macro-op
+    superblockRecord.steps.resize(superblockRecordDone);
+
+    // There is nothing to gain from caching a single instruction, and
+    // the block is stale if its code was written while recording it.
+    if (superblockRecord.numInsts < 2 ||
+        superblockRecord.generation != superblockGeneration) {
+        return;
+    }
+
+    if (superblocks.size() >= superblockEntries) {
+        superblocks.clear();
+        superblockPages.clear();
+    }
+
+    DPRINTF(SimpleCPU, "Caching superblock at %#x with %d instructions\n",
+            superblockRecordAddr, superblockRecord.numInsts);
+
+    superblockPages.insert(roundDown(superblockRecordAddr, PageBytes));
+    superblocks[superblockRecordAddr] = std::move(superblockRecord);
+}
+
+void
+AtomicSimpleCPU::flushSuperblocks()
+{
+    // Blocks (and recordings) of older generations are ignored, so
+    // there is no need to walk the cache.
+    ++superblockGeneration;
+    superblockPages.clear();
+    ++superblockFlushes;
+}
+
+void
+AtomicSimpleCPU::checkSuperblockPages(Addr addr, Addr size)
+{
+    if (!size)
+        return;
+
+    Addr record_page = roundDown(superblockRecordAddr, PageBytes);
+    Addr last_page = roundDown(addr + size - 1, PageBytes);
+    for (Addr page = roundDown(addr, PageBytes); page <= last_page;
+         page += PageBytes) {
+        if (superblockPages.count(page) ||
+            (recordingSuperblock && page == record_page)) {
+            DPRINTF(SimpleCPU, "Write to code page %#x, flushing "
+                    "superblocks\n", page);
+            flushSuperblocks();
+            return;
+        }
+    }
+}
+
+int
+AtomicSimpleCPU::replaySuperblock(const Superblock &block, Tick &latency)
+{
+    SimpleExecContext& t_info = *threadInfo[curThread];
+    SimpleThread* thread = t_info.thread;
+
+    // Instruction count events are only serviced between superblocks, so
+    // don't enter a block that would run past one.
+    if (!thread->comInstEventQueue.empty() &&
+        thread->comInstEventQueue.nextTick() <=
+        t_info.numInst + block.numInsts) {
+        return 0;
+    }
+
+    int replayed = 0;
+    for (size_t i = 1; i < block.steps.size(); ++i) {
+        const SuperblockStep &step = block.steps[i];
+
+        // Leave the block if it was overwritten or if execution left the
+        // recorded path, e.g., because of a micro-branch.
+        if (block.generation != superblockGeneration ||
+            thread->pcState() != step.pc) {
+            break;
+        }
+
+        numCycles++;
+
+        // Same as preExecute(), without fetching and decoding
+        thread->setIntReg(ZeroReg, 0);
+        t_info.setPredicate(true);
+        t_info.setMemAccPredicate(true);
+        t_info.stayAtPC = false;
+        thread->pcState(step.decodedPC);
+        curStaticInst = step.inst;
+        curMacroStaticInst = step.macroInst;
+        setupDecodedInst();
+
+        dcache_access = false;
+        Tick stall_ticks = 0;
+        Fault fault = executeInst(t_info, stall_ticks);
+
+        if (simulate_data_stalls && dcache_access)
+            stall_ticks += dcache_latency;
+
+        if (stall_ticks)
+            latency += divCeil(stall_ticks, clockPeriod()) * clockPeriod();
+
+        advancePC(fault);
+        ++replayed;
+
+        if (fault != NoFault || _status == Idle)
+            break;
+    }
+
+    if (replayed) {
+        ++superblockHits;
+        superblockInsts += replayed;
+    }
+
+    return replayed;
+}
+
+Fault
+AtomicSimpleCPU::executeInst(SimpleExecContext &t_info, Tick &stall_ticks)
+{
+    Fault fault = NoFault;
+
+    if (curStaticInst) {
+        fault = curStaticInst->execute(&t_info, traceData);
+
+        // keep an instruction count
+        if (fault == NoFault) {
+            countInst();
+            ppCommit->notify(std::make_pair(t_info.thread, curStaticInst));
+        } else if (traceData) {
+            traceFault();
+        }
+
+        if (fault != NoFault &&
+            dynamic_pointer_cast<SyscallRetryFault>(fault)) {
+            // Retry execution of system calls after a delay.
+            // Prevents immediate re-execution since conditions which
+            // caused the retry are unlikely to change every tick.
+            stall_ticks += clockEdge(syscallRetryLatency) - curTick();
+        }
+
+        postExecute();
+    }
+
+    // @todo remove me after debugging with legion done
+    if (curStaticInst && (!curStaticInst->isMicroop() ||
+                curStaticInst->isFirstMicroop()))
+        instCnt++;
+
+    return fault;
+}
+
 void
 AtomicSimpleCPU::tick()
 {
@@ -648,8 +980,10 @@ AtomicSimpleCPU::tick()
     SimpleThread* thread = t_info.thread;
 
     Tick latency = 0;
+    int replayed = 0;
 
-    for (int i = 0; i < width || locked; ++i) {
+    int i = 0;
+    for (; i < width || locked; ++i) {
         numCycles++;
         updateCycleCounters(BaseCPU::CPU_STATE_ON);
 
@@ -664,6 +998,10 @@ AtomicSimpleCPU::tick()
             return;
         }
 
+        // An interrupt or a PC event moved us off the recorded path
+        if (recordingSuperblock && thread->pcState() != superblockRecordPC)
+            finishSuperblock();
+
         Fault fault = NoFault;
 
         TheISA::PCState pcState = thread->pcState();
@@ -677,6 +1015,12 @@ AtomicSimpleCPU::tick()
                                                  BaseTLB::Execute);
         }
 
+        const Superblock *block = nullptr;
+        if (superblockLength && needToFetch && fault == NoFault &&
+            t_info.fetchOffset == 0 && !ppFetchRequest->hasListeners()) {
+            block = lookupSuperblock(ifetch_req->getPaddr(), pcState);
+        }
+
         if (fault == NoFault) {
             Tick icache_latency = 0;
             bool icache_access = false;
@@ -695,6 +1039,7 @@ AtomicSimpleCPU::tick()
                     ifetch_pkt.dataStatic(&inst);
 
                     icache_latency = sendPacket(icachePort, &ifetch_pkt);
+                    ppFetchRequest->notify(ifetch_req);
 
                     assert(!ifetch_pkt.isError());
 
@@ -705,33 +1050,20 @@ AtomicSimpleCPU::tick()
 
             preExecute();
 
-            Tick stall_ticks = 0;
-            if (curStaticInst) {
-                fault = curStaticInst->execute(&t_info, traceData);
-
-                // keep an instruction count
-                if (fault == NoFault) {
-                    countInst();
-                    ppCommit->notify(std::make_pair(thread, curStaticInst));
-                } else if (traceData) {
-                    traceFault();
-                }
-
-                if (fault != NoFault &&
-                    dynamic_pointer_cast<SyscallRetryFault>(fault)) {
-                    // Retry execution of system calls after a delay.
-                    // Prevents immediate re-execution since conditions which
-                    // caused the retry are unlikely to change every tick.
-                    stall_ticks += clockEdge(syscallRetryLatency) - curTick();
-                }
+            if (recordingSuperblock)
+                recordSuperblockStep(pcState);
 
-                postExecute();
+            // The head of a cached superblock is fetched and decoded as
+            // usual, which catches code and decoder mode changes.
+            if (block && (block->steps[0].pc != pcState ||
+                          block->steps[0].inst != curStaticInst ||
+                          block->steps[0].decodedPC != thread->pcState())) {
+                superblocks.erase(ifetch_req->getPaddr());
+                block = nullptr;
             }
 
-            // @todo remove me after debugging with legion done
-            if (curStaticInst && (!curStaticInst->isMicroop() ||
-                        curStaticInst->isFirstMicroop()))
-                instCnt++;
+            Tick stall_ticks = 0;
+            fault = executeInst(t_info, stall_ticks);
 
             if (simulate_inst_stalls && icache_access)
                 stall_ticks += icache_latency;
@@ -750,14 +1082,27 @@ AtomicSimpleCPU::tick()
         }
         if (fault != NoFault || !t_info.stayAtPC)
             advancePC(fault);
+
+        if (recordingSuperblock) {
+            endSuperblockStep(fault);
+        } else if (block && fault == NoFault && _status != Idle) {
+            int count = replaySuperblock(*block, latency);
+            replayed += count;
+            i += count;
+        }
     }
 
     if (tryCompleteDrain())
         return;
 
-    // instruction takes at least one cycle
-    if (latency < clockPeriod())
-        latency = clockPeriod();
+    // instruction takes at least one cycle, replayed superblocks took
+    // their slots of the width above and run at one width per cycle
+    Tick min_latency = clockPeriod();
+    if (replayed)
+        min_latency *= divCeil(i, width);
+
+    if (latency < min_latency)
+        latency = min_latency;
 
     if (_status != Idle)
         reschedule(tickEvent, curTick() + latency, true);
@@ -770,6 +1115,31 @@ AtomicSimpleCPU::regProbePoints()
 
     ppCommit = new ProbePointArg<pair<SimpleThread*, const StaticInstPtr>>
                                 (getProbeManager(), "Commit");
+    ppFetchRequest = new ProbePointArg<RequestPtr>(getProbeManager(),
+                                                   "FetchRequest");
+    ppDataRequest = new ProbePointArg<RequestPtr>(getProbeManager(),
+                                                  "DataRequest");
+}
+
+void
+AtomicSimpleCPU::regStats()
+{
+    BaseSimpleCPU::regStats();
+
+    superblockHits
+        .name(name() + ".superblockHits")
+        .desc("Number of superblocks replayed")
+        ;
+
+    superblockInsts
+        .name(name() + ".superblockInsts")
+        .desc("Number of micro-ops replayed from superblocks")
+        ;
+
+    superblockFlushes
+        .name(name() + ".superblockFlushes")
+        .desc("Number of times the superblock cache was invalidated")
+        ;
 }
 
 void
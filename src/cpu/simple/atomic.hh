@@ -41,8 +41,13 @@
 #ifndef __CPU_SIMPLE_ATOMIC_HH__
 #define __CPU_SIMPLE_ATOMIC_HH__
 
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 #include "cpu/simple/base.hh"
 #include "cpu/simple/exec_context.hh"
+#include "mem/backdoor_cache.hh"
 #include "mem/request.hh"
 #include "params/AtomicSimpleCPU.hh"
 #include "sim/probe/probe.hh"
@@ -65,9 +70,155 @@ class AtomicSimpleCPU : public BaseSimpleCPU
     const bool simulate_data_stalls;
     const bool simulate_inst_stalls;
 
+    /** Serve plain memory accesses through backdoors when possible */
+    const bool useBackdoors;
+
+    /** Backdoors handed out by the memories */
+    MemBackdoorCache backdoors;
+
+    /** An instruction or micro-op of a superblock */
+    struct SuperblockStep
+    {
+        /** PC state before the instruction is decoded */
+        TheISA::PCState pc;
+        /** PC state after decoding, which the instruction executes with */
+        TheISA::PCState decodedPC;
+        StaticInstPtr inst;
+        StaticInstPtr macroInst;
+    };
+
+    /**
+     * A straight-line sequence of decoded instructions. It starts at the
+     * physical address of its first instruction and ends at a control
+     * transfer, an instruction that may change how later instructions
+     * decode, a PC event or the end of the page.
+     */
+    struct Superblock
+    {
+        std::vector<SuperblockStep> steps;
+        /** Number of instructions (not micro-ops) in the block */
+        Counter numInsts;
+        /** Cache generation the block was recorded in */
+        uint64_t generation;
+    };
+
+    /** Max instructions per superblock, 0 if superblocks are disabled */
+    const unsigned superblockLength;
+
+    /** Max number of superblocks to cache before starting over */
+    const unsigned superblockEntries;
+
+    /** Cached superblocks indexed by the physical address of their head */
+    std::unordered_map<Addr, Superblock> superblocks;
+
+    /** Physical pages the cached superblocks were decoded from */
+    std::unordered_set<Addr> superblockPages;
+
+    /** Superblocks recorded in an older generation are stale */
+    uint64_t superblockGeneration;
+
+    /** PC event queue generation the cached superblocks account for */
+    uint64_t pcEventGeneration;
+
+    /** Are we recording the superblock in superblockRecord? */
+    bool recordingSuperblock;
+
+    /** The superblock being recorded */
+    Superblock superblockRecord;
+
+    /** Physical address of the head of the recorded superblock */
+    Addr superblockRecordAddr;
+
+    /** Number of recorded steps that belong to complete instructions */
+    size_t superblockRecordDone;
+
+    /** End the recording once the current instruction completes */
+    bool superblockRecordEnd;
+
+    /** PC state the next recorded step must start from */
+    TheISA::PCState superblockRecordPC;
+
+    Stats::Scalar superblockHits;
+    Stats::Scalar superblockInsts;
+    Stats::Scalar superblockFlushes;
+
     // main simulation loop (one cycle)
     void tick();
 
+    /**
+     * Execute the instruction in curStaticInst and do the per-instruction
+     * bookkeeping.
+     *
+     * @param t_info Context of the current thread
+     * @param[out] stall_ticks Incremented by any stall the instruction
+     *                         causes
+     * @return The fault raised by the instruction
+     */
+    Fault executeInst(SimpleExecContext &t_info, Tick &stall_ticks);
+
+    /**
+     * Replay the rest of a superblock whose first instruction has just
+     * been fetched and executed. Stops early if execution leaves the
+     * recorded path or an instruction faults.
+     *
+     * @param block Superblock to replay
+     * @param[out] latency Incremented by the stall cycles of the block
+     * @return Number of micro-ops replayed
+     */
+    int replaySuperblock(const Superblock &block, Tick &latency);
+
+    /**
+     * Find the superblock that starts at a fetch address. Starts
+     * recording a new superblock if there is none and no recording is
+     * in progress.
+     *
+     * @param paddr Physical fetch address
+     * @param pc PC state of the instruction being fetched
+     * @return The cached superblock, nullptr if there is none
+     */
+    const Superblock *lookupSuperblock(Addr paddr,
+                                       const TheISA::PCState &pc);
+
+    /**
+     * Record the instruction in curStaticInst in the current superblock.
+     *
+     * @param pc PC state the instruction was decoded from
+     */
+    void recordSuperblockStep(const TheISA::PCState &pc);
+
+    /**
+     * Finish recording an executed instruction, ending the superblock
+     * where needed.
+     *
+     * @param fault The fault raised by the instruction
+     */
+    void endSuperblockStep(const Fault &fault);
+
+    /**
+     * Stop recording and cache the complete instructions of the recorded
+     * superblock.
+     */
+    void finishSuperblock();
+
+    /** Invalidate all cached superblocks */
+    void flushSuperblocks();
+
+    /**
+     * Invalidate the cached superblocks if a write hits a page they were
+     * decoded from.
+     *
+     * @param addr Physical address of the write
+     * @param size Size of the write
+     */
+    void
+    writeSuperblockPages(Addr addr, Addr size)
+    {
+        if (!superblockPages.empty() || recordingSuperblock)
+            checkSuperblockPages(addr, size);
+    }
+
+    void checkSuperblockPages(Addr addr, Addr size);
+
     /**
      * Check if a system is in a drained state.
      *
@@ -103,6 +254,14 @@ class AtomicSimpleCPU : public BaseSimpleCPU
 
     virtual Tick sendPacket(RequestPort &port, const PacketPtr &pkt);
 
+    /**
+     * Serve a packet through a cached backdoor if there is one.
+     *
+     * @param pkt Packet to serve
+     * @return true if the packet has been served
+     */
+    bool accessBackdoor(PacketPtr pkt);
+
     /**
      * An AtomicCPUPort overrides the default behaviour of the
      * recvAtomicSnoop and ignores the packet instead of panicking. It
@@ -169,6 +328,14 @@ class AtomicSimpleCPU : public BaseSimpleCPU
     /** Probe Points. */
     ProbePointArg<std::pair<SimpleThread*, const StaticInstPtr>> *ppCommit;
 
+    /**
+     * Notified with the request of every instruction fetch and of every
+     * fragment of a data access that reached the memory system.
+     * Superblocks are not replayed while fetches are being listened to.
+     */
+    ProbePointArg<RequestPtr> *ppFetchRequest;
+    ProbePointArg<RequestPtr> *ppDataRequest;
+
   protected:
 
     /** Return a reference to the data port. */
@@ -190,6 +357,8 @@ class AtomicSimpleCPU : public BaseSimpleCPU
 
     void verifyMemoryMode() const override;
 
+    PortProxy::SendFunctionalFunc getSendFunctional() override;
+
     void activateContext(ThreadID thread_num) override;
     void suspendContext(ThreadID thread_num) override;
 
@@ -241,6 +410,8 @@ class AtomicSimpleCPU : public BaseSimpleCPU
 
     void regProbePoints() override;
 
+    void regStats() override;
+
     /**
      * Print state of address in memory system via PrintReq (for
      * debugging).
@@ -390,6 +390,62 @@ BaseSimpleCPU::regStats()
             .name(thread_str + ".BranchMispred")
             .desc("Number of branch mispredictions")
             .prereq(t_info.numBranchMispred);
+
+        const DecodeCache::Counts &counts =
+            t_info.thread->decoder.decodeCounts;
+
+        t_info.decodePageL0Hits
+            .functor([&counts]() { return counts.pageL0Hits; })
+            .name(thread_str + ".decodePageL0Hits")
+            .desc("Decode cache pages found in the L0 of recent pages")
+            ;
+
+        t_info.decodePageTableHits
+            .functor([&counts]() { return counts.pageTableHits; })
+            .name(thread_str + ".decodePageTableHits")
+            .desc("Decode cache pages found in the page table")
+            ;
+
+        t_info.decodePageMisses
+            .functor([&counts]() { return counts.pageMisses; })
+            .name(thread_str + ".decodePageMisses")
+            .desc("Decode cache pages missing from the page table")
+            ;
+
+        t_info.decodeAddrHits
+            .functor([&counts]() { return counts.addrHits; })
+            .name(thread_str + ".decodeAddrHits")
+            .desc("Decoded instructions found at their address")
+            ;
+
+        t_info.decodeInstHits
+            .functor([&counts]() { return counts.instHits; })
+            .name(thread_str + ".decodeInstHits")
+            .desc("Decoded instructions found by their machine code")
+            ;
+
+        t_info.decodeInstMisses
+            .functor([&counts]() { return counts.instMisses; })
+            .name(thread_str + ".decodeInstMisses")
+            .desc("Instructions that had to be decoded")
+            ;
+
+        t_info.decodePageL0HitRate
+            .name(thread_str + ".decodePageL0HitRate")
+            .desc("Fraction of decode cache pages found in the L0")
+            ;
+        t_info.decodePageL0HitRate = t_info.decodePageL0Hits /
+            (t_info.decodePageL0Hits + t_info.decodePageTableHits +
+             t_info.decodePageMisses);
+
+        t_info.decodeHitRate
+            .name(thread_str + ".decodeHitRate")
+            .desc("Fraction of instructions found in the decode cache")
+            ;
+        t_info.decodeHitRate =
+            (t_info.decodeAddrHits + t_info.decodeInstHits) /
+            (t_info.decodeAddrHits + t_info.decodeInstHits +
+             t_info.decodeInstMisses);
     }
 }
 
@@ -399,6 +455,7 @@ BaseSimpleCPU::resetStats()
     BaseCPU::resetStats();
     for (auto &thread_info : threadInfo) {
         thread_info->notIdleFraction = (_status != Idle);
+        thread_info->thread->decoder.decodeCounts = DecodeCache::Counts();
     }
 }
 
@@ -553,6 +610,15 @@ BaseSimpleCPU::preExecute()
         curStaticInst = curMacroStaticInst->fetchMicroop(pcState.microPC());
     }
 
+    setupDecodedInst();
+}
+
+void
+BaseSimpleCPU::setupDecodedInst()
+{
+    SimpleExecContext &t_info = *threadInfo[curThread];
+    SimpleThread* thread = t_info.thread;
+
     //If we decoded an instruction this "tick", record information about it.
     if (curStaticInst) {
 #if TRACING_ON
@@ -653,6 +719,7 @@ BaseSimpleCPU::postExecute()
 
     // Call CPU instruction commit probes
     probeInstCommit(curStaticInst, instAddr);
+    probeBranchCommit(curStaticInst, pc);
 }
 
 void
@@ -132,6 +132,13 @@ class BaseSimpleCPU : public BaseCPU
     void checkForInterrupts();
     void setupFetchRequest(const RequestPtr &req);
     void preExecute();
+
+    /**
+     * Set up tracing and branch prediction for the instruction in
+     * curStaticInst. This is the part of preExecute() that follows
+     * decoding and is also used by CPUs that reuse decoded instructions.
+     */
+    void setupDecodedInst();
     void postExecute();
     void advancePC(const Fault &fault);
 
@@ -162,6 +162,18 @@ class SimpleExecContext : public ExecContext {
    // Instruction mix histogram by OpClass
    Stats::Vector statExecutedInstType;
 
+    /// @{
+    /// Decode cache lookups, as counted by the decoder
+    Stats::Value decodePageL0Hits;
+    Stats::Value decodePageTableHits;
+    Stats::Value decodePageMisses;
+    Stats::Value decodeAddrHits;
+    Stats::Value decodeInstHits;
+    Stats::Value decodeInstMisses;
+    Stats::Formula decodePageL0HitRate;
+    Stats::Formula decodeHitRate;
+    /// @}
+
   public:
     /** Constructor */
     SimpleExecContext(BaseSimpleCPU* _cpu, SimpleThread* _thread)
@@ -0,0 +1,54 @@
+# Copyright (c) 2020 The Regents of the University of California
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+from m5.params import *
+from m5.objects.Probe import ProbeListenerObject
+
+class AtomicElasticTrace(ProbeListenerObject):
+    """Elastic trace generator for the AtomicSimpleCPU. Dependencies and
+    compute delays are derived from the committed instruction stream, so
+    the traces can be replayed by the TraceCPU like those of the O3
+    ElasticTrace."""
+
+    type = 'AtomicElasticTrace'
+    cxx_header = 'cpu/simple/probes/elastic_trace.hh'
+
+    # Trace files are created in the output directory.
+    instFetchTraceFile = Param.String(desc="Protobuf trace file name for "
+                                      "instruction fetch tracing")
+    dataDepTraceFile = Param.String(desc="Protobuf trace file name for "
+                                    "data dependency tracing")
+    depWindowSize = Param.Unsigned(576, "Maximum distance of a dependency "
+                                   "in instructions, typically 3x the ROB "
+                                   "size of the O3CPU being modelled")
+    startTraceInst = Param.UInt64(0, "The number of committed instructions "
+                                  "after which to start tracing")
+    traceVirtAddr = Param.Bool(False, "Set to true if virtual addresses are "
+                               "to be traced")
+    sampleInsts = Param.UInt64(0, "Number of instructions traced in every "
+                               "sample, 0 traces all instructions")
+    sampleInterval = Param.UInt64(0, "Number of instructions between the "
+                                  "starts of two samples")
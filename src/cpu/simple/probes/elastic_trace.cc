@@ -0,0 +1,427 @@
+/*
+ * Copyright (c) 2020 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cpu/simple/probes/elastic_trace.hh"
+
+#include <algorithm>
+
+#include "base/callback.hh"
+#include "base/output.hh"
+#include "base/trace.hh"
+#include "cpu/op_class.hh"
+#include "cpu/simple/atomic.hh"
+#include "debug/AtomicElasticTrace.hh"
+#include "mem/packet.hh"
+#include "proto/packet.pb.h"
+
+AtomicElasticTrace::AtomicElasticTrace(
+        const AtomicElasticTraceParams *params)
+    : ProbeListenerObject(params),
+      regListenersEvent([this]{ regListeners(); }, name()),
+      depWindowSize(params->depWindowSize),
+      startTraceInst(params->startTraceInst),
+      sampleInsts(params->sampleInsts),
+      sampleInterval(params->sampleInterval),
+      traceVirtAddr(params->traceVirtAddr),
+      instTraceStream(nullptr), dataTraceStream(nullptr),
+      numCommitted(0), nextSeqNum(1), lastLoad(0), lastStore(0),
+      numFiltered(0), dataAccess{false, 0, 0, 0, 0, 0},
+      stats(this)
+{
+    cpu = dynamic_cast<AtomicSimpleCPU *>(params->manager);
+    fatal_if(!cpu, "Manager of %s is not of type AtomicSimpleCPU and thus "
+             "does not support dependency tracing.\n", name());
+
+    fatal_if(depWindowSize == 0, "depWindowSize parameter must be "
+             "non-zero.\n");
+
+    fatal_if(cpu->numThreads > 1, "numThreads = %i, %s supports tracing for "
+             "single-threaded workload only", cpu->numThreads, name());
+
+    fatal_if(sampleInsts && sampleInterval < sampleInsts,
+             "%s: sampleInterval must not be smaller than sampleInsts.\n",
+             name());
+
+    fatal_if(params->instFetchTraceFile == "", "Assign instruction fetch "
+             "trace file path to instFetchTraceFile");
+    fatal_if(params->dataDepTraceFile == "", "Assign data dependency "
+             "trace file path to dataDepTraceFile");
+    std::string filename = simout.resolve(name() + "." +
+                                          params->instFetchTraceFile);
+    instTraceStream = new ProtoOutputStream(filename);
+    filename = simout.resolve(name() + "." + params->dataDepTraceFile);
+    dataTraceStream = new ProtoOutputStream(filename);
+
+    ProtoMessage::PacketHeader inst_pkt_header;
+    inst_pkt_header.set_obj_id(name());
+    inst_pkt_header.set_tick_freq(SimClock::Frequency);
+    instTraceStream->write(inst_pkt_header);
+
+    ProtoMessage::InstDepRecordHeader data_rec_header;
+    data_rec_header.set_obj_id(name());
+    data_rec_header.set_tick_freq(SimClock::Frequency);
+    data_rec_header.set_window_size(depWindowSize);
+    dataTraceStream->write(data_rec_header);
+
+    registerExitCallback([this]() { flushTraces(); });
+}
+
+void
+AtomicElasticTrace::regProbeListeners()
+{
+    if (startTraceInst == 0) {
+        regListeners();
+    } else {
+        cpu->getContext(0)->scheduleInstCountEvent(
+                &regListenersEvent, startTraceInst);
+    }
+}
+
+void
+AtomicElasticTrace::regListeners()
+{
+    inform("@%llu: No. of instructions committed = %llu, registering "
+           "elastic probe listeners", curTick(), cpu->numSimulatedInsts());
+
+    typedef ProbeListenerArg<AtomicElasticTrace, RequestPtr> ReqListener;
+    typedef ProbeListenerArg<AtomicElasticTrace, CommitInfo> CommitListener;
+
+    listeners.push_back(new ReqListener(this, "FetchRequest",
+                                        &AtomicElasticTrace::fetchRequest));
+    listeners.push_back(new ReqListener(this, "DataRequest",
+                                        &AtomicElasticTrace::dataRequest));
+    listeners.push_back(new CommitListener(this, "Commit",
+                                           &AtomicElasticTrace::commit));
+}
+
+bool
+AtomicElasticTrace::inSample() const
+{
+    return sampleInsts == 0 || numCommitted % sampleInterval < sampleInsts;
+}
+
+void
+AtomicElasticTrace::fetchRequest(const RequestPtr &req)
+{
+    if (!inSample())
+        return;
+
+    DPRINTFR(AtomicElasticTrace, "Fetch Req %i,(%lli,%lli,%lli),%i,%i,"
+             "%lli\n", (MemCmd::ReadReq),
+             req->getPC(), req->getVaddr(), req->getPaddr(),
+             req->getFlags(), req->getSize(), curTick());
+
+    ProtoMessage::Packet inst_fetch_pkt;
+    inst_fetch_pkt.set_tick(curTick());
+    inst_fetch_pkt.set_cmd(MemCmd::ReadReq);
+    inst_fetch_pkt.set_pc(req->getPC());
+    inst_fetch_pkt.set_flags(req->getFlags());
+    inst_fetch_pkt.set_addr(req->getPaddr());
+    inst_fetch_pkt.set_size(req->getSize());
+    instTraceStream->write(inst_fetch_pkt);
+}
+
+void
+AtomicElasticTrace::dataRequest(const RequestPtr &req)
+{
+    // Only the first fragment of a split access is recorded. A stale
+    // request of an instruction that faulted is replaced by the next one.
+    if (dataAccess.valid && dataAccess.pc == req->getPC())
+        return;
+
+    dataAccess.valid = true;
+    dataAccess.pc = req->getPC();
+    dataAccess.physAddr = req->getPaddr();
+    dataAccess.virtAddr = req->getVaddr();
+    dataAccess.size = req->getSize();
+    dataAccess.flags = req->getFlags();
+}
+
+AtomicElasticTrace::TraceInfo *
+AtomicElasticTrace::findRecord(uint64_t seq_num)
+{
+    if (window.empty() || seq_num < window.front().seqNum)
+        return nullptr;
+
+    // Sequence numbers within a sample are contiguous.
+    size_t idx = seq_num - window.front().seqNum;
+    return idx < window.size() ? &window[idx] : nullptr;
+}
+
+void
+AtomicElasticTrace::addDep(std::vector<uint64_t> &deps, uint64_t seq_num)
+{
+    TraceInfo *dep = findRecord(seq_num);
+    if (!dep)
+        return;
+
+    for (auto d : deps) {
+        if (d == seq_num)
+            return;
+    }
+    deps.push_back(seq_num);
+    ++dep->numDepts;
+}
+
+Cycles
+AtomicElasticTrace::opLatency(const StaticInstPtr &inst)
+{
+    // Latencies of the default O3 functional units.
+    switch (inst->opClass()) {
+      case IntMultOp:
+        return Cycles(3);
+      case IntDivOp:
+        return Cycles(20);
+      case FloatAddOp:
+      case FloatCmpOp:
+      case FloatCvtOp:
+        return Cycles(2);
+      case FloatMultOp:
+        return Cycles(4);
+      case FloatMultAccOp:
+        return Cycles(5);
+      case FloatMiscOp:
+        return Cycles(3);
+      case FloatDivOp:
+        return Cycles(12);
+      case FloatSqrtOp:
+        return Cycles(24);
+      default:
+        return Cycles(1);
+    }
+}
+
+void
+AtomicElasticTrace::commit(const CommitInfo &inst)
+{
+    const DataAccess access = dataAccess;
+    dataAccess.valid = false;
+
+    bool sampled = inSample();
+    ++numCommitted;
+    if (!sampled)
+        return;
+
+    if (!inst.second->isNop())
+        addRecord(inst.first, inst.second, access);
+
+    if (!inSample())
+        endSample();
+}
+
+void
+AtomicElasticTrace::addRecord(SimpleThread *thread, const StaticInstPtr &si,
+                              const DataAccess &access)
+{
+    TraceInfo rec;
+    rec.seqNum = nextSeqNum++;
+    rec.pc = thread->instAddr();
+    rec.physAddr = 0;
+    rec.virtAddr = 0;
+    rec.size = 0;
+    rec.flags = 0;
+    rec.compDelay = cpu->cyclesToTicks(opLatency(si));
+    rec.numDepts = 0;
+
+    // An access that did not reach memory, e.g., a predicated-false or
+    // faulting one, is traced as a compute instruction.
+    if (access.valid && access.pc == rec.pc &&
+        (si->isLoad() || si->isStore() || si->isAtomic())) {
+        rec.type = si->isLoad() ? Record::LOAD : Record::STORE;
+        rec.physAddr = access.physAddr;
+        rec.virtAddr = access.virtAddr;
+        rec.size = access.size;
+        rec.flags = access.flags;
+    } else {
+        rec.type = Record::COMP;
+    }
+
+    for (int i = 0; i < si->numSrcRegs(); i++) {
+        const RegId reg = thread->flattenRegId(si->srcRegIdx(i));
+        if (reg.isMiscReg() || reg.isZeroReg())
+            continue;
+        auto it = lastWriter.find(reg);
+        if (it != lastWriter.end()) {
+            size_t num_deps = rec.regDeps.size();
+            addDep(rec.regDeps, it->second);
+            if (rec.regDeps.size() != num_deps)
+                ++stats.numRegDep;
+        }
+    }
+
+    if (rec.type == Record::LOAD && rec.size) {
+        // Read after write through memory.
+        forEachWord(rec.physAddr, rec.size, [&](Addr word) {
+            auto it = lastStoreTo.find(word);
+            if (it != lastStoreTo.end()) {
+                size_t num_deps = rec.robDeps.size();
+                addDep(rec.robDeps, it->second);
+                if (rec.robDeps.size() != num_deps)
+                    ++stats.numMemDep;
+            }
+        });
+    }
+
+    if (rec.type == Record::STORE) {
+        // Stores are performed in program order after older loads.
+        if (lastStore)
+            addDep(rec.robDeps, lastStore);
+        if (lastLoad)
+            addDep(rec.robDeps, lastLoad);
+        stats.numOrderDepStores += rec.robDeps.size();
+    }
+
+    if (rec.robDeps.empty() && rec.regDeps.empty()) {
+        // Keep an instruction without dependencies from issuing ahead of
+        // all older loads and stores.
+        uint64_t last_mem = std::max(lastLoad, lastStore);
+        if (last_mem && findRecord(last_mem)) {
+            addDep(rec.robDeps, last_mem);
+            ++stats.numIssueOrderDep;
+        }
+    }
+
+    for (int i = 0; i < si->numDestRegs(); i++) {
+        const RegId reg = thread->flattenRegId(si->destRegIdx(i));
+        if (reg.isMiscReg() || reg.isZeroReg())
+            continue;
+        lastWriter[reg] = rec.seqNum;
+    }
+
+    if (rec.type == Record::LOAD) {
+        lastLoad = rec.seqNum;
+    } else if (rec.type == Record::STORE) {
+        lastStore = rec.seqNum;
+        if (rec.size) {
+            forEachWord(rec.physAddr, rec.size, [&](Addr word) {
+                lastStoreTo[word] = rec.seqNum;
+            });
+        }
+    }
+
+    window.push_back(std::move(rec));
+    if (window.size() > depWindowSize)
+        writeRecords(window.size() - depWindowSize);
+}
+
+void
+AtomicElasticTrace::writeRecords(size_t num)
+{
+    for (; num > 0; --num) {
+        const TraceInfo &rec = window.front();
+
+        if (rec.type == Record::STORE && rec.size) {
+            // Forget the words that no younger store has written.
+            forEachWord(rec.physAddr, rec.size, [&](Addr word) {
+                auto it = lastStoreTo.find(word);
+                if (it != lastStoreTo.end() && it->second == rec.seqNum)
+                    lastStoreTo.erase(it);
+            });
+        }
+
+        if (rec.type == Record::COMP && rec.numDepts == 0) {
+            // Nothing depends on this compute instruction, account for it
+            // in the weight of the next record instead.
+            ++stats.numFilteredNodes;
+            ++numFiltered;
+            window.pop_front();
+            continue;
+        }
+
+        DPRINTFR(AtomicElasticTrace, "Writing seq. num. %lli, type %i, "
+                 "pc %#x, comp. delay %lli\n", rec.seqNum, rec.type, rec.pc,
+                 rec.compDelay);
+
+        Record dep_pkt;
+        dep_pkt.set_seq_num(rec.seqNum);
+        dep_pkt.set_type(rec.type);
+        dep_pkt.set_pc(rec.pc);
+        if (rec.type != Record::COMP) {
+            dep_pkt.set_flags(rec.flags);
+            dep_pkt.set_p_addr(rec.physAddr);
+            if (traceVirtAddr)
+                dep_pkt.set_v_addr(rec.virtAddr);
+            dep_pkt.set_size(rec.size);
+        }
+        dep_pkt.set_comp_delay(rec.compDelay);
+        for (auto dep : rec.robDeps)
+            dep_pkt.add_rob_dep(dep);
+        for (auto dep : rec.regDeps)
+            dep_pkt.add_reg_dep(dep);
+        if (numFiltered != 0) {
+            dep_pkt.set_weight(numFiltered);
+            numFiltered = 0;
+        }
+        dataTraceStream->write(dep_pkt);
+        ++stats.numRecords;
+
+        window.pop_front();
+    }
+}
+
+void
+AtomicElasticTrace::endSample()
+{
+    writeRecords(window.size());
+    lastWriter.clear();
+    lastStoreTo.clear();
+    lastLoad = 0;
+    lastStore = 0;
+}
+
+void
+AtomicElasticTrace::flushTraces()
+{
+    writeRecords(window.size());
+    delete dataTraceStream;
+    delete instTraceStream;
+    dataTraceStream = nullptr;
+    instTraceStream = nullptr;
+}
+
+AtomicElasticTrace::AtomicElasticTraceStats::AtomicElasticTraceStats(
+        Stats::Group *parent)
+    : Stats::Group(parent),
+      ADD_STAT(numRegDep, "Number of register dependencies recorded during "
+               "tracing"),
+      ADD_STAT(numMemDep, "Number of dependencies of loads on older "
+               "stores"),
+      ADD_STAT(numOrderDepStores, "Number of order dependencies of stores "
+               "on older loads and stores"),
+      ADD_STAT(numIssueOrderDep, "Number of dependency-free records given "
+               "an issue order dependency"),
+      ADD_STAT(numRecords, "Number of records written to the trace"),
+      ADD_STAT(numFilteredNodes, "No. of nodes filtered")
+{
+}
+
+AtomicElasticTrace *
+AtomicElasticTraceParams::create()
+{
+    return new AtomicElasticTrace(this);
+}
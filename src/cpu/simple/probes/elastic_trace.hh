@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2020 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * A probe listener that generates elastic traces from the AtomicSimpleCPU.
+ *
+ * The O3 ElasticTrace derives the dependencies and compute delays of the
+ * trace from the timing of the detailed pipeline. This listener instead
+ * derives them from the committed instruction stream of the atomic CPU, so
+ * traces can be generated at atomic speed. Register dependencies are taken
+ * from the last writer of every architectural register and a load depends
+ * on the last store that wrote any of the bytes it reads. A store gets order
+ * dependencies on the last load and store, as stores commit in order, and
+ * an instruction without any dependency gets an issue order dependency on
+ * the last load or store. All dependencies are limited to a window of
+ * depWindowSize instructions. The compute delay of an instruction is the
+ * latency of its op class in the default O3 functional units.
+ *
+ * Compute instructions that no instruction depends on are filtered out and
+ * counted in the weight of the next record, like in the O3 ElasticTrace.
+ * Tracing can start after a number of instructions and can be limited to
+ * periodic samples.
+ */
+
+#ifndef __CPU_SIMPLE_PROBES_ELASTIC_TRACE_HH__
+#define __CPU_SIMPLE_PROBES_ELASTIC_TRACE_HH__
+
+#include <deque>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "base/statistics.hh"
+#include "cpu/reg_class.hh"
+#include "cpu/simple_thread.hh"
+#include "cpu/static_inst.hh"
+#include "mem/request.hh"
+#include "params/AtomicElasticTrace.hh"
+#include "proto/inst_dep_record.pb.h"
+#include "proto/protoio.hh"
+#include "sim/eventq.hh"
+#include "sim/probe/probe.hh"
+
+class AtomicSimpleCPU;
+
+class AtomicElasticTrace : public ProbeListenerObject
+{
+  public:
+    typedef ProtoMessage::InstDepRecord::RecordType RecordType;
+    typedef ProtoMessage::InstDepRecord Record;
+
+    AtomicElasticTrace(const AtomicElasticTraceParams *params);
+
+    /**
+     * Register the listeners, either now or when startTraceInst
+     * instructions have been committed.
+     */
+    void regProbeListeners() override;
+
+    /** Write a fetch request to the instruction fetch trace. */
+    void fetchRequest(const RequestPtr &req);
+
+    /** Remember the access of the instruction being executed. */
+    void dataRequest(const RequestPtr &req);
+
+    typedef std::pair<SimpleThread *, const StaticInstPtr> CommitInfo;
+
+    /** Add a committed instruction to the dependency trace. */
+    void commit(const CommitInfo &inst);
+
+    /** Write out all buffered records and close the traces. */
+    void flushTraces();
+
+  private:
+    /**
+     * The first data access of the instruction being executed. The CPU
+     * reuses its request objects for every access, so the fields are
+     * copied when the request is sent.
+     */
+    struct DataAccess
+    {
+        bool valid;
+        Addr pc;
+        Addr physAddr;
+        Addr virtAddr;
+        unsigned size;
+        Request::FlagsType flags;
+    };
+
+    /** A record that has not been written to the trace yet. */
+    struct TraceInfo
+    {
+        uint64_t seqNum;
+        RecordType type;
+        Addr pc;
+        Addr physAddr;
+        Addr virtAddr;
+        unsigned size;
+        Request::FlagsType flags;
+        Tick compDelay;
+        std::vector<uint64_t> robDeps;
+        std::vector<uint64_t> regDeps;
+        /** Number of records depending on this one */
+        uint32_t numDepts;
+    };
+
+    /** Register all listeners. */
+    void regListeners();
+
+    /** Is the committed instruction count within a sample? */
+    bool inSample() const;
+
+    /** Buffer the record of a committed instruction. */
+    void addRecord(SimpleThread *thread, const StaticInstPtr &inst,
+                   const DataAccess &access);
+
+    /** Return the buffered record of a seq. num. within the window. */
+    TraceInfo *findRecord(uint64_t seq_num);
+
+    /** Add a dependency on a past record. */
+    void addDep(std::vector<uint64_t> &deps, uint64_t seq_num);
+
+    /** Call f with the key of every word an access touches. */
+    template <typename F>
+    static void
+    forEachWord(Addr addr, unsigned size, F f)
+    {
+        for (Addr w = addr / WordSize; w <= (addr + size - 1) / WordSize; w++)
+            f(w);
+    }
+
+    /** Write out the oldest num records of the window. */
+    void writeRecords(size_t num);
+
+    /** Write out the window and forget all dependencies. */
+    void endSample();
+
+    /** Compute latency of an instruction in cycles. */
+    static Cycles opLatency(const StaticInstPtr &inst);
+
+    /** The CPU generating the trace. */
+    AtomicSimpleCPU *cpu;
+
+    /** Event to register the listeners after startTraceInst insts. */
+    EventFunctionWrapper regListenersEvent;
+
+    /** Maximum distance of a dependency in instructions. */
+    const uint32_t depWindowSize;
+
+    /** Number of committed instructions to skip before tracing. */
+    const uint64_t startTraceInst;
+
+    /** Length and period of the samples in committed instructions. */
+    const uint64_t sampleInsts;
+    const uint64_t sampleInterval;
+
+    /** Trace the virtual addresses of loads and stores. */
+    const bool traceVirtAddr;
+
+    ProtoOutputStream *instTraceStream;
+    ProtoOutputStream *dataTraceStream;
+
+    /** Number of instructions committed since tracing started. */
+    uint64_t numCommitted;
+
+    /** Sequence number of the next record. */
+    uint64_t nextSeqNum;
+
+    /** Records of the last depWindowSize instructions. */
+    std::deque<TraceInfo> window;
+
+    /** Last writer of every register. */
+    std::unordered_map<RegId, uint64_t> lastWriter;
+
+    /** Granularity of the memory dependency tracking. */
+    static const unsigned WordSize = 8;
+
+    /** Last store to every word within the window. */
+    std::unordered_map<Addr, uint64_t> lastStoreTo;
+
+    /** Sequence numbers of the last load and store, zero if none. */
+    uint64_t lastLoad;
+    uint64_t lastStore;
+
+    /** Number of records filtered out since the last written record. */
+    uint32_t numFiltered;
+
+    /** The first data access of the instruction being executed. */
+    DataAccess dataAccess;
+
+    struct AtomicElasticTraceStats : public Stats::Group
+    {
+        AtomicElasticTraceStats(Stats::Group *parent);
+
+        /** Number of register dependencies recorded during tracing */
+        Stats::Scalar numRegDep;
+
+        /** Number of dependencies of loads on older stores */
+        Stats::Scalar numMemDep;
+
+        /** Number of order dependencies of stores on loads and stores */
+        Stats::Scalar numOrderDepStores;
+
+        /** Number of dependency-free records given an issue order dep. */
+        Stats::Scalar numIssueOrderDep;
+
+        /** Number of records written to the trace */
+        Stats::Scalar numRecords;
+
+        /** Number of filtered nodes */
+        Stats::Scalar numFilteredNodes;
+    } stats;
+};
+
+#endif // __CPU_SIMPLE_PROBES_ELASTIC_TRACE_HH__
@@ -45,17 +45,31 @@
 #include "proto/packet.pb.h"
 
 TraceGen::InputStream::InputStream(const std::string& filename)
-    : trace(filename)
 {
+    if (MappedTrace::isMappedTrace(filename)) {
+        mappedTrace.reset(new MappedTrace(filename,
+                                          MappedTrace::PacketTrace));
+        cursor.reset(new MappedTrace::PacketCursor(*mappedTrace));
+    } else {
+        protoTrace.reset(new ProtoInputStream(filename));
+    }
     init();
 }
 
 void
 TraceGen::InputStream::init()
 {
+    if (mappedTrace) {
+        if (mappedTrace->tickFreq() != SimClock::Frequency) {
+            panic("Trace was recorded with a different tick frequency %d\n",
+                  mappedTrace->tickFreq());
+        }
+        return;
+    }
+
     // Create a protobuf message for the header and read it from the stream
     ProtoMessage::PacketHeader header_msg;
-    if (!trace.read(header_msg)) {
+    if (!protoTrace->read(header_msg)) {
         panic("Failed to read packet header from trace\n");
     } else if (header_msg.tick_freq() != SimClock::Frequency) {
         panic("Trace was recorded with a different tick frequency %d\n",
@@ -66,15 +80,34 @@ TraceGen::InputStream::init()
 void
 TraceGen::InputStream::reset()
 {
-    trace.reset();
-    init();
+    if (mappedTrace) {
+        cursor->seekRecord(0);
+    } else {
+        protoTrace->reset();
+        init();
+    }
 }
 
 bool
 TraceGen::InputStream::read(TraceElement& element)
 {
+    if (mappedTrace) {
+        if (!cursor->valid())
+            return false;
+
+        const MappedTrace::PacketBlock &block = cursor->current();
+        const uint32_t i = cursor->index();
+        element.cmd = block.cmd(i);
+        element.addr = block.addr(i);
+        element.blocksize = block.blockSize(i);
+        element.tick = block.tick(i);
+        element.flags = block.flags(i);
+        cursor->next();
+        return true;
+    }
+
     ProtoMessage::Packet pkt_msg;
-    if (trace.read(pkt_msg)) {
+    if (protoTrace->read(pkt_msg)) {
         element.cmd = pkt_msg.cmd();
         element.addr = pkt_msg.addr();
         element.blocksize = pkt_msg.size();
@@ -44,8 +44,11 @@
 #ifndef __CPU_TRAFFIC_GEN_TRACE_GEN_HH__
 #define __CPU_TRAFFIC_GEN_TRACE_GEN_HH__
 
+#include <memory>
+
 #include "base/bitfield.hh"
 #include "base/intmath.hh"
+#include "base/mapped_trace.hh"
 #include "base_gen.hh"
 #include "mem/packet.hh"
 #include "proto/protoio.hh"
@@ -100,7 +103,8 @@ class TraceGen : public BaseGen
     /**
      * The InputStream encapsulates a trace file and the
      * internal buffers and populates TraceElements based on
-     * the input.
+     * the input. The trace is either a protobuf stream or a
+     * mapped trace, see MappedTrace.
      */
     class InputStream
     {
@@ -108,7 +112,11 @@ class TraceGen : public BaseGen
       private:
 
         /// Input file stream for the protobuf trace
-        ProtoInputStream trace;
+        std::unique_ptr<ProtoInputStream> protoTrace;
+
+        /// Mapped trace and the position of the next element in it
+        std::unique_ptr<MappedTrace> mappedTrace;
+        std::unique_ptr<MappedTrace::PacketCursor> cursor;
 
       public:
 
@@ -34,6 +34,7 @@
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 from m5.params import *
+from m5.proxy import *
 from m5.objects.BaseCPU import BaseCPU
 
 class TraceCPU(BaseCPU):
@@ -83,3 +84,26 @@ class TraceCPU(BaseCPU):
     progressMsgInterval = Param.Unsigned(0, "Interval of committed "\
                                          "instructions at which to print a"\
                                          " progress msg")
+
+    # The traces are parsed ahead of the replay by a reader thread per
+    # trace. Setting the number of batches to zero reads the traces
+    # synchronously instead.
+    prefetchBatches = Param.Unsigned(4, "Number of parsed trace batches "\
+                                     "to buffer ahead of the replay")
+    prefetchBatchSize = Param.Unsigned(1024, "Number of trace records in "\
+                                       "each prefetched batch")
+
+    # Event queue of the memory system the Trace CPU is connected to. The
+    # Trace CPU itself can be moved to a different event queue by setting
+    # its eventq_index to replay many Trace CPUs in parallel.
+    memEventqIndex = Param.UInt32(Parent.eventq_index, "Event queue index "\
+                                  "of the memory system")
+
+    # Mapped traces (see util/mapped_trace.py) can be replayed from the
+    # middle, e.g., to split a trace into shards replayed by several Trace
+    # CPUs. The replay starts at the first record at or after the given
+    # tick and sequence number respectively.
+    instTraceStartTick = Param.UInt64(0, "Tick to start replaying the "\
+                                      "mapped instruction trace at")
+    dataTraceStartSeqNum = Param.UInt64(0, "Sequence number to start "\
+                                        "replaying the mapped data trace at")
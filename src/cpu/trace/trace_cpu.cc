@@ -40,7 +40,7 @@
 #include "sim/sim_exit.hh"
 
 // Declare and initialize the static counter for number of trace CPUs.
-int TraceCPU::numTraceCPUs = 0;
+std::atomic<int> TraceCPU::numTraceCPUs(0);
 
 TraceCPU::TraceCPU(TraceCPUParams *params)
     :   BaseCPU(params),
@@ -50,14 +50,17 @@ TraceCPU::TraceCPU(TraceCPUParams *params)
         dataRequestorID(params->system->getRequestorId(this, "data")),
         instTraceFile(params->instTraceFile),
         dataTraceFile(params->dataTraceFile),
-        icacheGen(*this, ".iside", icachePort, instRequestorID, instTraceFile),
+        icacheGen(*this, ".iside", icachePort, instRequestorID, instTraceFile,
+                  params),
         dcacheGen(*this, ".dside", dcachePort, dataRequestorID, dataTraceFile,
                   params),
         icacheNextEvent([this]{ schedIcacheNext(); }, name()),
         dcacheNextEvent([this]{ schedDcacheNext(); }, name()),
         oneTraceComplete(false),
         traceOffset(0),
-        execCompleteEvent(nullptr),
+        execCompleteEvent([this]{ execComplete(); }, name(), false,
+                          Event::Sim_Exit_Pri),
+        memEventq(getEventQueue(params->memEventqIndex)),
         enableEarlyExit(params->enableEarlyExit),
         progressMsgInterval(params->progressMsgInterval),
         progressMsgThreshold(params->progressMsgInterval), traceStats(this)
@@ -137,17 +140,13 @@ TraceCPU::init()
     // send its first request at the first event and schedule subsequent
     // events using a relative tick delta
     dcacheGen.adjustInitTraceOffset(traceOffset);
+}
 
-    // If the Trace CPU simulation is configured to exit on any one trace
-    // completion then we don't need a counted event to count down all Trace
-    // CPUs in the system. If not then instantiate a counted event.
-    if (!enableEarlyExit) {
-        // The static counter for number of Trace CPUs is correctly set at
-        // this point so create an event and pass it.
-        execCompleteEvent = new CountedExitEvent("end of all traces reached.",
-                                                 numTraceCPUs);
-    }
-
+void
+TraceCPU::execComplete()
+{
+    if (--numTraceCPUs == 0)
+        exitSimLoop("end of all traces reached.", 0);
 }
 
 void
@@ -205,7 +204,7 @@ TraceCPU::checkAndSchedExitEvent()
         if (enableEarlyExit) {
             exitSimLoop("End of trace reached");
         } else {
-            schedule(*execCompleteEvent, curTick());
+            schedule(execCompleteEvent, curTick());
         }
     }
 }
@@ -413,6 +412,7 @@ TraceCPU::ElasticDataGen::execute()
                 panic("Retry packet's seqence number does not match "
                       "the first node in the readyList.\n");
             }
+            EventQueue::ScopedMigration migrate(owner.memEventQueue());
             if (port.sendTimingReq(retryPkt)) {
                 ++elasticStats.numRetrySucceeded;
                 retryPkt = nullptr;
@@ -620,7 +620,11 @@ TraceCPU::ElasticDataGen::executeMemReq(GraphNode* node_ptr)
     pkt->dataDynamic(pkt_data);
 
     // Call RequestPort method to send a timing request for this packet
-    bool success = port.sendTimingReq(pkt);
+    bool success;
+    {
+        EventQueue::ScopedMigration migrate(owner.memEventQueue());
+        success = port.sendTimingReq(pkt);
+    }
     ++elasticStats.numSendAttempted;
 
     if (!success) {
@@ -989,6 +993,7 @@ TraceCPU::FixedRetryGen::tryNext()
 
         DPRINTF(TraceCPUInst, "Trying to send retry packet.\n");
 
+        EventQueue::ScopedMigration migrate(owner.memEventQueue());
         if (!port.sendTimingReq(retryPkt)) {
             // Still blocked! This should never occur.
             DPRINTF(TraceCPUInst, "Retry packet sending failed.\n");
@@ -1090,6 +1095,7 @@ TraceCPU::FixedRetryGen::send(Addr addr, unsigned size, const MemCmd& cmd,
     }
 
     // Call RequestPort method to send a timing request for this packet
+    EventQueue::ScopedMigration migrate(owner.memEventQueue());
     bool success = port.sendTimingReq(pkt);
     if (!success) {
         // If it fails, save the packet to retry when a retry is signalled by
@@ -1148,6 +1154,7 @@ TraceCPU::IcachePort::recvTimingResp(PacketPtr pkt)
 void
 TraceCPU::IcachePort::recvReqRetry()
 {
+    EventQueue::ScopedMigration migrate(owner->eventQueue());
     owner->icacheRetryRecvd();
 }
 
@@ -1163,7 +1170,10 @@ TraceCPU::DcachePort::recvTimingResp(PacketPtr pkt)
 {
     // Handle the responses for data memory requests which is done inside the
     // elastic data generator
-    owner->dcacheRecvTimingResp(pkt);
+    {
+        EventQueue::ScopedMigration migrate(owner->eventQueue());
+        owner->dcacheRecvTimingResp(pkt);
+    }
     // After processing the response delete the packet to free
     // memory
     delete pkt;
@@ -1174,19 +1184,38 @@ TraceCPU::DcachePort::recvTimingResp(PacketPtr pkt)
 void
 TraceCPU::DcachePort::recvReqRetry()
 {
+    EventQueue::ScopedMigration migrate(owner->eventQueue());
     owner->dcacheRetryRecvd();
 }
 
 TraceCPU::ElasticDataGen::InputStream::InputStream(
     const std::string& filename,
-    const double time_multiplier)
-    : trace(filename),
-      timeMultiplier(time_multiplier),
+    const TraceCPUParams *params)
+    : startSeqNum(params->dataTraceStartSeqNum),
+      timeMultiplier(1.0 / params->freqMultiplier),
       microOpCount(0)
 {
+    if (MappedTrace::isMappedTrace(filename)) {
+        mappedTrace.reset(new MappedTrace(filename,
+                                          MappedTrace::InstDepTrace));
+        panic_if(mappedTrace->tickFreq() != SimClock::Frequency,
+                 "Trace %s was recorded with a different tick frequency "
+                 "%d\n", filename, mappedTrace->tickFreq());
+        windowSize = mappedTrace->windowSize();
+        cursor.reset(new MappedTrace::InstDepCursor(*mappedTrace));
+        cursor->seekKey(startSeqNum);
+        return;
+    }
+
+    fatal_if(startSeqNum != 0, "Trace %s has to be a mapped trace to "
+             "start replaying it at a sequence number.\n", filename);
+    protoTrace.reset(new ProtoPrefetchStream<ProtoMessage::InstDepRecord>(
+                         filename, params->prefetchBatches,
+                         params->prefetchBatchSize));
+
     // Create a protobuf message for the header and read it from the stream
     ProtoMessage::InstDepRecordHeader header_msg;
-    if (!trace.read(header_msg)) {
+    if (!protoTrace->readHeader(header_msg)) {
         panic("Failed to read packet header from %s\n", filename);
 
         if (header_msg.tick_freq() != SimClock::Frequency) {
@@ -1203,14 +1232,72 @@ TraceCPU::ElasticDataGen::InputStream::InputStream(
 void
 TraceCPU::ElasticDataGen::InputStream::reset()
 {
-    trace.reset();
+    if (mappedTrace)
+        cursor->seekKey(startSeqNum);
+    else
+        protoTrace->reset();
+}
+
+bool
+TraceCPU::ElasticDataGen::InputStream::readMapped(GraphNode* element)
+{
+    if (!cursor->valid())
+        return false;
+
+    const MappedTrace::InstDepBlock &block = cursor->current();
+    const uint32_t i = cursor->index();
+
+    element->seqNum = block.seqNum(i);
+    element->type = static_cast<RecordType>(block.type(i));
+    // Scale the compute delay to effectively scale the Trace CPU frequency
+    element->compDelay = block.compDelay(i) * timeMultiplier;
+
+    element->clearRobDep();
+    assert(block.numRobDeps(i) <= element->maxRobDep);
+    for (uint32_t j = 0; j < block.numRobDeps(i); j++) {
+        element->robDep[element->numRobDep] = block.robDep(i, j);
+        element->numRobDep += 1;
+    }
+
+    // As for the protobuf trace, a register dependency on an instruction
+    // that is also an order dependency is omitted
+    element->clearRegDep();
+    assert(block.numRegDeps(i) <= TheISA::MaxInstSrcRegs);
+    for (uint32_t j = 0; j < block.numRegDeps(i); j++) {
+        const NodeSeqNum reg_dep = block.regDep(i, j);
+        bool duplicate = false;
+        for (int k = 0; k < element->numRobDep; k++) {
+            duplicate |= (reg_dep == element->robDep[k]);
+        }
+        if (!duplicate) {
+            element->regDep[element->numRegDep] = reg_dep;
+            element->numRegDep += 1;
+        }
+    }
+
+    // Absent optional fields are stored as zero
+    element->physAddr = block.physAddr(i);
+    element->virtAddr = block.virtAddr(i);
+    element->size = block.accessSize(i);
+    element->flags = block.flags(i);
+    element->pc = block.pc(i);
+
+    // ROB occupancy number
+    microOpCount += 1 + block.weight(i);
+    element->robNum = microOpCount;
+
+    cursor->next();
+    return true;
 }
 
 bool
 TraceCPU::ElasticDataGen::InputStream::read(GraphNode* element)
 {
+    if (mappedTrace)
+        return readMapped(element);
+
     ProtoMessage::InstDepRecord pkt_msg;
-    if (trace.read(pkt_msg)) {
+    if (protoTrace->read(pkt_msg)) {
         // Required fields
         element->seqNum = pkt_msg.seq_num();
         element->type = pkt_msg.type();
@@ -1387,12 +1474,31 @@ TraceCPU::ElasticDataGen::GraphNode::typeToStr() const
     return Record::RecordType_Name(type);
 }
 
-TraceCPU::FixedRetryGen::InputStream::InputStream(const std::string& filename)
-    : trace(filename)
+TraceCPU::FixedRetryGen::InputStream::InputStream(
+    const std::string& filename,
+    const TraceCPUParams *params)
+    : startTick(params->instTraceStartTick)
 {
+    if (MappedTrace::isMappedTrace(filename)) {
+        mappedTrace.reset(new MappedTrace(filename,
+                                          MappedTrace::PacketTrace));
+        panic_if(mappedTrace->tickFreq() != SimClock::Frequency,
+                 "Trace %s was recorded with a different tick frequency "
+                 "%d\n", filename, mappedTrace->tickFreq());
+        cursor.reset(new MappedTrace::PacketCursor(*mappedTrace));
+        cursor->seekKey(startTick);
+        return;
+    }
+
+    fatal_if(startTick != 0, "Trace %s has to be a mapped trace to start "
+             "replaying it at a tick.\n", filename);
+    protoTrace.reset(new ProtoPrefetchStream<ProtoMessage::Packet>(
+                         filename, params->prefetchBatches,
+                         params->prefetchBatchSize));
+
     // Create a protobuf message for the header and read it from the stream
     ProtoMessage::PacketHeader header_msg;
-    if (!trace.read(header_msg)) {
+    if (!protoTrace->readHeader(header_msg)) {
         panic("Failed to read packet header from %s\n", filename);
 
         if (header_msg.tick_freq() != SimClock::Frequency) {
@@ -1405,14 +1511,33 @@ TraceCPU::FixedRetryGen::InputStream::InputStream(const std::string& filename)
 void
 TraceCPU::FixedRetryGen::InputStream::reset()
 {
-    trace.reset();
+    if (mappedTrace)
+        cursor->seekKey(startTick);
+    else
+        protoTrace->reset();
 }
 
 bool
 TraceCPU::FixedRetryGen::InputStream::read(TraceElement* element)
 {
+    if (mappedTrace) {
+        if (!cursor->valid())
+            return false;
+
+        const MappedTrace::PacketBlock &block = cursor->current();
+        const uint32_t i = cursor->index();
+        element->cmd = block.cmd(i);
+        element->addr = block.addr(i);
+        element->blocksize = block.blockSize(i);
+        element->tick = block.tick(i);
+        element->flags = block.flags(i);
+        element->pc = block.pc(i);
+        cursor->next();
+        return true;
+    }
+
     ProtoMessage::Packet pkt_msg;
-    if (trace.read(pkt_msg)) {
+    if (protoTrace->read(pkt_msg)) {
         element->cmd = pkt_msg.cmd();
         element->addr = pkt_msg.addr();
         element->blocksize = pkt_msg.size();
@@ -39,12 +39,15 @@
 #define __CPU_TRACE_TRACE_CPU_HH__
 
 #include <array>
+#include <atomic>
 #include <cstdint>
+#include <memory>
 #include <queue>
 #include <set>
 #include <unordered_map>
 
 #include "arch/registers.hh"
+#include "base/mapped_trace.hh"
 #include "base/statistics.hh"
 #include "cpu/base.hh"
 #include "debug/TraceCPUData.hh"
@@ -53,7 +56,7 @@
 #include "proto/inst_dep_record.pb.h"
 #include "proto/packet.pb.h"
 #include "proto/protoio.hh"
-#include "sim/sim_events.hh"
+#include "sim/eventq.hh"
 
 /**
  * The trace cpu replays traces generated using the elastic trace probe
@@ -132,9 +135,16 @@
  * Strictly-ordered requests are skipped and the dependencies on such requests
  * are handled by simply marking them complete immediately.
  *
- * A CountedExitEvent that contains a static int belonging to the Trace CPU
- * class as a down counter is used to implement multi Trace CPU simulation
- * exit.
+ * An exit event that decrements a static atomic counter belonging to the
+ * Trace CPU class is used to implement multi Trace CPU simulation exit.
+ *
+ * The traces are parsed ahead of the replay by a reader thread per trace,
+ * see ProtoPrefetchStream. Alternatively, both traces can be mapped traces,
+ * see MappedTrace, which are decoded in place and can be replayed starting
+ * at a given tick and sequence number respectively. Trace CPUs can be
+ * placed on separate event queues to replay many cores in parallel. The
+ * memory system stays on the event queue given by memEventqIndex, and
+ * requests, responses and retries migrate between the queues.
  */
 
 class TraceCPU : public BaseCPU
@@ -392,7 +402,15 @@ class TraceCPU : public BaseCPU
           private:
 
             // Input file stream for the protobuf trace
-            ProtoInputStream trace;
+            std::unique_ptr<ProtoPrefetchStream<ProtoMessage::Packet>>
+                protoTrace;
+
+            // Mapped trace and the position of the next element in it
+            std::unique_ptr<MappedTrace> mappedTrace;
+            std::unique_ptr<MappedTrace::PacketCursor> cursor;
+
+            // Tick of the first element replayed from a mapped trace
+            const Tick startTick;
 
           public:
 
@@ -400,8 +418,10 @@ class TraceCPU : public BaseCPU
              * Create a trace input stream for a given file name.
              *
              * @param filename Path to the file to read from
+             * @param params Parameters of the Trace CPU
              */
-            InputStream(const std::string& filename);
+            InputStream(const std::string& filename,
+                        const TraceCPUParams *params);
 
             /**
              * Reset the stream such that it can be played once
@@ -424,11 +444,12 @@ class TraceCPU : public BaseCPU
         /* Constructor */
         FixedRetryGen(TraceCPU& _owner, const std::string& _name,
                    RequestPort& _port, RequestorID requestor_id,
-                   const std::string& trace_file)
+                   const std::string& trace_file,
+                   const TraceCPUParams *params)
             : owner(_owner),
               port(_port),
               requestorId(requestor_id),
-              trace(trace_file),
+              trace(trace_file, params),
               genName(owner.name() + ".fixedretry." + _name),
               retryPkt(nullptr),
               delta(0),
@@ -796,7 +817,19 @@ class TraceCPU : public BaseCPU
           private:
 
             /** Input file stream for the protobuf trace */
-            ProtoInputStream trace;
+            std::unique_ptr<ProtoPrefetchStream<ProtoMessage::InstDepRecord>>
+                protoTrace;
+
+            /** Mapped trace and the position of the next node in it */
+            std::unique_ptr<MappedTrace> mappedTrace;
+            std::unique_ptr<MappedTrace::InstDepCursor> cursor;
+
+            /** Sequence number of the first node replayed from a mapped
+             * trace */
+            const uint64_t startSeqNum;
+
+            /** Read the next node from the mapped trace. */
+            bool readMapped(GraphNode* element);
 
             /**
              * A multiplier for the compute delays in the trace to modulate
@@ -820,10 +853,10 @@ class TraceCPU : public BaseCPU
              * Create a trace input stream for a given file name.
              *
              * @param filename Path to the file to read from
-             * @param time_multiplier used to scale the compute delays
+             * @param params Parameters of the Trace CPU
              */
             InputStream(const std::string& filename,
-                        const double time_multiplier);
+                        const TraceCPUParams *params);
 
             /**
              * Reset the stream such that it can be played once
@@ -857,7 +890,7 @@ class TraceCPU : public BaseCPU
             : owner(_owner),
               port(_port),
               requestorId(requestor_id),
-              trace(trace_file, 1.0 / params->freqMultiplier),
+              trace(trace_file, params),
               genName(owner.name() + ".elastic." + _name),
               retryPkt(nullptr),
               traceComplete(false),
@@ -1107,19 +1140,32 @@ class TraceCPU : public BaseCPU
     Tick traceOffset;
 
     /**
-     * Number of Trace CPUs in the system used as a shared variable and passed
-     * to the CountedExitEvent event used for counting down exit events.  It is
-     * incremented in the constructor call so that the total is arrived at
-     * automatically.
+     * Number of Trace CPUs in the system that have not completed their
+     * execution yet. It is incremented in the constructor call so that the
+     * total is arrived at automatically. The Trace CPUs may be spread over
+     * several event queues, so the counter is atomic.
      */
-    static int numTraceCPUs;
+    static std::atomic<int> numTraceCPUs;
 
    /**
-    * A CountedExitEvent which when serviced decrements the counter. A sim
-    * exit event is scheduled when the counter equals zero, that is all
-    * instances of Trace CPU have had their execCompleteEvent serviced.
+    * An event which when serviced decrements the counter. A sim exit event
+    * is scheduled when the counter equals zero, that is all instances of
+    * Trace CPU have had their execCompleteEvent serviced.
     */
-    CountedExitEvent *execCompleteEvent;
+    EventFunctionWrapper execCompleteEvent;
+
+    /** Count down the completed Trace CPUs and exit after the last one. */
+    void execComplete();
+
+    /**
+     * Event queue of the memory system. Requests are sent and responses
+     * and retries are received with the corresponding queue locked, so
+     * Trace CPUs can run on their own event queues.
+     */
+    EventQueue *memEventQueue() { return memEventq; }
+
+    /** Event queue of the memory system, see memEventQueue(). */
+    EventQueue *memEventq;
 
     /**
      * Exit when any one Trace CPU completes its execution. If this is
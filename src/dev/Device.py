@@ -90,6 +90,21 @@ class DmaDevice(PioDevice):
         "Substream identifier used by an IOMMU to distinguish amongst "
         "several devices attached to it")
 
+    # In bulk mode a DMA transfer is not split into cache line sized
+    # packets, but timed as a whole with a simple bandwidth and latency
+    # model. This bypasses the memory system timing entirely.
+    dma_bulk = Param.Bool(False, "Handle DMA transfers in bulk")
+    dma_bulk_bandwidth = Param.MemoryBandwidth("16GB/s",
+        "Bandwidth of the DMA port in bulk mode")
+    dma_bulk_latency = Param.Latency("100ns",
+        "Latency of a DMA transfer in bulk mode")
+    dma_bulk_coherent = Param.Bool(True,
+        "Keep the caches coherent with bulk DMA transfers, if false and "
+        "the system is in atomic mode the transfers use atomic accesses, "
+        "and a backdoor to the memory once one is handed out (the DMA "
+        "addresses must then be physical addresses); timing mode systems "
+        "always use coherent transfers")
+
     def addIommuProperty(self, state, node):
         """
         This method takes an FdtState and a FdtNode as parameters, and
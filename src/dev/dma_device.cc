@@ -40,6 +40,8 @@
 
 #include "dev/dma_device.hh"
 
+#include <algorithm>
+#include <cstring>
 #include <utility>
 
 #include "base/chunk_generator.hh"
@@ -56,9 +58,21 @@ DmaPort::DmaPort(ClockedObject *dev, System *s,
       sendEvent([this]{ sendDma(); }, dev->name()),
       pendingCount(0), inRetry(false),
       defaultSid(sid),
-      defaultSSid(ssid)
+      defaultSSid(ssid),
+      bulk(false), bulkTicksPerByte(0), bulkLatency(0), bulkCoherent(true),
+      bulkFreeAt(0),
+      bulkEvent([this]{ completeBulkDma(); }, dev->name() + ".bulk")
 { }
 
+void
+DmaPort::setBulkMode(double ticks_per_byte, Tick latency, bool coherent)
+{
+    bulk = true;
+    bulkTicksPerByte = ticks_per_byte;
+    bulkLatency = latency;
+    bulkCoherent = coherent;
+}
+
 void
 DmaPort::handleResp(PacketPtr pkt, Tick delay)
 {
@@ -116,7 +130,12 @@ DmaPort::recvTimingResp(PacketPtr pkt)
 
 DmaDevice::DmaDevice(const Params *p)
     : PioDevice(p), dmaPort(this, sys, p->sid, p->ssid)
-{ }
+{
+    if (p->dma_bulk) {
+        dmaPort.setBulkMode(p->dma_bulk_bandwidth, p->dma_bulk_latency,
+                            p->dma_bulk_coherent);
+    }
+}
 
 void
 DmaDevice::init()
@@ -149,11 +168,6 @@ DmaPort::dmaAction(Packet::Command cmd, Addr addr, int size, Event *event,
                    uint8_t *data, uint32_t sid, uint32_t ssid, Tick delay,
                    Request::Flags flag)
 {
-    // one DMA request sender state for every action, that is then
-    // split into many requests and packets based on the block size,
-    // i.e. cache line size
-    DmaReqState *reqState = new DmaReqState(event, size, delay);
-
     // (functionality added for Table Walker statistics)
     // We're only interested in this when there will only be one request.
     // For simplicity, we return the last request, which would also be
@@ -162,6 +176,22 @@ DmaPort::dmaAction(Packet::Command cmd, Addr addr, int size, Event *event,
 
     DPRINTF(DMA, "Starting DMA for addr: %#x size: %d sched: %d\n", addr, size,
             event ? event->scheduled() : -1);
+
+    if (bulk) {
+        req = std::make_shared<Request>(addr, size, flag, requestorId);
+        req->setStreamId(sid);
+        req->setSubStreamId(ssid);
+        req->taskId(ContextSwitchTaskId::DMA);
+
+        queueBulkDma(cmd, req, data, event, delay);
+        return req;
+    }
+
+    // one DMA request sender state for every action, that is then
+    // split into many requests and packets based on the block size,
+    // i.e. cache line size
+    DmaReqState *reqState = new DmaReqState(event, size, delay);
+
     for (ChunkGenerator gen(addr, size, sys->cacheLineSize());
          !gen.done(); gen.next()) {
 
@@ -211,6 +241,118 @@ DmaPort::queueDma(PacketPtr pkt)
     pendingCount++;
 }
 
+void
+DmaPort::queueBulkDma(Packet::Command cmd, const RequestPtr &req,
+                      uint8_t *data, Event *event, Tick delay)
+{
+    // transfers are serialised on the port, and all take the same
+    // latency, so they complete in the order they are queued
+    const Tick start = std::max(curTick(), bulkFreeAt);
+    bulkFreeAt = start + Tick(req->getSize() * bulkTicksPerByte);
+
+    BulkTransfer transfer;
+    transfer.req = req;
+    transfer.cmd = cmd;
+    transfer.data = data;
+    transfer.completionEvent = event;
+    transfer.delay = delay;
+    transfer.doneTick = bulkFreeAt + bulkLatency;
+
+    DPRINTF(DMA, "--Queuing bulk DMA for addr: %#x size: %d done: %d\n",
+            req->getPaddr(), req->getSize(), transfer.doneTick);
+
+    bulkList.push_back(transfer);
+    pendingCount++;
+
+    if (!bulkEvent.scheduled())
+        device->schedule(bulkEvent, transfer.doneTick);
+}
+
+void
+DmaPort::completeBulkDma()
+{
+    assert(!bulkList.empty());
+    const BulkTransfer &transfer = bulkList.front();
+
+    DPRINTF(DMA, "Completing bulk DMA for addr: %#x size: %d\n",
+            transfer.req->getPaddr(), transfer.req->getSize());
+
+    bulkAccess(transfer);
+
+    if (transfer.completionEvent) {
+        device->schedule(transfer.completionEvent,
+                         curTick() + transfer.delay);
+    }
+
+    bulkList.pop_front();
+    if (!bulkList.empty())
+        device->schedule(bulkEvent, bulkList.front().doneTick);
+
+    assert(pendingCount != 0);
+    pendingCount--;
+
+    // we might be drained at this point, if so signal the drain event
+    if (pendingCount == 0)
+        signalDrainDone();
+}
+
+void
+DmaPort::bulkAccess(const BulkTransfer &transfer)
+{
+    if (!transfer.data)
+        return;
+
+    const Addr addr = transfer.req->getPaddr();
+    const unsigned size = transfer.req->getSize();
+    const bool is_write = MemCmd(transfer.cmd).isWrite();
+
+    // atomic accesses cannot be mixed with the transactions in flight in
+    // a timing memory system, so fall back to functional accesses there
+    if (!bulkCoherent && sys->isAtomicMode()) {
+        // move cache line sized chunks with atomic accesses until the
+        // memory hands out a backdoor covering the rest of the transfer
+        for (ChunkGenerator gen(addr, size, sys->cacheLineSize());
+             !gen.done(); gen.next()) {
+            const AddrRange rest = RangeSize(gen.addr(),
+                                             size - gen.complete());
+            if (const MemBackdoor *backdoor = backdoors.find(rest,
+                                                             is_write)) {
+                uint8_t *host = backdoor->ptr() +
+                    (gen.addr() - backdoor->range().start());
+                if (is_write)
+                    std::memcpy(host, transfer.data + gen.complete(),
+                                rest.size());
+                else
+                    std::memcpy(transfer.data + gen.complete(), host,
+                                rest.size());
+                return;
+            }
+
+            auto req = std::make_shared<Request>(
+                gen.addr(), gen.size(), transfer.req->getFlags(),
+                requestorId);
+            Packet pkt(req, transfer.cmd);
+            pkt.dataStatic(transfer.data + gen.complete());
+            MemBackdoorPtr backdoor = nullptr;
+            sendAtomicBackdoor(&pkt, backdoor);
+            if (backdoor)
+                backdoors.insert(backdoor);
+        }
+        return;
+    }
+
+    // functional accesses only look up a single block in each cache, so
+    // split the transfer into cache lines
+    for (ChunkGenerator gen(addr, size, sys->cacheLineSize());
+         !gen.done(); gen.next()) {
+        auto req = std::make_shared<Request>(
+            gen.addr(), gen.size(), transfer.req->getFlags(), requestorId);
+        Packet pkt(req, transfer.cmd);
+        pkt.dataStatic(transfer.data + gen.complete());
+        sendFunctional(&pkt);
+    }
+}
+
 void
 DmaPort::trySendTimingReq()
 {
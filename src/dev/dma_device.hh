@@ -43,9 +43,11 @@
 
 #include <deque>
 #include <memory>
+#include <vector>
 
 #include "base/circlebuf.hh"
 #include "dev/io_device.hh"
+#include "mem/backdoor_cache.hh"
 #include "params/DmaDevice.hh"
 #include "sim/drain.hh"
 #include "sim/system.hh"
@@ -105,6 +107,52 @@ class DmaPort : public RequestPort, public Drainable
         {}
     };
 
+    /** A DMA transfer handled as a whole in bulk mode. */
+    struct BulkTransfer
+    {
+        /** The request covering the whole transfer. */
+        RequestPtr req;
+
+        Packet::Command cmd;
+
+        /** Data of the transfer, if any. */
+        uint8_t *data;
+
+        /** Event to call on the device when the transfer completes. */
+        Event *completionEvent;
+
+        /** Amount to delay completion of dma by */
+        Tick delay;
+
+        /** Tick at which the transfer completes. */
+        Tick doneTick;
+    };
+
+    /**
+     * Queue a transfer in bulk mode. Rather than splitting it into
+     * cache line sized packets, the transfer occupies the port for as
+     * long as the configured bandwidth dictates and completes after
+     * the configured latency.
+     */
+    void queueBulkDma(Packet::Command cmd, const RequestPtr &req,
+                      uint8_t *data, Event *event, Tick delay);
+
+    /**
+     * Complete the oldest bulk transfer: move its data and signal the
+     * completion event of the device.
+     */
+    void completeBulkDma();
+
+    /**
+     * Move the data of a bulk transfer. Without coherence, in an atomic
+     * mode system, the data is moved with cache line sized atomic
+     * accesses, and copied through a backdoor once the memory has handed
+     * out one covering the rest of the transfer. Otherwise, it is moved
+     * with cache line sized functional accesses, which keep the caches
+     * coherent.
+     */
+    void bulkAccess(const BulkTransfer &transfer);
+
   public:
     /** The device that owns this port. */
     ClockedObject *const device;
@@ -136,6 +184,30 @@ class DmaPort : public RequestPort, public Drainable
     /** Default substreamId */
     const uint32_t defaultSSid;
 
+    /** Transfers are handled in bulk rather than in packets. */
+    bool bulk;
+
+    /** Bulk mode bandwidth, in ticks per byte. */
+    double bulkTicksPerByte;
+
+    /** Bulk mode latency of a transfer. */
+    Tick bulkLatency;
+
+    /** Bulk transfers have to be coherent with the caches. */
+    bool bulkCoherent;
+
+    /** Tick at which the port is free for the next bulk transfer. */
+    Tick bulkFreeAt;
+
+    /** Bulk transfers in flight, in order of completion. */
+    std::deque<BulkTransfer> bulkList;
+
+    /** Event used to complete the oldest bulk transfer. */
+    EventFunctionWrapper bulkEvent;
+
+    /** Backdoors handed out by the memories. */
+    MemBackdoorCache backdoors;
+
   protected:
 
     bool recvTimingResp(PacketPtr pkt) override;
@@ -159,6 +231,16 @@ class DmaPort : public RequestPort, public Drainable
 
     bool dmaPending() const { return pendingCount > 0; }
 
+    /**
+     * Handle every transfer in bulk, timing it with a bandwidth and
+     * latency model instead of sending cache line sized packets.
+     *
+     * @param ticks_per_byte Bandwidth of the port
+     * @param latency Latency of each transfer
+     * @param coherent Keep the caches coherent with the transfers
+     */
+    void setBulkMode(double ticks_per_byte, Tick latency, bool coherent);
+
     DrainState drain() override;
 };
 
@@ -65,6 +65,15 @@ class DRAMInterface(MemInterface):
     # performance being lower when enabled
     enable_dram_powerdown = Param.Bool(False, "Enable powerdown states")
 
+    # Compute the latency of every access analytically when it arrives at
+    # the controller rather than scheduling the individual DRAM commands.
+    # Bank, bank group, activation window and data bus state are still
+    # tracked and the buffer sizes still apply, but the controller does not
+    # reorder requests and refresh is accounted for without any events.
+    # This is considerably faster than the detailed model and meant for
+    # runs where the memory is not the focus
+    analytical = Param.Bool(False, "Use the analytical timing model")
+
     # For power modelling we need to know if the DRAM has a DLL or not
     dll = Param.Bool(True, "DRAM has DLL or not")
 
@@ -137,8 +137,13 @@ class SnoopFilter(SimObject):
 
     system = Param.System(Parent.any, "System that the crossbar belongs to.")
 
-    # Sanity check on max capacity to track, adjust if needed.
+    # Capacity in terms of the cache lines tracked. With an associativity,
+    # an entry is evicted when its set is full and the line is invalidated
+    # in the caches above. Without one, exceeding the capacity is an error,
+    # adjust if needed.
     max_capacity = Param.MemorySize('8MB', "Maximum capacity of snoop filter")
+    assoc = Param.Unsigned(0, "Associativity of the snoop filter, 0 to "
+                           "never evict entries")
 
 # We use a coherent crossbar to connect multiple requestors to the L2
 # caches. Normally this crossbar would be part of the cache itself.
@@ -163,6 +168,20 @@ class L2XBar(CoherentXBar):
     # to the first level of unified cache.
     point_of_unification = True
 
+# Routes the requests of the private caches of one CPU to the slices of
+# a sliced L2 crossbar, each slice being an L2XBar that handles an
+# address-hashed part of the memory with its own layers and snoop
+# filter. The slices account for the latency and the contention, so
+# the router adds as little as possible.
+class L2SliceRouter(CoherentXBar):
+    # a full cache line per cycle
+    width = 64
+
+    frontend_latency = 0
+    forward_latency = 0
+    response_latency = 0
+    snoop_response_latency = 0
+
 # One of the key coherent crossbar instances is the system
 # interconnect, tying together the CPU clusters, GPUs, and any I/O
 # coherent requestors, and DRAM controllers.
@@ -266,6 +266,11 @@ AbstractMemory::trackLoadLocked(PacketPtr pkt)
         }
     }
 
+    // writes through a backdoor would not clear the lock, so take the
+    // backdoor away from its holders for as long as there are locks
+    if (lockedAddrList.empty() && backdoor.ptr())
+        backdoor.invalidate();
+
     // no record for this xc: need to allocate a new one
     DPRINTF(LLSC, "Adding lock record: context %d addr %#x\n",
             req->contextId(), paddr);
@@ -227,6 +227,20 @@ class AbstractMemory : public ClockedObject
      */
     void setBackingStore(uint8_t* pmem_addr);
 
+    /**
+     * Get the backdoor to this memory. There is none if the memory
+     * has no contiguous backing store, or while there are locked
+     * addresses, as writes through the backdoor would not clear them.
+     *
+     * @return The backdoor, or nullptr if there is none
+     */
+    MemBackdoorPtr
+    getBackdoor()
+    {
+        return backdoor.ptr() && lockedAddrList.empty() ? &backdoor :
+            nullptr;
+    }
+
     /**
      * Get the list of locked addresses to allow checkpointing.
      */
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2020 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "mem/backdoor_cache.hh"
+
+#include "base/trace.hh"
+#include "debug/Backdoor.hh"
+
+void
+MemBackdoorCache::insert(MemBackdoorPtr backdoor)
+{
+    assert(backdoor && backdoor->ptr());
+
+    if (backdoors.intersects(backdoor->range()) != backdoors.end())
+        return;
+
+    DPRINTF(Backdoor, "Caching backdoor for %s\n",
+            backdoor->range().to_string());
+
+    backdoors.insert(backdoor->range(), backdoor);
+    backdoor->addInvalidationCallback(
+        [this](const MemBackdoor &bd) { invalidate(bd); });
+}
+
+const MemBackdoor *
+MemBackdoorCache::find(const AddrRange &range, bool write) const
+{
+    auto it = backdoors.contains(range);
+    if (it == backdoors.end())
+        return nullptr;
+
+    const MemBackdoor *backdoor = it->second;
+    if (write ? !backdoor->writeable() : !backdoor->readable())
+        return nullptr;
+
+    return backdoor;
+}
+
+bool
+MemBackdoorCache::access(PacketPtr pkt) const
+{
+    if (pkt->cmd != MemCmd::ReadReq && pkt->cmd != MemCmd::WriteReq)
+        return false;
+
+    if (pkt->req->isUncacheable() || pkt->isMaskedWrite())
+        return false;
+
+    const MemBackdoor *backdoor = find(pkt->getAddrRange(), pkt->isWrite());
+    if (!backdoor)
+        return false;
+
+    uint8_t *host = backdoor->ptr() +
+        (pkt->getAddr() - backdoor->range().start());
+    if (pkt->isRead())
+        pkt->setData(host);
+    else
+        pkt->writeData(host);
+
+    pkt->makeResponse();
+    return true;
+}
+
+void
+MemBackdoorCache::invalidate(const MemBackdoor &backdoor)
+{
+    // the backdoor may have been forgotten already
+    auto it = backdoors.contains(backdoor.range());
+    if (it == backdoors.end() || it->second != &backdoor)
+        return;
+
+    DPRINTF(Backdoor, "Dropping backdoor for %s\n",
+            backdoor.range().to_string());
+
+    backdoors.erase(it);
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2020 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * @file
+ * A cache of the memory backdoors handed out to a requestor.
+ *
+ * A requestor accessing memory in atomic mode can ask for a backdoor along
+ * with an access, and serve the later accesses to the same range with a
+ * plain copy rather than a packet round trip through the memory system.
+ * The backdoors are forgotten as soon as the memory invalidates them.
+ */
+
+#ifndef __MEM_BACKDOOR_CACHE_HH__
+#define __MEM_BACKDOOR_CACHE_HH__
+
+#include "base/addr_range_map.hh"
+#include "mem/backdoor.hh"
+#include "mem/packet.hh"
+
+class MemBackdoorCache
+{
+  public:
+    MemBackdoorCache() {}
+
+    /**
+     * Remember a backdoor, unless a backdoor overlapping its range is
+     * already known.
+     *
+     * @param backdoor Backdoor handed out by a memory
+     */
+    void insert(MemBackdoorPtr backdoor);
+
+    /**
+     * Find a backdoor covering a range.
+     *
+     * @param range Range to access
+     * @param write The access is a write
+     * @return The backdoor, nullptr if there is none allowing the access
+     */
+    const MemBackdoor *find(const AddrRange &range, bool write) const;
+
+    /**
+     * Serve a packet through a backdoor. Only plain reads and writes of
+     * cacheable memory are served, anything else (e.g., LL/SC, atomic
+     * or uncacheable accesses) has to go through the memory system.
+     *
+     * @param pkt Packet to serve, turned into a response if served
+     * @return true if the packet has been served
+     */
+    bool access(PacketPtr pkt) const;
+
+    /** Forget all the backdoors. */
+    void clear() { backdoors.clear(); }
+
+    bool empty() const { return backdoors.empty(); }
+
+  private:
+    /** Forget a backdoor invalidated by its memory. */
+    void invalidate(const MemBackdoor &backdoor);
+
+    AddrRangeMap<MemBackdoorPtr> backdoors;
+};
+
+#endif // __MEM_BACKDOOR_CACHE_HH__
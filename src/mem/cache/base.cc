@@ -1429,8 +1429,7 @@ BaseCache::allocateBlock(const PacketPtr pkt, PacketList &writebacks)
 
     // Find replacement victim
     std::vector<CacheBlk*> evict_blks;
-    Stats::VResult miss_rate;
-    stats.overallMissRate.result(miss_rate);
+    const Stats::VResult &miss_rate = stats.overallMissRate.result();
     CacheBlk *victim = tags->findVictim(addr, is_secure, blk_size_bits,
                                         evict_blks, pkt, miss_rate);
 
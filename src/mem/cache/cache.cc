@@ -1265,9 +1265,13 @@ Cache::recvTimingSnoopReq(PacketPtr pkt)
         // this cache, so the behaviour is modelled after handleSnoop,
         // the difference being that instead of querying the block
         // state to determine if it is dirty and writable, we use the
-        // command and fields of the writeback packet
+        // command and fields of the writeback packet. Nobody responds
+        // to the back-invalidations of a snoop filter, maintenance
+        // operations without a destination, so leave it to the
+        // writeback to clean the line below
+        bool back_invalidate = pkt->isClean() && !pkt->req->getDest();
         bool respond = wb_pkt->cmd == MemCmd::WritebackDirty &&
-            pkt->needsResponse();
+            pkt->needsResponse() && !back_invalidate;
         bool have_writable = !wb_pkt->hasSharers();
         bool invalidate = pkt->isInvalidate();
 
@@ -1288,7 +1292,8 @@ Cache::recvTimingSnoopReq(PacketPtr pkt)
                                    false, false);
         }
 
-        if (invalidate && wb_pkt->cmd != MemCmd::WriteClean) {
+        if (invalidate && wb_pkt->cmd != MemCmd::WriteClean &&
+            !back_invalidate) {
             // Invalidation trumps our writeback... discard here
             // Note: markInService will remove entry from writeback buffer.
             markInService(wb_entry);
@@ -287,7 +287,7 @@ class BaseTags : public ClockedObject
                                  const std::size_t size,
                                  std::vector<CacheBlk*>& evict_blks,
                                  const PacketPtr pkt,
-                                 Stats::VResult miss_rate) = 0;
+                                 const Stats::VResult &miss_rate) = 0;
 
     /**
      * Access block and update replacement data. May not succeed, in which case
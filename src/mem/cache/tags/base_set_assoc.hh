@@ -168,7 +168,7 @@ class BaseSetAssoc : public BaseTags
                          const std::size_t size,
                          std::vector<CacheBlk*>& evict_blks,
                          const PacketPtr pkt,
-                         Stats::VResult miss_rate) override
+                         const Stats::VResult &miss_rate) override
     {
         // Get possible entries to be victimized
         const std::vector<ReplaceableEntry*> entries =
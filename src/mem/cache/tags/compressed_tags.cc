@@ -103,7 +103,7 @@ CompressedTags::findVictim(Addr addr, const bool is_secure,
                            const std::size_t compressed_size,
                            std::vector<CacheBlk*>& evict_blks,
                            const PacketPtr pkt,
-                           Stats::VResult miss_rate)
+                           const Stats::VResult &miss_rate)
 {
     // Get all possible locations of this superblock
     const std::vector<ReplaceableEntry*> superblock_entries =
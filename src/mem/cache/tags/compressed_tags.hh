@@ -109,7 +109,7 @@ class CompressedTags : public SectorTags
                          const std::size_t compressed_size,
                          std::vector<CacheBlk*>& evict_blks,
                          const PacketPtr pkt,
-                         Stats::VResult miss_rate) override;
+                         const Stats::VResult &miss_rate) override;
 
     /**
      * Insert the new block into the cache and update replacement data.
@@ -178,7 +178,7 @@ class DSCPTags : public BaseTags
     }
 
     //TEMP
-    int unbalanced(const PacketPtr pkt, Stats::VResult miss_rate) {
+    int unbalanced(const PacketPtr pkt, const Stats::VResult &miss_rate) {
         if (std::isnan(miss_rate[pkt->requestorId()]) ||
             miss_rate[pkt->requestorId()] < 0.25 ||
             stats.contributions.size() <= 0) // 1 / valid_requestor.size
@@ -213,7 +213,7 @@ class DSCPTags : public BaseTags
                          const std::size_t size,
                          std::vector<CacheBlk*>& evict_blks,
                          const PacketPtr pkt,
-                         Stats::VResult miss_rate) override
+                         const Stats::VResult &miss_rate) override
     {
         // Lookup PLC
         int secId = indexingPolicy->plc->getSector(addr);
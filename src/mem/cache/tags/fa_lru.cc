@@ -194,7 +194,7 @@ FALRU::findBlockBySetAndWay(int set, int way) const
 CacheBlk*
 FALRU::findVictim(Addr addr, const bool is_secure, const std::size_t size,
                   std::vector<CacheBlk*>& evict_blks, const PacketPtr pkt,
-                  Stats::VResult miss_rate)
+                  const Stats::VResult &miss_rate)
 {
     // The victim is always stored on the tail for the FALRU
     FALRUBlk* victim = tail;
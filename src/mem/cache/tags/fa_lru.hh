@@ -225,7 +225,7 @@ class FALRU : public BaseTags
                          const std::size_t size,
                          std::vector<CacheBlk*>& evict_blks,
                          const PacketPtr pkt,
-                         Stats::VResult miss_rate) override;
+                         const Stats::VResult &miss_rate) override;
 
     /**
      * Insert the new block into the cache and update replacement data.
@@ -321,7 +321,7 @@ class BaseIndexingPolicy : public SimObject
      */
     virtual int getVictimSector(const PacketPtr pkt, Stats::Vector& contrs,
                                 Stats::Scalar& totalContr,
-                                Stats::VResult miss_rate) const
+                                const Stats::VResult &miss_rate) const
     {
         return -1;
     }
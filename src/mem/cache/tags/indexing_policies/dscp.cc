@@ -165,7 +165,7 @@ void DSCP::getSectorSets(int secId, unsigned addrField,
 }
 
 int DSCP::getVictimSector(const PacketPtr pkt, Stats::Vector& contributions,
-    Stats::Scalar& totalContribution, Stats::VResult miss_rate) const
+    Stats::Scalar& totalContribution, const Stats::VResult &miss_rate) const
 {
     //TEMP
     double minContr = contributions[0].value();
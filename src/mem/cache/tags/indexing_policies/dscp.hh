@@ -143,7 +143,7 @@ class DSCP : public BaseIndexingPolicy
      */
     int getVictimSector(const PacketPtr pkt, Stats::Vector& contrs,
                         Stats::Scalar& totalContr,
-                        Stats::VResult miss_rate) const override;
+                        const Stats::VResult &miss_rate) const override;
 
     /**
      * Find all possible entries for insertion and replacement of an address.
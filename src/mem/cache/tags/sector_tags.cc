@@ -223,7 +223,7 @@ SectorTags::findBlock(Addr addr, bool is_secure) const
 CacheBlk*
 SectorTags::findVictim(Addr addr, const bool is_secure, const std::size_t size,
                        std::vector<CacheBlk*>& evict_blks,
-                       const PacketPtr pkt, Stats::VResult miss_rate)
+                       const PacketPtr pkt, const Stats::VResult &miss_rate)
 {
     // Get possible entries to be victimized
     const std::vector<ReplaceableEntry*> sector_entries =
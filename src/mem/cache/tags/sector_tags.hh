@@ -171,7 +171,7 @@ class SectorTags : public BaseTags
                          const std::size_t size,
                          std::vector<CacheBlk*>& evict_blks,
                          const PacketPtr pkt,
-                         Stats::VResult miss_rate) override;
+                         const Stats::VResult &miss_rate) override;
 
     /**
      * Calculate a block's offset in a sector from the address.
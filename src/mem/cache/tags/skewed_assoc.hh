@@ -176,7 +176,7 @@ class SkewedAssoc : public BaseTags
                          const std::size_t size,
                          std::vector<CacheBlk*>& evict_blks,
                          const PacketPtr pkt,
-                         Stats::VResult miss_rate) override
+                         const Stats::VResult &miss_rate) override
     {
         // Get possible entries to be victimized
         const std::vector<ReplaceableEntry*> entries =
@@ -63,6 +63,10 @@ CoherentXBar::CoherentXBar(const CoherentXBarParams *p)
       snoopTraffic(this, "snoopTraffic", "Total snoop traffic (bytes)"),
       snoopFanout(this, "snoop_fanout", "Request fanout histogram")
 {
+    backInvalidateRequestorId = snoopFilter ?
+        system->getRequestorId(this, "back_invalidate") :
+        Request::invldRequestorId;
+
     // create the ports based on the size of the memory-side port and
     // CPU-side port vector ports, and the presence of the default port,
     // the ports are enumerated starting from zero
@@ -300,6 +304,9 @@ CoherentXBar::recvTimingReq(PacketPtr pkt, PortID cpu_side_port_id)
     if (snoopFilter && snoop_caches) {
         // Let the snoop filter know about the success of the send operation
         snoopFilter->finishRequest(!success, addr, pkt->isSecure());
+
+        if (snoopFilter->needsBackInvalidation())
+            backInvalidate(true);
     }
 
     // check if we were successful in sending the packet onwards
@@ -768,6 +775,9 @@ CoherentXBar::recvAtomicBackdoor(PacketPtr pkt, PortID cpu_side_port_id,
             // between and change the filter state
             snoopFilter->finishRequest(false, pkt->getAddr(), pkt->isSecure());
 
+            if (snoopFilter->needsBackInvalidation())
+                backInvalidate(false);
+
             if (pkt->isEviction()) {
                 // for block-evicting packets, i.e. writebacks and
                 // clean evictions, there is no need to snoop up, as
@@ -1109,6 +1119,33 @@ CoherentXBar::forwardPacket(const PacketPtr pkt)
     return pkt->isRead() || pkt->isWrite() || !pointOfCoherency;
 }
 
+void
+CoherentXBar::backInvalidate(bool timing)
+{
+    for (const auto& inv : snoopFilter->takeBackInvalidations()) {
+        Request::Flags flags = Request::CLEAN | Request::INVALIDATE;
+        if (inv.isSecure)
+            flags.set(Request::SECURE);
+        RequestPtr req = std::make_shared<Request>(
+            inv.addr, system->cacheLineSize(), flags,
+            backInvalidateRequestorId);
+        Packet pkt(req, MemCmd::CleanInvalidReq);
+
+        DPRINTF(CoherentXBar, "%s: %s to %d ports\n", __func__,
+                pkt.print(), inv.ports.size());
+
+        if (timing) {
+            forwardTiming(&pkt, InvalidPortID, inv.ports);
+        } else {
+            for (const auto& p : inv.ports)
+                p->sendAtomicSnoop(&pkt);
+            snoopFanout.sample(inv.ports.size());
+        }
+
+        // without a destination nobody takes the operation on
+        assert(!pkt.cacheResponding());
+    }
+}
 
 void
 CoherentXBar::regStats()
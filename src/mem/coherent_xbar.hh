@@ -274,6 +274,9 @@ class CoherentXBar : public BaseXBar
       * broadcast needed for probes.  NULL denotes an absent filter. */
     SnoopFilter *snoopFilter;
 
+    /** Requestor ID used for the back-invalidations of the snoop filter */
+    RequestorID backInvalidateRequestorId;
+
     /** Cycles of snoop response latency.*/
     const Cycles snoopResponseLatency;
 
@@ -397,6 +400,17 @@ class CoherentXBar : public BaseXBar
      */
     bool forwardPacket(const PacketPtr pkt);
 
+    /**
+     * Invalidate the lines the snoop filter evicted in the caches
+     * above that hold them. The invalidations are cache clean and
+     * invalidate operations without a destination, so that the caches
+     * write any dirty data back to the memory below them, and nobody
+     * responds.
+     *
+     * @param timing Send timing rather than atomic snoops
+     */
+    void backInvalidate(bool timing);
+
     /**
      * Determine if the packet's destination is the memory below
      *
@@ -51,12 +51,55 @@
 
 using namespace std;
 
+void
+MemPacketQueue::push_back(MemPacket* mem_pkt)
+{
+    iterator it = packets.insert(packets.end(), mem_pkt);
+
+    if (mem_pkt->isDram()) {
+        BankEntries& bank = bankIndex[mem_pkt->bankId];
+        bank.rows[mem_pkt->row].push_back(Entry{nextSeq, it});
+        bank.count++;
+    }
+    nextSeq++;
+}
+
+MemPacketQueue::iterator
+MemPacketQueue::erase(iterator it)
+{
+    MemPacket* mem_pkt = *it;
+
+    if (mem_pkt->isDram()) {
+        auto bank = bankIndex.find(mem_pkt->bankId);
+        assert(bank != bankIndex.end());
+        auto row = bank->second.rows.find(mem_pkt->row);
+        assert(row != bank->second.rows.end());
+
+        // packets are mostly removed from the front of their row
+        std::deque<Entry>& entries = row->second;
+        auto entry = entries.begin();
+        while (entry->it != it) {
+            ++entry;
+            assert(entry != entries.end());
+        }
+        entries.erase(entry);
+
+        if (entries.empty())
+            bank->second.rows.erase(row);
+        if (--bank->second.count == 0)
+            bankIndex.erase(bank);
+    }
+
+    return packets.erase(it);
+}
+
 MemCtrl::MemCtrl(const MemCtrlParams* p) :
     QoS::MemCtrl(p),
-    port(name() + ".port", *this), isTimingMode(false),
+    port(name() + ".port", *this), respPort(&port), isTimingMode(false),
     retryRdReq(false), retryWrReq(false),
     nextReqEvent([this]{ processNextReqEvent(); }, name()),
     respondEvent([this]{ processRespondEvent(); }, name()),
+    analyticalRetryEvent([this]{ retryAdmission(); }, name()),
     dram(p->dram), nvm(p->nvm),
     readBufferSize((dram ? dram->readBufferSize : 0) +
                    (nvm ? nvm->readBufferSize : 0)),
@@ -85,6 +128,9 @@ MemCtrl::MemCtrl(const MemCtrlParams* p) :
         nvm->setCtrl(this, commandWindow);
 
     fatal_if(!dram && !nvm, "Memory controller must have an interface");
+    fatal_if(dram && nvm && dram->isAnalytical(), "Memory controller %s "
+             "does not support the analytical DRAM model together with "
+             "an NVM interface\n", name());
 
     // perform a basic check of the write thresholds
     if (p->write_low_thresh_perc >= p->write_high_thresh_perc)
@@ -96,7 +142,12 @@ MemCtrl::MemCtrl(const MemCtrlParams* p) :
 void
 MemCtrl::init()
 {
-   if (!port.isConnected()) {
+    if (respPort != &port) {
+        // requests arrive through a multi-channel controller
+        fatal_if(port.isConnected(), "MemCtrl %s is a channel of a "
+                 "multi-channel controller and must not be connected!\n",
+                 name());
+    } else if (!port.isConnected()) {
         fatal("MemCtrl %s is unconnected!\n", name());
     } else {
         port.sendRangeChange();
@@ -154,6 +205,21 @@ MemCtrl::recvAtomic(PacketPtr pkt)
     return latency;
 }
 
+Tick
+MemCtrl::recvAtomicBackdoor(PacketPtr pkt, MemBackdoorPtr &backdoor)
+{
+    Tick latency = recvAtomic(pkt);
+
+    // hand out the backdoor of the interface the packet went to, the
+    // interface invalidates it if its backing store changes or while
+    // it has locked addresses
+    AbstractMemory *mem = dram && dram->getAddrRange().contains(
+        pkt->getAddr()) ? static_cast<AbstractMemory *>(dram) : nvm;
+    if (MemBackdoorPtr bd = mem->getBackdoor())
+        backdoor = bd;
+    return latency;
+}
+
 bool
 MemCtrl::readQueueFull(unsigned int neededEntries) const
 {
@@ -212,25 +278,22 @@ MemCtrl::addToReadQueue(PacketPtr pkt, unsigned int pkt_count, bool is_dram)
         Addr burst_addr = burstAlign(addr, is_dram);
         // if the burst address is not present then there is no need
         // looking any further
-        if (isInWriteQueue.find(burst_addr) != isInWriteQueue.end()) {
-            for (const auto& vec : writeQueue) {
-                for (const auto& p : vec) {
-                    // check if the read is subsumed in the write queue
-                    // packet we are looking at
-                    if (p->addr <= addr &&
-                       ((addr + size) <= (p->addr + p->size))) {
-
-                        foundInWrQ = true;
-                        stats.servicedByWrQ++;
-                        pktsServicedByWrQ++;
-                        DPRINTF(MemCtrl,
-                                "Read to addr %lld with size %d serviced by "
-                                "write queue\n",
-                                addr, size);
-                        stats.bytesReadWrQ += burst_size;
-                        break;
-                    }
-                }
+        auto wr_burst = writeQueueBursts.find(burst_addr);
+        if (wr_burst != writeQueueBursts.end()) {
+            const MemPacket* p = wr_burst->second;
+            // check if the read is subsumed in the write queue
+            // packet we are looking at
+            if (p->addr <= addr &&
+               ((addr + size) <= (p->addr + p->size))) {
+
+                foundInWrQ = true;
+                stats.servicedByWrQ++;
+                pktsServicedByWrQ++;
+                DPRINTF(MemCtrl,
+                        "Read to addr %lld with size %d serviced by "
+                        "write queue\n",
+                        addr, size);
+                stats.bytesReadWrQ += burst_size;
             }
         }
 
@@ -318,8 +381,8 @@ MemCtrl::addToWriteQueue(PacketPtr pkt, unsigned int pkt_count, bool is_dram)
 
         // see if we can merge with an existing item in the write
         // queue and keep track of whether we have merged or not
-        bool merged = isInWriteQueue.find(burstAlign(addr, is_dram)) !=
-            isInWriteQueue.end();
+        bool merged = writeQueueBursts.find(burstAlign(addr, is_dram)) !=
+            writeQueueBursts.end();
 
         // if the item was not merged we need to create a new write
         // and enqueue it
@@ -338,13 +401,13 @@ MemCtrl::addToWriteQueue(PacketPtr pkt, unsigned int pkt_count, bool is_dram)
             DPRINTF(MemCtrl, "Adding to write queue\n");
 
             writeQueue[mem_pkt->qosValue()].push_back(mem_pkt);
-            isInWriteQueue.insert(burstAlign(addr, is_dram));
+            writeQueueBursts[burstAlign(addr, is_dram)] = mem_pkt;
 
             // log packet
             logRequest(MemCtrl::WRITE, pkt->requestorId(), pkt->qosValue(),
                        mem_pkt->addr, 1);
 
-            assert(totalWriteQueueSize == isInWriteQueue.size());
+            assert(totalWriteQueueSize == writeQueueBursts.size());
 
             // Update stats
             stats.avgWrQLen = totalWriteQueueSize;
@@ -421,6 +484,20 @@ MemCtrl::recvTimingReq(PacketPtr pkt)
     }
     prevArrival = curTick();
 
+    // hold back requestors above their bandwidth limit
+    if (!admit(pkt)) {
+        DPRINTF(MemCtrl, "Requestor over its bandwidth limit, "
+                "not accepting\n");
+        if (pkt->isWrite()) {
+            retryWrReq = true;
+            stats.numWrRetry++;
+        } else {
+            retryRdReq = true;
+            stats.numRdRetry++;
+        }
+        return false;
+    }
+
     // What type of media does this packet access?
     bool is_dram;
     if (dram && dram->getAddrRange().contains(pkt->getAddr())) {
@@ -443,10 +520,12 @@ MemCtrl::recvTimingReq(PacketPtr pkt)
     unsigned offset = pkt->getAddr() & (burst_size - 1);
     unsigned int pkt_count = divCeil(offset + size, burst_size);
 
-    // run the QoS scheduler and assign a QoS priority value to the packet
-    qosSchedule( { &readQueue, &writeQueue }, burst_size, pkt);
+    // with the analytical model the request is never queued
+    if (is_dram && dram->isAnalytical())
+        return analyticalAccess(pkt, pkt_count);
 
-    // check local buffers and do not accept if full
+    // check local buffers and do not accept if full, then run the QoS
+    // scheduler and assign a QoS priority value to the packet
     if (pkt->isWrite()) {
         assert(size != 0);
         if (writeQueueFull(pkt_count)) {
@@ -456,6 +535,7 @@ MemCtrl::recvTimingReq(PacketPtr pkt)
             stats.numWrRetry++;
             return false;
         } else {
+            qosSchedule( { &readQueue, &writeQueue }, burst_size, pkt);
             addToWriteQueue(pkt, pkt_count, is_dram);
             stats.writeReqs++;
             stats.bytesWrittenSys += size;
@@ -470,6 +550,7 @@ MemCtrl::recvTimingReq(PacketPtr pkt)
             stats.numRdRetry++;
             return false;
         } else {
+            qosSchedule( { &readQueue, &writeQueue }, burst_size, pkt);
             addToReadQueue(pkt, pkt_count, is_dram);
             stats.readReqs++;
             stats.bytesReadSys += size;
@@ -479,6 +560,99 @@ MemCtrl::recvTimingReq(PacketPtr pkt)
     return true;
 }
 
+bool
+MemCtrl::analyticalAccess(PacketPtr pkt, unsigned int pkt_count)
+{
+    assert(pkt_count != 0);
+
+    const bool is_read = pkt->isRead();
+
+    // bursts occupy the read buffer until their response is sent and
+    // the write buffer until they are written, so apply the buffer
+    // sizes to the bursts that have not completed yet
+    AnalyticalBursts& bursts = is_read ? analyticalReads : analyticalWrites;
+    while (!bursts.empty() && bursts.top() <= curTick())
+        bursts.pop();
+    if (!bursts.empty() && bursts.size() + pkt_count >
+        (is_read ? readBufferSize : writeBufferSize)) {
+        DPRINTF(MemCtrl, "%s buffer full, not accepting\n",
+                is_read ? "Read" : "Write");
+        if (is_read) {
+            retryRdReq = true;
+            stats.numRdRetry++;
+        } else {
+            retryWrReq = true;
+            stats.numWrRetry++;
+        }
+        // retry when the oldest burst has left the buffer
+        if (!analyticalRetryEvent.scheduled())
+            schedule(analyticalRetryEvent, bursts.top());
+        else if (analyticalRetryEvent.when() > bursts.top())
+            reschedule(analyticalRetryEvent, bursts.top());
+        return false;
+    }
+
+    const Addr base_addr = pkt->getAddr();
+    const uint32_t burst_size = dram->bytesPerBurst();
+    Addr addr = base_addr;
+    Tick ready = curTick();
+
+    // split the request into bursts as for the queues, and let the
+    // interface work out when each of them completes
+    for (int cnt = 0; cnt < pkt_count; ++cnt) {
+        unsigned size = std::min((addr | (burst_size - 1)) + 1,
+                        base_addr + pkt->getSize()) - addr;
+        if (is_read) {
+            stats.readPktSize[ceilLog2(size)]++;
+            stats.readBursts++;
+            stats.requestorReadAccesses[pkt->requestorId()]++;
+        } else {
+            stats.writePktSize[ceilLog2(size)]++;
+            stats.writeBursts++;
+            stats.requestorWriteAccesses[pkt->requestorId()]++;
+        }
+
+        MemPacket* mem_pkt = dram->decodePacket(pkt, addr, size, is_read,
+                                                true);
+        Tick burst_ready = dram->analyticalBurst(mem_pkt);
+        ready = std::max(ready, burst_ready);
+        delete mem_pkt;
+
+        if (!is_read)
+            bursts.push(burst_ready);
+
+        // Starting address of next memory pkt (aligned to burst boundary)
+        addr = (addr | (burst_size - 1)) + 1;
+    }
+
+    if (is_read) {
+        stats.readReqs++;
+        stats.bytesReadSys += pkt->getSize();
+        stats.requestorReadBytes[pkt->requestorId()] += pkt->getSize();
+        stats.requestorReadTotalLat[pkt->requestorId()] +=
+            ready - curTick();
+
+        // respond once the last burst has been transferred
+        Tick resp_lat = ready - curTick() + frontendLatency + backendLatency;
+        for (int cnt = 0; cnt < pkt_count; ++cnt)
+            bursts.push(curTick() + resp_lat);
+        accessAndRespond(pkt, resp_lat);
+    } else {
+        stats.writeReqs++;
+        stats.bytesWrittenSys += pkt->getSize();
+        stats.requestorWriteBytes[pkt->requestorId()] += pkt->getSize();
+        stats.requestorWriteTotalLat[pkt->requestorId()] +=
+            ready - curTick();
+
+        // writes are acknowledged straight away, as if they had been
+        // put in the write queue, but the bursts still occupy the banks
+        // and the bus
+        accessAndRespond(pkt, frontendLatency);
+    }
+
+    return true;
+}
+
 void
 MemCtrl::processRespondEvent()
 {
@@ -537,7 +711,17 @@ MemCtrl::processRespondEvent()
     // so if there is a read that was forced to wait, retry now
     if (retryRdReq) {
         retryRdReq = false;
-        port.sendRetryReq();
+        respPort->sendRetryReq();
+    }
+}
+
+void
+MemCtrl::retryAdmission()
+{
+    if (retryRdReq || retryWrReq) {
+        retryRdReq = false;
+        retryWrReq = false;
+        respPort->sendRetryReq();
     }
 }
 
@@ -650,7 +834,7 @@ MemCtrl::accessAndRespond(PacketPtr pkt, Tick static_latency)
 
         // queue the packet in the response queue to be sent out after
         // the static latency has passed
-        port.schedTimingResp(pkt, response_time);
+        respPort->schedTimingResp(pkt, response_time);
     } else {
         // @todo the packet is going to be deleted, and the MemPacket
         // is still having a pointer to it
@@ -1087,7 +1271,7 @@ MemCtrl::processNextReqEvent()
 
         doBurstAccess(mem_pkt);
 
-        isInWriteQueue.erase(burstAlign(mem_pkt->addr, mem_pkt->isDram()));
+        writeQueueBursts.erase(burstAlign(mem_pkt->addr, mem_pkt->isDram()));
 
         // log the response
         logResponse(MemCtrl::WRITE, mem_pkt->requestorId(),
@@ -1135,7 +1319,7 @@ MemCtrl::processNextReqEvent()
     // the next request processing
     if (retryWrReq && totalWriteQueueSize < writeBufferSize) {
         retryWrReq = false;
-        port.sendRetryReq();
+        respPort->sendRetryReq();
     }
 }
 
@@ -1461,6 +1645,13 @@ MemCtrl::MemoryPort::recvAtomic(PacketPtr pkt)
     return ctrl.recvAtomic(pkt);
 }
 
+Tick
+MemCtrl::MemoryPort::recvAtomicBackdoor(
+        PacketPtr pkt, MemBackdoorPtr &backdoor)
+{
+    return ctrl.recvAtomicBackdoor(pkt, backdoor);
+}
+
 bool
 MemCtrl::MemoryPort::recvTimingReq(PacketPtr pkt)
 {
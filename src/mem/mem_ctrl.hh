@@ -46,9 +46,13 @@
 #ifndef __MEM_CTRL_HH__
 #define __MEM_CTRL_HH__
 
+#include <cstdint>
 #include <deque>
+#include <functional>
+#include <list>
+#include <queue>
 #include <string>
-#include <unordered_set>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -61,6 +65,7 @@
 #include "sim/eventq.hh"
 
 class DRAMInterface;
+class MultiChannelMemCtrl;
 class NVMInterface;
 
 /**
@@ -205,9 +210,68 @@ class MemPacket
 
 };
 
-// The memory packets are store in a multiple dequeue structure,
-// based on their QoS priority
-typedef std::deque<MemPacket*> MemPacketQueue;
+/**
+ * A queue of memory packets in arrival (FCFS) order. Alongside the
+ * queue order, the DRAM packets are indexed by bank and row, so that the
+ * scheduler can find the oldest row hit or miss for a bank without
+ * walking the whole queue. The controller keeps one queue per QoS
+ * priority.
+ */
+class MemPacketQueue
+{
+  public:
+    typedef std::list<MemPacket*>::iterator iterator;
+    typedef std::list<MemPacket*>::const_iterator const_iterator;
+
+    /** A queued packet and its position in queue order. */
+    struct Entry
+    {
+        /** Larger for packets that were added to the queue later */
+        uint64_t seq;
+        iterator it;
+    };
+
+    /** The DRAM packets queued for a bank, bucketed by row. */
+    struct BankEntries
+    {
+        /** Number of packets queued for the bank */
+        unsigned count = 0;
+
+        /** Packets to each row, oldest first */
+        std::unordered_map<uint32_t, std::deque<Entry>> rows;
+    };
+
+    /** Banks with queued DRAM packets, indexed by MemPacket::bankId */
+    typedef std::unordered_map<uint16_t, BankEntries> BankIndex;
+
+    MemPacketQueue() : nextSeq(0) { }
+
+    iterator begin() { return packets.begin(); }
+    iterator end() { return packets.end(); }
+    const_iterator begin() const { return packets.begin(); }
+    const_iterator end() const { return packets.end(); }
+
+    bool empty() const { return packets.empty(); }
+    size_t size() const { return packets.size(); }
+
+    /** Add a packet to the back of the queue. */
+    void push_back(MemPacket* mem_pkt);
+
+    /**
+     * Remove a packet from the queue.
+     *
+     * @return Iterator to the packet following the removed one
+     */
+    iterator erase(iterator it);
+
+    /** Banks with queued DRAM packets */
+    const BankIndex& dramBanks() const { return bankIndex; }
+
+  private:
+    std::list<MemPacket*> packets;
+    BankIndex bankIndex;
+    uint64_t nextSeq;
+};
 
 
 /**
@@ -235,6 +299,8 @@ typedef std::deque<MemPacket*> MemPacketQueue;
  */
 class MemCtrl : public QoS::MemCtrl
 {
+    friend class MultiChannelMemCtrl;
+
   private:
 
     // For now, make use of a queued response port to avoid dealing with
@@ -252,6 +318,8 @@ class MemCtrl : public QoS::MemCtrl
       protected:
 
         Tick recvAtomic(PacketPtr pkt);
+        Tick recvAtomicBackdoor(
+                PacketPtr pkt, MemBackdoorPtr &backdoor) override;
 
         void recvFunctional(PacketPtr pkt);
 
@@ -267,6 +335,12 @@ class MemCtrl : public QoS::MemCtrl
      */
     MemoryPort port;
 
+    /**
+     * Port responses and retries are sent through. This is our own
+     * port, unless the controller is a channel of a MultiChannelMemCtrl.
+     */
+    QueuedResponsePort* respPort;
+
     /**
      * Remember if the memory system is in timing mode
      */
@@ -290,6 +364,8 @@ class MemCtrl : public QoS::MemCtrl
     void processRespondEvent();
     EventFunctionWrapper respondEvent;
 
+    void retryAdmission() override;
+
     /**
      * Check if the read queue has room for more entries
      *
@@ -337,6 +413,32 @@ class MemCtrl : public QoS::MemCtrl
      */
     void addToWriteQueue(PacketPtr pkt, unsigned int pkt_count, bool is_dram);
 
+    /**
+     * Service a DRAM request with the analytical timing model. The
+     * latency of every burst is determined straight away from the
+     * state of the banks and the data bus, the memory is accessed and
+     * the response is scheduled without the packet ever entering the
+     * read or write queue. The request is still rejected if the bursts
+     * that have not completed yet fill the read or write buffer.
+     *
+     * @param pkt The request packet from the outside world
+     * @param pkt_count The number of memory bursts the pkt translates to
+     * @return true if the request was accepted
+     */
+    bool analyticalAccess(PacketPtr pkt, unsigned int pkt_count);
+
+    /**
+     * Completion ticks of the reads and writes accepted by the
+     * analytical model that still occupy the read or write buffer,
+     * earliest first, and the event to retry a rejected request when
+     * the earliest one completes.
+     */
+    typedef std::priority_queue<Tick, std::vector<Tick>,
+                                std::greater<Tick>> AnalyticalBursts;
+    AnalyticalBursts analyticalReads;
+    AnalyticalBursts analyticalWrites;
+    EventFunctionWrapper analyticalRetryEvent;
+
     /**
      * Actually do the burst based on media specific access function.
      * Update bus statistics when complete.
@@ -434,12 +536,12 @@ class MemCtrl : public QoS::MemCtrl
 
     /**
      * To avoid iterating over the write queue to check for
-     * overlapping transactions, maintain a set of burst addresses
-     * that are currently queued. Since we merge writes to the same
-     * location we never have more than one address to the same burst
-     * address.
+     * overlapping transactions, map the burst addresses that are
+     * currently queued to their packet. Since we merge writes to the
+     * same location we never have more than one packet to the same
+     * burst address.
      */
-    std::unordered_set<Addr> isInWriteQueue;
+    std::unordered_map<Addr, MemPacket*> writeQueueBursts;
 
     /**
      * Response queue where read packets wait after we're done working
@@ -701,6 +803,7 @@ class MemCtrl : public QoS::MemCtrl
   protected:
 
     Tick recvAtomic(PacketPtr pkt);
+    Tick recvAtomicBackdoor(PacketPtr pkt, MemBackdoorPtr &backdoor);
     void recvFunctional(PacketPtr pkt);
     bool recvTimingReq(PacketPtr pkt);
 
@@ -168,116 +168,117 @@ MemInterface::decodePacket(const PacketPtr pkt, Addr pkt_addr,
 pair<MemPacketQueue::iterator, Tick>
 DRAMInterface::chooseNextFRFCFS(MemPacketQueue& queue, Tick min_col_at) const
 {
-    vector<uint32_t> earliest_banks(ranksPerChannel, 0);
-
-    // Has minBankPrep been called to populate earliest_banks?
-    bool filled_earliest_banks = false;
-    // can the PRE/ACT sequence be done without impacting utlization?
-    bool hidden_bank_prep = false;
-
-    // search for seamless row hits first, if no seamless row hit is
-    // found then determine if there are other packets that can be issued
-    // without incurring additional bus delay due to bank timing
-    // Will select closed rows first to enable more open row possibilies
-    // in future selections
-    bool found_hidden_bank = false;
-
-    // remember if we found a row hit, not seamless, but bank prepped
-    // and ready
-    bool found_prepped_pkt = false;
-
-    // if we have no row hit, prepped or not, and no seamless packet,
-    // just go for the earliest possible
-    bool found_earliest_pkt = false;
-
-    Tick selected_col_at = MaxTick;
-    auto selected_pkt_it = queue.end();
-
-    for (auto i = queue.begin(); i != queue.end() ; ++i) {
-        MemPacket* pkt = *i;
-
-        // select optimal DRAM packet in Q
-        if (pkt->isDram()) {
-            const Bank& bank = ranks[pkt->rank]->banks[pkt->bank];
-            const Tick col_allowed_at = pkt->isRead() ? bank.rdAllowedAt :
-                                                        bank.wrAllowedAt;
+    // Rather than walking the queue, look at the oldest packet of each
+    // bank that hits in the open row, and at the oldest one that misses.
+    // The sequence numbers of the queue entries give their queue order,
+    // so the choice is the same as for an FCFS walk of the queue:
+    // 1) the oldest row hit that can issue seamlessly,
+    // 2) else the oldest miss to one of the banks that can be prepared
+    //    earliest, if the PRE/ACT can be done without impacting
+    //    utilization, selecting closed rows first to enable more open
+    //    row possibilities in future selections,
+    // 3) else the oldest row hit, not seamless, but bank prepped and
+    //    ready,
+    // 4) else the oldest miss to one of the earliest banks.
+    const MemPacketQueue::Entry* seamless_hit = nullptr;
+    Tick seamless_col_at = MaxTick;
+    const MemPacketQueue::Entry* prepped_hit = nullptr;
+    Tick prepped_col_at = MaxTick;
+    bool found_miss = false;
+
+    for (const auto& b : queue.dramBanks()) {
+        const uint8_t rank = b.first / banksPerRank;
+        const uint8_t bank = b.first % banksPerRank;
+        const MemPacketQueue::BankEntries& entries = b.second;
+
+        // check if rank is not doing a refresh and thus is available,
+        // if not, jump to the next bank
+        if (!ranks[rank]->inRefIdleState()) {
+            DPRINTF(DRAM, "%s bank %d - Rank %d not available\n", __func__,
+                    bank, rank);
+            continue;
+        }
 
-            DPRINTF(DRAM, "%s checking DRAM packet in bank %d, row %d\n",
-                    __func__, pkt->bank, pkt->row);
+        const Bank& bank_ref = ranks[rank]->banks[bank];
+        auto hits = entries.rows.find(bank_ref.openRow);
+        const unsigned num_hits =
+            hits == entries.rows.end() ? 0 : hits->second.size();
+
+        if (num_hits) {
+            const MemPacketQueue::Entry& hit = hits->second.front();
+            const Tick col_allowed_at = (*hit.it)->isRead() ?
+                bank_ref.rdAllowedAt : bank_ref.wrAllowedAt;
+
+            // no additional rank-to-rank or same bank-group delays, or we
+            // switched read/write and might as well go for the row hit
+            if (col_allowed_at <= min_col_at) {
+                if (!seamless_hit || hit.seq < seamless_hit->seq) {
+                    seamless_hit = &hit;
+                    seamless_col_at = col_allowed_at;
+                }
+            } else if (!prepped_hit || hit.seq < prepped_hit->seq) {
+                prepped_hit = &hit;
+                prepped_col_at = col_allowed_at;
+            }
+        }
 
-            // check if rank is not doing a refresh and thus is available,
-            // if not, jump to the next packet
-            if (burstReady(pkt)) {
+        found_miss |= entries.count > num_hits;
+    }
 
-                DPRINTF(DRAM,
-                        "%s bank %d - Rank %d available\n", __func__,
-                        pkt->bank, pkt->rank);
+    if (seamless_hit) {
+        DPRINTF(DRAM, "%s Seamless buffer hit\n", __func__);
+        return make_pair(seamless_hit->it, seamless_col_at);
+    }
 
-                // check if it is a row hit
-                if (bank.openRow == pkt->row) {
-                    // no additional rank-to-rank or same bank-group
-                    // delays, or we switched read/write and might as well
-                    // go for the row hit
-                    if (col_allowed_at <= min_col_at) {
-                        // FCFS within the hits, giving priority to
-                        // commands that can issue seamlessly, without
-                        // additional delay, such as same rank accesses
-                        // and/or different bank-group accesses
-                        DPRINTF(DRAM, "%s Seamless buffer hit\n", __func__);
-                        selected_pkt_it = i;
-                        selected_col_at = col_allowed_at;
-                        // no need to look through the remaining queue entries
-                        break;
-                    } else if (!found_hidden_bank && !found_prepped_pkt) {
-                        // if we did not find a packet to a closed row that can
-                        // issue the bank commands without incurring delay, and
-                        // did not yet find a packet to a prepped row, remember
-                        // the current one
-                        selected_pkt_it = i;
-                        selected_col_at = col_allowed_at;
-                        found_prepped_pkt = true;
-                        DPRINTF(DRAM, "%s Prepped row buffer hit\n", __func__);
-                    }
-                } else if (!found_earliest_pkt) {
-                    // if we have not initialised the bank status, do it
-                    // now, and only once per scheduling decisions
-                    if (!filled_earliest_banks) {
-                        // determine entries with earliest bank delay
-                        std::tie(earliest_banks, hidden_bank_prep) =
-                            minBankPrep(queue, min_col_at);
-                        filled_earliest_banks = true;
-                    }
+    // find the oldest miss amongst the banks with the earliest bank delay
+    const MemPacketQueue::Entry* earliest_miss = nullptr;
+    Tick earliest_col_at = MaxTick;
+    bool hidden_bank_prep = false;
 
-                    // bank is amongst first available banks
-                    // minBankPrep will give priority to packets that can
-                    // issue seamlessly
-                    if (bits(earliest_banks[pkt->rank],
-                             pkt->bank, pkt->bank)) {
-                        found_earliest_pkt = true;
-                        found_hidden_bank = hidden_bank_prep;
-
-                        // give priority to packets that can issue
-                        // bank commands 'behind the scenes'
-                        // any additional delay if any will be due to
-                        // col-to-col command requirements
-                        if (hidden_bank_prep || !found_prepped_pkt) {
-                            selected_pkt_it = i;
-                            selected_col_at = col_allowed_at;
-                        }
-                    }
+    if (found_miss) {
+        vector<uint32_t> earliest_banks;
+        std::tie(earliest_banks, hidden_bank_prep) =
+            minBankPrep(queue, min_col_at);
+
+        for (const auto& b : queue.dramBanks()) {
+            const uint8_t rank = b.first / banksPerRank;
+            const uint8_t bank = b.first % banksPerRank;
+
+            // minBankPrep only considers available ranks
+            if (!bits(earliest_banks[rank], bank, bank))
+                continue;
+
+            const Bank& bank_ref = ranks[rank]->banks[bank];
+            for (const auto& row : b.second.rows) {
+                if (row.first == bank_ref.openRow)
+                    continue;
+
+                const MemPacketQueue::Entry& miss = row.second.front();
+                if (!earliest_miss || miss.seq < earliest_miss->seq) {
+                    earliest_miss = &miss;
+                    earliest_col_at = (*miss.it)->isRead() ?
+                        bank_ref.rdAllowedAt : bank_ref.wrAllowedAt;
                 }
-            } else {
-                DPRINTF(DRAM, "%s bank %d - Rank %d not available\n", __func__,
-                        pkt->bank, pkt->rank);
             }
         }
     }
 
-    if (selected_pkt_it == queue.end()) {
-        DPRINTF(DRAM, "%s no available DRAM ranks found\n", __func__);
+    // give priority to packets that can issue bank commands 'behind the
+    // scenes', any additional delay if any will be due to col-to-col
+    // command requirements
+    if (earliest_miss && (hidden_bank_prep || !prepped_hit)) {
+        DPRINTF(DRAM, "%s Earliest bank row miss\n", __func__);
+        return make_pair(earliest_miss->it, earliest_col_at);
     }
 
-    return make_pair(selected_pkt_it, selected_col_at);
+    if (prepped_hit) {
+        DPRINTF(DRAM, "%s Prepped row buffer hit\n", __func__);
+        return make_pair(prepped_hit->it, prepped_col_at);
+    }
+
+    DPRINTF(DRAM, "%s no available DRAM ranks found\n", __func__);
+
+    return make_pair(queue.end(), MaxTick);
 }
 
 void
@@ -612,27 +613,31 @@ DRAMInterface::doBurstAccess(MemPacket* mem_pkt, Tick next_burst_at,
         bool got_bank_conflict = false;
 
         for (uint8_t i = 0; i < ctrl->numPriorities(); ++i) {
-            auto p = queue[i].begin();
-            // keep on looking until we find a hit or reach the end of the
-            // queue
+            // look up the packets waiting for the same bank
             // 1) if a hit is found, then both open and close adaptive
             //    policies keep the page open
             // 2) if no hit is found, got_bank_conflict is set to true if a
             //    bank conflict request is waiting in the queue
             // 3) make sure we are not considering the packet that we are
             //    currently dealing with
-            while (!got_more_hits && p != queue[i].end()) {
-                if (mem_pkt != (*p)) {
-                    bool same_rank_bank = (mem_pkt->rank == (*p)->rank) &&
-                                          (mem_pkt->bank == (*p)->bank);
-
-                    bool same_row = mem_pkt->row == (*p)->row;
-                    got_more_hits |= same_rank_bank && same_row;
-                    got_bank_conflict |= same_rank_bank && !same_row;
+            const auto& banks = queue[i].dramBanks();
+            auto b = banks.find(mem_pkt->bankId);
+            if (b == banks.end())
+                continue;
+
+            unsigned same_row = 0;
+            auto row = b->second.rows.find(mem_pkt->row);
+            if (row != b->second.rows.end()) {
+                for (const auto& entry : row->second) {
+                    if (*entry.it != mem_pkt)
+                        same_row++;
                 }
-                ++p;
             }
 
+            got_more_hits |= same_row > 0;
+            got_bank_conflict |= b->second.count >
+                (row == b->second.rows.end() ? 0 : row->second.size());
+
             if (got_more_hits)
                 break;
         }
@@ -713,6 +718,126 @@ DRAMInterface::doBurstAccess(MemPacket* mem_pkt, Tick next_burst_at,
     return make_pair(cmd_at, cmd_at + burst_gap);
 }
 
+Tick
+DRAMInterface::analyticalBurst(const MemPacket* mem_pkt)
+{
+    Rank& rank_ref = *ranks[mem_pkt->rank];
+    Bank& bank_ref = rank_ref.banks[mem_pkt->bank];
+    const bool is_read = mem_pkt->isRead();
+
+    // a refresh is due every tREFI, it closes all the banks of the
+    // rank and keeps them from activating for tRFC
+    Tick& refresh_at = analyticalRefreshAt[mem_pkt->rank];
+    if (curTick() >= refresh_at) {
+        refresh_at += (curTick() - refresh_at) / tREFI * tREFI;
+        for (auto& b : rank_ref.banks) {
+            b.openRow = Bank::NO_ROW;
+            b.actAllowedAt = std::max(b.actAllowedAt, refresh_at + tRFC);
+        }
+        refresh_at += tREFI;
+    }
+
+    const bool row_hit = bank_ref.openRow == mem_pkt->row;
+    Tick col_at = std::max(curTick(), is_read ? bank_ref.rdAllowedAt :
+                           bank_ref.wrAllowedAt);
+    if (!row_hit) {
+        Tick act_at = std::max(curTick(), bank_ref.actAllowedAt);
+        // precharge the row that is currently open, if any
+        if (bank_ref.openRow != Bank::NO_ROW)
+            act_at = std::max(act_at, std::max(curTick(),
+                                               bank_ref.preAllowedAt) + tRP);
+
+        // allow no more than activationLimit activates in tXAW, if
+        // the activation limit is enabled
+        if (!rank_ref.actTicks.empty()) {
+            if (rank_ref.actTicks.back())
+                act_at = std::max(act_at, rank_ref.actTicks.back() + tXAW);
+            rank_ref.actTicks.pop_back();
+            rank_ref.actTicks.push_front(act_at);
+        }
+
+        // the next activate to the same bank group has to respect
+        // tRRD_L, and to any other bank of the rank tRRD
+        for (auto& b : rank_ref.banks) {
+            Tick rrd = bankGroupArch && b.bankgr == bank_ref.bankgr ?
+                tRRD_L : tRRD;
+            b.actAllowedAt = std::max(b.actAllowedAt, act_at + rrd);
+        }
+
+        bank_ref.openRow = mem_pkt->row;
+        bank_ref.preAllowedAt = act_at + tRAS;
+        col_at = std::max(col_at, act_at + tRCD);
+    }
+
+    // the data bus is shared by all the ranks, and changing its
+    // direction costs tWTR or tRTW, and changing the rank tCS
+    if (is_read == analyticalLastRead)
+        col_at = std::max(col_at, analyticalNextColAt);
+    else if (is_read)
+        col_at = std::max(col_at, analyticalNextColAt + tCL + tWTR);
+    else
+        col_at = std::max(col_at, analyticalNextColAt + tRTW);
+    if (mem_pkt->rank != analyticalLastRank)
+        col_at = std::max(col_at, analyticalNextColAt + tCS);
+
+    const Tick ready = col_at + tCL + tBURST;
+    analyticalNextColAt = col_at + tBURST;
+    analyticalLastRead = is_read;
+    analyticalLastRank = mem_pkt->rank;
+
+    bank_ref.rdAllowedAt = col_at + tBURST;
+    bank_ref.wrAllowedAt = col_at + tBURST;
+
+    // bursts to the same bank group are spaced by tCCD_L, or
+    // tCCD_L_WR between writes, as in doBurstAccess
+    if (bankGroupArch) {
+        const Tick dly_to_rd = is_read ? tCCD_L :
+            std::max(tCCD_L, wrToRdDlySameBG);
+        const Tick dly_to_wr = is_read ?
+            std::max(tCCD_L, rdToWrDlySameBG) : tCCD_L_WR;
+        for (auto& b : rank_ref.banks) {
+            if (b.bankgr == bank_ref.bankgr) {
+                b.rdAllowedAt = std::max(b.rdAllowedAt, col_at + dly_to_rd);
+                b.wrAllowedAt = std::max(b.wrAllowedAt, col_at + dly_to_wr);
+            }
+        }
+    }
+    bank_ref.preAllowedAt = std::max(bank_ref.preAllowedAt,
+                                     is_read ? col_at + tRTP : ready + tWR);
+
+    // without a view of the queued requests the adaptive policies
+    // degenerate to their plain counterparts
+    if (pageMgmt == Enums::close || pageMgmt == Enums::close_adaptive) {
+        bank_ref.actAllowedAt = std::max(bank_ref.actAllowedAt,
+                                         bank_ref.preAllowedAt + tRP);
+        bank_ref.openRow = Bank::NO_ROW;
+    }
+
+    DPRINTF(DRAM, "Analytical %s to rank %d bank %d row %d, column at "
+            "%lld ready at %lld\n", is_read ? "read" : "write",
+            mem_pkt->rank, mem_pkt->bank, mem_pkt->row, col_at, ready);
+
+    if (is_read) {
+        stats.readBursts++;
+        if (row_hit)
+            stats.readRowHits++;
+        stats.bytesRead += burstSize;
+        stats.perBankRdBursts[mem_pkt->bankId]++;
+
+        stats.totMemAccLat += ready - mem_pkt->entryTime;
+        stats.totQLat += col_at - mem_pkt->entryTime;
+        stats.totBusLat += tBURST;
+    } else {
+        stats.writeBursts++;
+        if (row_hit)
+            stats.writeRowHits++;
+        stats.bytesWritten += burstSize;
+        stats.perBankWrBursts[mem_pkt->bankId]++;
+    }
+
+    return ready;
+}
+
 void
 DRAMInterface::addRankToRankDelay(Tick cmd_at)
 {
@@ -753,6 +878,10 @@ DRAMInterface::DRAMInterface(const DRAMInterfaceParams* _p)
       timeStampOffset(0), activeRank(0),
       enableDRAMPowerdown(_p->enable_dram_powerdown),
       lastStatsResetTick(0),
+      analytical(_p->analytical),
+      analyticalNextColAt(0), analyticalLastRead(true),
+      analyticalLastRank(0),
+      analyticalRefreshAt(ranksPerChannel, 0),
       stats(*this)
 {
     DPRINTF(DRAM, "Setting up DRAM Interface\n");
@@ -882,6 +1011,14 @@ DRAMInterface::startup()
         // timestamp offset should be in clock cycles for DRAMPower
         timeStampOffset = divCeil(curTick(), tCK);
 
+        if (analytical) {
+            // refresh is accounted for when the ranks are accessed and
+            // there are no refresh or power state events to kick off
+            for (auto &refresh_at : analyticalRefreshAt)
+                refresh_at = curTick() + tREFI - tRP;
+            return;
+        }
+
         for (auto r : ranks) {
             r->startup(curTick() + tREFI - tRP);
         }
@@ -1054,9 +1191,9 @@ DRAMInterface::minBankPrep(const MemPacketQueue& queue,
     // determine if we have queued transactions targetting the
     // bank in question
     vector<bool> got_waiting(ranksPerChannel * banksPerRank, false);
-    for (const auto& p : queue) {
-        if (p->isDram() && ranks[p->rank]->inRefIdleState())
-            got_waiting[p->bankId] = true;
+    for (const auto& b : queue.dramBanks()) {
+        if (ranks[b.first / banksPerRank]->inRefIdleState())
+            got_waiting[b.first] = true;
     }
 
     // Find command with optimal bank timing
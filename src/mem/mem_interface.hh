@@ -770,6 +770,20 @@ class DRAMInterface : public MemInterface
     /** The time when stats were last reset used to calculate average power */
     Tick lastStatsResetTick;
 
+    /** Compute the access latency analytically at enqueue time. */
+    const bool analytical;
+
+    /**
+     * State of the analytical model that is not kept in the ranks and
+     * banks: when the next burst can use the data bus without a gap,
+     * the direction and rank of the last burst on the bus and when the
+     * next refresh of each rank is due.
+     */
+    Tick analyticalNextColAt;
+    bool analyticalLastRead;
+    uint8_t analyticalLastRank;
+    std::vector<Tick> analyticalRefreshAt;
+
     /**
      * Keep track of when row activations happen, in order to enforce
      * the maximum number of activations in the activation window. The
@@ -931,6 +945,22 @@ class DRAMInterface : public MemInterface
      */
     Tick accessLatency() const override { return (tRP + tRCD + tCL); }
 
+    /**
+     * Is the analytical timing model used for this interface?
+     */
+    bool isAnalytical() const { return analytical; }
+
+    /**
+     * Determine the timing of a burst with the analytical model. The
+     * burst is issued in arrival order as early as the bank, the
+     * activation limits, refresh and the data bus permit, and the
+     * state of the bank and the bus is updated accordingly.
+     *
+     * @param mem_pkt The memory packet created from the outside world pkt
+     * @return tick when the data transfer of the burst is complete
+     */
+    Tick analyticalBurst(const MemPacket* mem_pkt);
+
     /**
      * For FR-FCFS policy, find first DRAM command that can issue
      *
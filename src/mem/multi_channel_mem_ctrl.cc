@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2020 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "mem/multi_channel_mem_ctrl.hh"
+
+#include "base/logging.hh"
+#include "mem/mem_ctrl.hh"
+#include "mem/mem_interface.hh"
+#include "params/MultiChannelMemCtrl.hh"
+
+MultiChannelMemCtrl::MultiChannelMemCtrl(const MultiChannelMemCtrlParams* p)
+    : SimObject(p), port(name() + ".port", *this), channels(p->channels)
+{
+    fatal_if(channels.empty(), "%s has no memory channels\n", name());
+
+    // send the responses of all channels through our port
+    for (auto channel : channels)
+        channel->respPort = &port;
+}
+
+void
+MultiChannelMemCtrl::init()
+{
+    for (auto channel : channels) {
+        AddrRangeList ranges;
+        if (channel->dram)
+            ranges.push_back(channel->dram->getAddrRange());
+        if (channel->nvm)
+            ranges.push_back(channel->nvm->getAddrRange());
+
+        for (const auto& range : ranges) {
+            fatal_if(channelMap.insert(range, channel) == channelMap.end(),
+                     "%s: range %s of %s overlaps with another channel\n",
+                     name(), range.to_string(), channel->name());
+        }
+    }
+
+    if (!port.isConnected()) {
+        fatal("MultiChannelMemCtrl %s is unconnected!\n", name());
+    } else {
+        port.sendRangeChange();
+    }
+}
+
+MemCtrl*
+MultiChannelMemCtrl::findChannel(PacketPtr pkt) const
+{
+    auto channel = channelMap.contains(pkt->getAddrRange());
+    panic_if(channel == channelMap.end(),
+             "%s: no channel for packet %s\n", name(), pkt->print());
+    return channel->second;
+}
+
+Port &
+MultiChannelMemCtrl::getPort(const std::string &if_name, PortID idx)
+{
+    if (if_name != "port") {
+        return SimObject::getPort(if_name, idx);
+    } else {
+        return port;
+    }
+}
+
+MultiChannelMemCtrl::MemoryPort::MemoryPort(const std::string& name,
+                                            MultiChannelMemCtrl& _ctrl)
+    : QueuedResponsePort(name, &_ctrl, queue), queue(_ctrl, *this, true),
+      ctrl(_ctrl)
+{ }
+
+AddrRangeList
+MultiChannelMemCtrl::MemoryPort::getAddrRanges() const
+{
+    AddrRangeList ranges;
+    for (const auto& entry : ctrl.channelMap)
+        ranges.push_back(entry.first);
+    return ranges;
+}
+
+void
+MultiChannelMemCtrl::MemoryPort::recvFunctional(PacketPtr pkt)
+{
+    pkt->pushLabel(ctrl.name());
+
+    if (!queue.trySatisfyFunctional(pkt)) {
+        ctrl.findChannel(pkt)->recvFunctional(pkt);
+    }
+
+    pkt->popLabel();
+}
+
+Tick
+MultiChannelMemCtrl::MemoryPort::recvAtomic(PacketPtr pkt)
+{
+    return ctrl.findChannel(pkt)->recvAtomic(pkt);
+}
+
+Tick
+MultiChannelMemCtrl::MemoryPort::recvAtomicBackdoor(
+        PacketPtr pkt, MemBackdoorPtr &backdoor)
+{
+    return ctrl.findChannel(pkt)->recvAtomicBackdoor(pkt, backdoor);
+}
+
+bool
+MultiChannelMemCtrl::MemoryPort::recvTimingReq(PacketPtr pkt)
+{
+    // pass it to the channel, a channel that cannot accept the request
+    // sends the retry through this port once it has space
+    return ctrl.findChannel(pkt)->recvTimingReq(pkt);
+}
+
+MultiChannelMemCtrl*
+MultiChannelMemCtrlParams::create()
+{
+    return new MultiChannelMemCtrl(this);
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2020 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * @file
+ * MultiChannelMemCtrl declaration
+ */
+
+#ifndef __MEM_MULTI_CHANNEL_MEM_CTRL_HH__
+#define __MEM_MULTI_CHANNEL_MEM_CTRL_HH__
+
+#include <string>
+#include <vector>
+
+#include "base/addr_range_map.hh"
+#include "mem/qport.hh"
+#include "sim/sim_object.hh"
+
+class MemCtrl;
+struct MultiChannelMemCtrlParams;
+
+/**
+ * A set of interleaved memory channels behind a single port.
+ *
+ * Each channel is a regular MemCtrl with its own interface, queues and
+ * scheduling, but its port is left unconnected. Instead of routing the
+ * requests through a crossbar with one layer per channel, the
+ * multi-channel controller looks up the channel owning the address in
+ * the (interleaved) address ranges of the channels and hands the
+ * request straight to it. The responses of all the channels are sent
+ * from a single response queue.
+ */
+class MultiChannelMemCtrl : public SimObject
+{
+  private:
+
+    class MemoryPort : public QueuedResponsePort
+    {
+        RespPacketQueue queue;
+        MultiChannelMemCtrl& ctrl;
+
+      public:
+
+        MemoryPort(const std::string& name, MultiChannelMemCtrl& _ctrl);
+
+      protected:
+
+        Tick recvAtomic(PacketPtr pkt) override;
+
+        Tick recvAtomicBackdoor(
+                PacketPtr pkt, MemBackdoorPtr &backdoor) override;
+
+        void recvFunctional(PacketPtr pkt) override;
+
+        bool recvTimingReq(PacketPtr pkt) override;
+
+        AddrRangeList getAddrRanges() const override;
+    };
+
+    MemoryPort port;
+
+    const std::vector<MemCtrl*> channels;
+
+    /** Map from the address ranges of the channels to the channels */
+    AddrRangeMap<MemCtrl*, 3> channelMap;
+
+    /** Find the channel a packet is destined for. */
+    MemCtrl* findChannel(PacketPtr pkt) const;
+
+  public:
+
+    MultiChannelMemCtrl(const MultiChannelMemCtrlParams* p);
+
+    Port &getPort(const std::string &if_name,
+                  PortID idx=InvalidPortID) override;
+
+    void init() override;
+};
+
+#endif //__MEM_MULTI_CHANNEL_MEM_CTRL_HH__
@@ -39,6 +39,7 @@
 
 #include <fcntl.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/user.h>
 #include <unistd.h>
@@ -54,6 +55,7 @@
 #include "debug/AddrRanges.hh"
 #include "debug/Checkpoint.hh"
 #include "mem/abstract_mem.hh"
+#include "mem/store_checkpoint.hh"
 
 /**
  * On Linux, MAP_NORESERVE allow us to simulate a very large memory
@@ -72,9 +74,12 @@ using namespace std;
 PhysicalMemory::PhysicalMemory(const string& _name,
                                const vector<AbstractMemory*>& _memories,
                                bool mmap_using_noreserve,
-                               const std::string& shared_backstore) :
+                               const std::string& shared_backstore,
+                               Enums::MemCheckpointFormat checkpoint_format,
+                               unsigned checkpoint_threads) :
     _name(_name), size(0), mmapUsingNoReserve(mmap_using_noreserve),
-    sharedBackstore(shared_backstore)
+    sharedBackstore(shared_backstore), checkpointFormat(checkpoint_format),
+    checkpointThreads(StoreCheckpoint::hostThreads(checkpoint_threads))
 {
     if (mmap_using_noreserve)
         warn("Not reserving swap space. May cause SIGSEGV on actual usage\n");
@@ -344,8 +349,19 @@ PhysicalMemory::serializeStore(CheckpointOut &cp, unsigned int store_id,
 {
     // we cannot use the address range for the name as the
     // memories that are not part of the address map can overlap
-    string filename = name() + ".store" + to_string(store_id) + ".pmem";
+    string filename = name() + ".store" + to_string(store_id);
+    switch (checkpointFormat) {
+      case Enums::chunked:
+        filename += ".pmemc";
+        break;
+      case Enums::image:
+        filename += ".pmemimg";
+        break;
+      default:
+        filename += ".pmem";
+    }
     long range_size = range.size();
+    string format = Enums::MemCheckpointFormatStrings[checkpointFormat];
 
     DPRINTF(Checkpoint, "Serializing physical memory %s with size %d\n",
             filename, range_size);
@@ -353,13 +369,35 @@ PhysicalMemory::serializeStore(CheckpointOut &cp, unsigned int store_id,
     SERIALIZE_SCALAR(store_id);
     SERIALIZE_SCALAR(filename);
     SERIALIZE_SCALAR(range_size);
+    SERIALIZE_SCALAR(format);
 
     // write memory file
     string filepath = CheckpointIn::dir() + "/" + filename.c_str();
+    switch (checkpointFormat) {
+      case Enums::gzip:
+        serializeStoreGzip(filepath, range, pmem);
+        break;
+      case Enums::chunked:
+        StoreCheckpoint::writeChunked(filepath, pmem, range.size(),
+                                      checkpointThreads);
+        break;
+      case Enums::image:
+        StoreCheckpoint::writeImage(filepath, pmem, range.size(),
+                                    checkpointThreads);
+        break;
+      default:
+        panic("Unknown memory checkpoint format %s\n", format);
+    }
+}
+
+void
+PhysicalMemory::serializeStoreGzip(const string &filepath, AddrRange range,
+                                   uint8_t* pmem) const
+{
     gzFile compressed_mem = gzopen(filepath.c_str(), "wb");
     if (compressed_mem == NULL)
         fatal("Can't open physical memory checkpoint file '%s'\n",
-              filename);
+              filepath);
 
     uint64_t pass_size = 0;
 
@@ -372,7 +410,7 @@ PhysicalMemory::serializeStore(CheckpointOut &cp, unsigned int store_id,
         if (gzwrite(compressed_mem, pmem + written,
                     (unsigned int) pass_size) != (int) pass_size) {
             fatal("Write failed on physical memory checkpoint file '%s'\n",
-                  filename);
+                  filepath);
         }
     }
 
@@ -380,7 +418,7 @@ PhysicalMemory::serializeStore(CheckpointOut &cp, unsigned int store_id,
     // is zero
     if (gzclose(compressed_mem))
         fatal("Close failed on physical memory checkpoint file '%s'\n",
-              filename);
+              filepath);
 
 }
 
@@ -412,8 +450,6 @@ PhysicalMemory::unserialize(CheckpointIn &cp)
 void
 PhysicalMemory::unserializeStore(CheckpointIn &cp)
 {
-    const uint32_t chunk_size = 16384;
-
     unsigned int store_id;
     UNSERIALIZE_SCALAR(store_id);
 
@@ -421,10 +457,9 @@ PhysicalMemory::unserializeStore(CheckpointIn &cp)
     UNSERIALIZE_SCALAR(filename);
     string filepath = cp.getCptDir() + "/" + filename;
 
-    // mmap memoryfile
-    gzFile compressed_mem = gzopen(filepath.c_str(), "rb");
-    if (compressed_mem == NULL)
-        fatal("Can't open physical memory checkpoint file '%s'", filename);
+    // checkpoints predating the chunked format are always gzip streams
+    string format = Enums::MemCheckpointFormatStrings[Enums::gzip];
+    UNSERIALIZE_OPT_SCALAR(format);
 
     // we've already got the actual backing store mapped
     uint8_t* pmem = backingStore[store_id].pmem;
@@ -440,6 +475,29 @@ PhysicalMemory::unserializeStore(CheckpointIn &cp)
         fatal("Memory range size has changed! Saw %lld, expected %lld\n",
               range_size, range.size());
 
+    if (format == Enums::MemCheckpointFormatStrings[Enums::gzip])
+        unserializeStoreGzip(filepath, range, pmem);
+    else if (format == Enums::MemCheckpointFormatStrings[Enums::chunked])
+        StoreCheckpoint::readChunked(filepath, pmem, range.size(),
+                                     checkpointThreads);
+    else if (format == Enums::MemCheckpointFormatStrings[Enums::image])
+        unserializeStoreImage(filepath, range, pmem);
+    else
+        fatal("Unknown format '%s' of physical memory checkpoint file "
+              "'%s'\n", format, filename);
+}
+
+void
+PhysicalMemory::unserializeStoreGzip(const string &filepath, AddrRange range,
+                                     uint8_t* pmem)
+{
+    const uint32_t chunk_size = 16384;
+
+    // mmap memoryfile
+    gzFile compressed_mem = gzopen(filepath.c_str(), "rb");
+    if (compressed_mem == NULL)
+        fatal("Can't open physical memory checkpoint file '%s'", filepath);
+
     uint64_t curr_size = 0;
     long* temp_page = new long[chunk_size];
     long* pmem_current;
@@ -466,5 +524,46 @@ PhysicalMemory::unserializeStore(CheckpointIn &cp)
 
     if (gzclose(compressed_mem))
         fatal("Close failed on physical memory checkpoint file '%s'\n",
-              filename);
+              filepath);
+}
+
+void
+PhysicalMemory::unserializeStoreImage(const string &filepath,
+                                      AddrRange range, uint8_t* pmem)
+{
+    // a shared backing store is expected to be visible to other
+    // processes, which a private mapping of the image would break
+    fatal_if(!sharedBackstore.empty(), "Physical memory checkpoint file "
+             "'%s' cannot be mapped into the shared backing store %s\n",
+             filepath, sharedBackstore);
+
+    int fd = open(filepath.c_str(), O_RDONLY);
+    if (fd == -1)
+        fatal("Can't open physical memory checkpoint file '%s'\n", filepath);
+
+    struct stat file_stat;
+    fatal_if(fstat(fd, &file_stat) || file_stat.st_size != range.size(),
+             "Physical memory checkpoint file '%s' does not match the size "
+             "of the backing store\n", filepath);
+
+    int map_flags = MAP_PRIVATE | MAP_FIXED;
+    if (mmapUsingNoReserve)
+        map_flags |= MAP_NORESERVE;
+
+    // replace the anonymous backing store by a copy-on-write mapping of
+    // the image at the same host address, such that the memories keep
+    // using the same pointer; pages are only read in when first touched
+    // and stay shared in the page cache until the guest writes them
+    uint8_t* mapped = (uint8_t*) mmap(pmem, range.size(),
+                                      PROT_READ | PROT_WRITE,
+                                      map_flags, fd, 0);
+    if (mapped == (uint8_t*) MAP_FAILED) {
+        perror("mmap");
+        fatal("Could not mmap physical memory checkpoint file '%s'\n",
+              filepath);
+    }
+    assert(mapped == pmem);
+
+    // the mapping holds its own reference to the file
+    close(fd);
 }
@@ -39,6 +39,7 @@
 #define __MEM_PHYSICAL_HH__
 
 #include "base/addr_range_map.hh"
+#include "enums/MemCheckpointFormat.hh"
 #include "mem/packet.hh"
 
 /**
@@ -129,6 +130,12 @@ class PhysicalMemory : public Serializable
 
     const std::string sharedBackstore;
 
+    // Format used when checkpointing the backing store
+    const Enums::MemCheckpointFormat checkpointFormat;
+
+    // Number of host threads used for chunked checkpoints
+    const unsigned checkpointThreads;
+
     // The physical memory used to provide the memory in the simulated
     // system
     std::vector<BackingStoreEntry> backingStore;
@@ -153,6 +160,40 @@ class PhysicalMemory : public Serializable
                             bool conf_table_reported,
                             bool in_addr_map, bool kvm_map);
 
+    /**
+     * Write a backing store as a single gzip stream.
+     *
+     * @param filepath Path of the file to create
+     * @param range The address range of this backing store
+     * @param pmem The host pointer to this backing store
+     */
+    void serializeStoreGzip(const std::string &filepath, AddrRange range,
+                            uint8_t* pmem) const;
+
+    /**
+     * Restore a backing store from a single gzip stream.
+     *
+     * @param filepath Path of the file to read
+     * @param range The address range of this backing store
+     * @param pmem The host pointer to this backing store
+     */
+    void unserializeStoreGzip(const std::string &filepath, AddrRange range,
+                              uint8_t* pmem);
+
+    /**
+     * Restore a backing store by mapping its image copy-on-write in
+     * place of the anonymous memory. Restoring is thus proportional to
+     * the pages the simulation touches, and simulations restoring the
+     * same checkpoint share the unmodified pages through the host page
+     * cache. The image must not be modified while it is mapped.
+     *
+     * @param filepath Path of the file to map
+     * @param range The address range of this backing store
+     * @param pmem The host pointer to this backing store
+     */
+    void unserializeStoreImage(const std::string &filepath, AddrRange range,
+                               uint8_t* pmem);
+
   public:
 
     /**
@@ -161,7 +202,10 @@ class PhysicalMemory : public Serializable
     PhysicalMemory(const std::string& _name,
                    const std::vector<AbstractMemory*>& _memories,
                    bool mmap_using_noreserve,
-                   const std::string& shared_backstore);
+                   const std::string& shared_backstore,
+                   Enums::MemCheckpointFormat checkpoint_format =
+                       Enums::gzip,
+                   unsigned checkpoint_threads = 0);
 
     /**
      * Unmap all the backing store we have used.
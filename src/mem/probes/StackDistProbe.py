@@ -52,6 +52,11 @@ class StackDistProbe(BaseMemProbe):
     # enable verification stack
     verify = Param.Bool(False, "Verify behaviuor with reference implementation")
 
+    # bound the host memory used by the calculator, distances above the
+    # limit are counted as infinite
+    max_distance = Param.Unsigned(0, "Largest stack distance tracked "
+                                  "(0 for unbounded)")
+
     # linear histogram bins and enable/disable
     linear_hist_bins = Param.Unsigned('16', "Bins in linear histograms")
     disable_linear_hists = Param.Bool(False, "Disable linear histograms")
@@ -0,0 +1,312 @@
+/*
+ * Copyright (c) 2020 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "mem/probes/reuse_sample.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <string>
+
+#include "base/intmath.hh"
+#include "params/ReuseSampleProbe.hh"
+#include "sim/system.hh"
+
+namespace
+{
+
+/** Hash of a line address, spreading the lines evenly over 64 bits */
+uint64_t
+hashLine(Addr line)
+{
+    uint64_t x = line + 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+} // anonymous namespace
+
+constexpr uint64_t ReuseSampleProbe::Reservoir::Infinity;
+
+ReuseSampleProbe::Reservoir::Reservoir(unsigned _capacity,
+                                       uint64_t _threshold)
+    : capacity(_capacity), threshold(_threshold),
+      // room for the renumbered lines and as many accesses again
+      slots(2 * (_capacity + 1) + 1, 0), now(0)
+{
+}
+
+double
+ReuseSampleProbe::Reservoir::rate() const
+{
+    return std::ldexp(double(threshold), -64);
+}
+
+uint64_t
+ReuseSampleProbe::Reservoir::nextTime()
+{
+    if (now == slots.size() - 1) {
+        // renumber the lines in the order of their last access
+        std::vector<std::pair<uint64_t, Addr>> order;
+        order.reserve(lines.size());
+        for (const auto &line : lines)
+            order.emplace_back(line.second.time, line.first);
+        std::sort(order.begin(), order.end());
+
+        std::fill(slots.begin(), slots.end(), 0);
+        for (uint64_t time = 0; time < order.size(); ++time) {
+            lines[order[time].second].time = time;
+            update(time, 1);
+        }
+        now = order.size();
+    }
+
+    return now++;
+}
+
+void
+ReuseSampleProbe::Reservoir::update(uint64_t time, int delta)
+{
+    for (uint64_t i = time + 1; i < slots.size(); i += i & -i)
+        slots[i] += delta;
+}
+
+unsigned
+ReuseSampleProbe::Reservoir::countUpTo(uint64_t time) const
+{
+    unsigned count = 0;
+    for (uint64_t i = time + 1; i > 0; i -= i & -i)
+        count += slots[i];
+    return count;
+}
+
+uint64_t
+ReuseSampleProbe::Reservoir::access(Addr line, uint64_t hash)
+{
+    assert(sampled(hash));
+
+    // take the slot first, renumbering may change the time of the line
+    const uint64_t time = nextTime();
+
+    auto it = lines.find(line);
+    if (it != lines.end()) {
+        // the lines accessed since are the ones with a later slot
+        const uint64_t distance = lines.size() - countUpTo(it->second.time);
+        update(it->second.time, -1);
+        it->second.time = time;
+        update(time, 1);
+        return distance;
+    }
+
+    lines.emplace(line, Line{hash, time});
+    byHash.emplace(hash, line);
+    update(time, 1);
+
+    if (lines.size() > capacity) {
+        // drop the line with the largest hash and stop sampling the
+        // lines with a hash as large
+        auto last = std::prev(byHash.end());
+        auto victim = lines.find(last->second);
+        threshold = last->first;
+        update(victim->second.time, -1);
+        lines.erase(victim);
+        byHash.erase(last);
+    }
+
+    return Infinity;
+}
+
+ReuseSampleProbe::ReuseSampleProbe(ReuseSampleProbeParams *p)
+    : BaseMemProbe(p),
+      system(p->system),
+      lineBits(floorLog2(p->line_size)),
+      reservoirSize(p->reservoir_size),
+      threshold(std::numeric_limits<uint64_t>::max() / p->sampling_ratio),
+      bins(p->hist_bins),
+      stats(*this)
+{
+    fatal_if(!isPowerOf2(p->line_size),
+             "%s: line_size must be a power of 2\n", name());
+    fatal_if(p->sampling_ratio == 0, "%s: sampling_ratio must not be 0\n",
+             name());
+    fatal_if(reservoirSize == 0, "%s: reservoir_size must not be 0\n",
+             name());
+    fatal_if(bins < 2, "%s: hist_bins must be at least 2\n", name());
+}
+
+void
+ReuseSampleProbe::handleRequest(const ProbePoints::PacketInfo &pkt_info)
+{
+    // only capturing read and write requests (which allocate in the
+    // cache)
+    if (!pkt_info.cmd.isRead() && !pkt_info.cmd.isWrite())
+        return;
+
+    stats.accesses[pkt_info.id]++;
+
+    // the thresholds only go down, so most accesses stop here
+    const Addr line = pkt_info.addr >> lineBits;
+    const uint64_t hash = hashLine(line);
+    if (hash >= threshold)
+        return;
+
+    auto it = requestors.find(pkt_info.id);
+    if (it == requestors.end()) {
+        it = requestors.emplace(pkt_info.id,
+            Requestor(reservoirSize, threshold, bins)).first;
+    }
+
+    Requestor &requestor = it->second;
+    if (!requestor.reservoir.sampled(hash))
+        return;
+
+    stats.sampledAccesses[pkt_info.id]++;
+
+    // every sampled access stands for the accesses to the lines that
+    // are not sampled at the current rate
+    const double scale = 1 / requestor.reservoir.rate();
+    const uint64_t distance = requestor.reservoir.access(line, hash);
+    if (distance == Reservoir::Infinity) {
+        requestor.cold += scale;
+        return;
+    }
+
+    const double scaled = distance * scale;
+    const unsigned bin = scaled < 1 ? 0 :
+        std::min<unsigned>(floorLog2(uint64_t(scaled)) + 1, bins - 1);
+    requestor.hist[bin] += scale;
+}
+
+void
+ReuseSampleProbe::resetStats()
+{
+    BaseMemProbe::resetStats();
+
+    // the reuse distances only count from now, the sampled lines are
+    // kept to still measure the distances across the reset
+    for (auto &it : requestors) {
+        it.second.cold = 0;
+        std::fill(it.second.hist.begin(), it.second.hist.end(), 0);
+    }
+}
+
+void
+ReuseSampleProbe::preDumpStats()
+{
+    BaseMemProbe::preDumpStats();
+
+    for (const auto &it : requestors) {
+        const RequestorID id = it.first;
+        const Requestor &requestor = it.second;
+
+        stats.samplingRate[id] = requestor.reservoir.rate();
+        stats.coldAccesses[id] = requestor.cold;
+
+        double total = requestor.cold;
+        for (unsigned bin = 0; bin < bins; ++bin) {
+            stats.reuseDist[id][bin] = requestor.hist[bin];
+            total += requestor.hist[bin];
+        }
+
+        if (total == 0)
+            continue;
+
+        // an access misses in an LRU cache of 2^i lines if its reuse
+        // distance is at least 2^i lines, i.e. falls in bin i + 1 or
+        // above
+        double misses = requestor.cold;
+        for (int size = bins - 2; size >= 0; --size) {
+            misses += requestor.hist[size + 1];
+            stats.missRatio[id][size] = misses / total;
+        }
+    }
+}
+
+ReuseSampleProbe::ReuseSampleStats::ReuseSampleStats(
+    ReuseSampleProbe &_probe)
+    : Stats::Group(&_probe),
+    probe(_probe),
+
+    ADD_STAT(accesses, "Number of read and write accesses"),
+    ADD_STAT(sampledAccesses, "Number of accesses sampled"),
+    ADD_STAT(samplingRate, "Fraction of the cache lines sampled"),
+    ADD_STAT(coldAccesses,
+             "Estimated number of accesses to lines not seen before"),
+    ADD_STAT(reuseDist,
+             "Estimated number of accesses per reuse distance in lines"),
+    ADD_STAT(missRatio,
+             "Estimated miss ratio per fully associative LRU cache size")
+{
+}
+
+void
+ReuseSampleProbe::ReuseSampleStats::regStats()
+{
+    Stats::Group::regStats();
+
+    using namespace Stats;
+
+    System *system = probe.system;
+    const auto max_requestors = system->maxRequestors();
+    const unsigned bins = probe.bins;
+
+    accesses.init(max_requestors).flags(nozero);
+    sampledAccesses.init(max_requestors).flags(nozero);
+    samplingRate.init(max_requestors).flags(nozero);
+    coldAccesses.init(max_requestors).flags(nozero);
+    reuseDist.init(max_requestors, bins).flags(nozero);
+    missRatio.init(max_requestors, bins - 1).flags(nozero | nonan);
+
+    for (int i = 0; i < max_requestors; i++) {
+        const std::string name = system->getRequestorName(i);
+        accesses.subname(i, name);
+        sampledAccesses.subname(i, name);
+        samplingRate.subname(i, name);
+        coldAccesses.subname(i, name);
+        reuseDist.subname(i, name);
+        missRatio.subname(i, name);
+    }
+
+    reuseDist.ysubname(0, "0");
+    for (unsigned bin = 1; bin < bins; ++bin)
+        reuseDist.ysubname(bin, std::to_string(1ULL << (bin - 1)));
+
+    for (unsigned size = 0; size < bins - 1; ++size) {
+        missRatio.ysubname(size,
+            std::to_string((1ULL << size) << probe.lineBits));
+    }
+}
+
+ReuseSampleProbe *
+ReuseSampleProbeParams::create()
+{
+    return new ReuseSampleProbe(this);
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2020 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * @file
+ * Sampled reuse distance probe.
+ *
+ * Estimates the reuse distances of the accesses of each requestor, and from
+ * them the miss ratio of a fully associative LRU cache of any size, at a
+ * small fraction of the cost of the exact stack distance probe. It follows
+ * SHARDS (Waldspurger et al., FAST'15): only the cache lines whose address
+ * hash falls below a threshold are tracked, so a line is either always or
+ * never sampled, and the reuse distances measured among the sampled lines
+ * are scaled up by the sampling rate. The number of lines tracked per
+ * requestor is bounded; when it overflows, the line with the largest hash
+ * is dropped and the threshold, and with it the sampling rate, is lowered.
+ */
+
+#ifndef __MEM_PROBES_REUSE_SAMPLE_HH__
+#define __MEM_PROBES_REUSE_SAMPLE_HH__
+
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "base/statistics.hh"
+#include "mem/probes/base.hh"
+
+struct ReuseSampleProbeParams;
+class System;
+
+class ReuseSampleProbe : public BaseMemProbe
+{
+  public:
+    ReuseSampleProbe(ReuseSampleProbeParams *params);
+
+    void resetStats() override;
+    void preDumpStats() override;
+
+  protected:
+    void handleRequest(const ProbePoints::PacketInfo &pkt_info) override;
+
+    /**
+     * The sampled cache lines of one requestor, ordered by the time of
+     * their last access to count the distinct lines accessed since.
+     */
+    class Reservoir
+    {
+      public:
+        /** Distance of an access to a line that has not been seen */
+        static constexpr uint64_t Infinity = ~0ULL;
+
+        Reservoir(unsigned capacity, uint64_t threshold);
+
+        /**
+         * Is a line sampled?
+         *
+         * @param hash Hash of the line address
+         */
+        bool sampled(uint64_t hash) const { return hash < threshold; }
+
+        /** Fraction of the lines that are sampled */
+        double rate() const;
+
+        /**
+         * Access a sampled line.
+         *
+         * @param line Line address
+         * @param hash Hash of the line address
+         * @return Number of distinct sampled lines accessed since the
+         *         last access to the line, Infinity if none
+         */
+        uint64_t access(Addr line, uint64_t hash);
+
+      private:
+        /** Take a time slot, renumbering the slots if they ran out */
+        uint64_t nextTime();
+
+        /** Add delta to the number of lines last accessed at a slot */
+        void update(uint64_t time, int delta);
+
+        /** Number of lines last accessed at or before a slot */
+        unsigned countUpTo(uint64_t time) const;
+
+        struct Line
+        {
+            uint64_t hash;
+            uint64_t time;
+        };
+
+        const unsigned capacity;
+
+        /** Lines with a hash below the threshold are sampled */
+        uint64_t threshold;
+
+        std::unordered_map<Addr, Line> lines;
+
+        /** Sampled lines by hash, to drop the largest one */
+        std::set<std::pair<uint64_t, Addr>> byHash;
+
+        /** Fenwick tree counting the lines last accessed at each slot */
+        std::vector<unsigned> slots;
+
+        /** Next free time slot */
+        uint64_t now;
+    };
+
+    /** Sampled reuse distances of one requestor */
+    struct Requestor
+    {
+        Requestor(unsigned capacity, uint64_t threshold, unsigned bins)
+            : reservoir(capacity, threshold), cold(0), hist(bins, 0)
+        {}
+
+        Reservoir reservoir;
+
+        /** Estimated number of accesses to lines not seen before */
+        double cold;
+
+        /**
+         * Estimated number of accesses per reuse distance, bin 0 holds
+         * distance 0 and bin i distances [2^(i-1), 2^i) lines.
+         */
+        std::vector<double> hist;
+    };
+
+    System *const system;
+
+    /** Cache line size, log2 */
+    const unsigned lineBits;
+
+    /** Lines tracked per requestor */
+    const unsigned reservoirSize;
+
+    /** Initial sampling threshold */
+    const uint64_t threshold;
+
+    /** Number of reuse distance bins */
+    const unsigned bins;
+
+    std::unordered_map<RequestorID, Requestor> requestors;
+
+    struct ReuseSampleStats : public Stats::Group
+    {
+        ReuseSampleStats(ReuseSampleProbe &probe);
+
+        void regStats() override;
+
+        const ReuseSampleProbe &probe;
+
+        /** per-requestor read and write accesses */
+        Stats::Vector accesses;
+        /** per-requestor sampled accesses */
+        Stats::Vector sampledAccesses;
+        /** per-requestor fraction of the lines sampled */
+        Stats::Vector samplingRate;
+        /** per-requestor estimated accesses to lines not seen before */
+        Stats::Vector coldAccesses;
+        /** per-requestor estimated accesses per reuse distance */
+        Stats::Vector2d reuseDist;
+        /** per-requestor miss ratio per LRU cache size */
+        Stats::Vector2d missRatio;
+    } stats;
+};
+
+#endif //__MEM_PROBES_REUSE_SAMPLE_HH__
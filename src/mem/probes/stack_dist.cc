@@ -45,7 +45,7 @@ StackDistProbe::StackDistProbe(StackDistProbeParams *p)
       lineSize(p->line_size),
       disableLinearHists(p->disable_linear_hists),
       disableLogHists(p->disable_log_hists),
-      calc(p->verify)
+      calc(p->verify, p->max_distance)
 {
     fatal_if(p->system->cacheLineSize() > p->line_size,
              "The stack distance probe must use a cache line size that is "
@@ -123,3 +123,48 @@ class QoSPropFairPolicy(QoSPolicy):
                         request_port.getCCObject(), float(score))
 
     weight = Param.Float(0.5, "Pf score weight")
+
+class QoSBandwidthPolicy(QoSPolicy):
+    type = 'QoSBandwidthPolicy'
+    cxx_header = "mem/qos/policy_bw.hh"
+    cxx_class = 'QoS::BandwidthPolicy'
+
+    cxx_exports = [
+        PyBindMethod('initRequestorName'),
+        PyBindMethod('initRequestorObj'),
+    ]
+
+    _requestor_bandwidths = None
+
+    # Regulates the bandwidth of a requestor: below min_bw it is served
+    # at the highest priority, above max_bw at the lowest one or, with
+    # hard set, it is held back until it is within its budget again.
+    def setRequestorBandwidth(self, request_port, min_bw=None, max_bw=None,
+                              hard=False):
+        if not self._requestor_bandwidths:
+            self._requestor_bandwidths = []
+
+        self._requestor_bandwidths.append(
+            [request_port, min_bw, max_bw, hard])
+
+    def init(self):
+        if not self._requestor_bandwidths:
+            print("Error, use setRequestorBandwidth to init "
+                  "requestors/bandwidths\n");
+            exit(1)
+        else:
+            for bw in self._requestor_bandwidths:
+                request_port = bw[0]
+                min_bw = float(MemoryBandwidth(bw[1])) if bw[1] else 0.0
+                max_bw = float(MemoryBandwidth(bw[2])) if bw[2] else 0.0
+                hard = bool(bw[3])
+                if isinstance(request_port, string_types):
+                    self.getCCObject().initRequestorName(
+                        request_port, min_bw, max_bw, hard)
+                else:
+                    self.getCCObject().initRequestorObj(
+                        request_port.getCCObject(), min_bw, max_bw, hard)
+
+    bucket_size = Param.MemorySize("2kB",
+        "Depth of the token buckets, i.e. the burst a requestor can "
+        "issue above its bandwidth")
@@ -52,7 +52,8 @@ MemCtrl::MemCtrl(const QoSMemCtrlParams * p)
     totalReadQueueSize(0), totalWriteQueueSize(0),
     busState(READ), busStateNext(READ),
     stats(*this),
-    _system(p->system)
+    _system(p->system),
+    admissionRetryEvent([this]{ retryAdmission(); }, name())
 {
     // Set the priority policy
     if (policy) {
@@ -232,6 +233,29 @@ MemCtrl::schedule(const PacketPtr pkt)
     }
 }
 
+bool
+MemCtrl::admit(const PacketPtr pkt)
+{
+    if (!policy)
+        return true;
+
+    const Tick when = policy->admissionTick(pkt);
+    if (when <= curTick())
+        return true;
+
+    DPRINTF(QOS,
+            "QoSMemCtrl::admit requestor %s held back until %d\n",
+            _system->getRequestorName(pkt->req->requestorId()), when);
+
+    if (!admissionRetryEvent.scheduled()) {
+        schedule(admissionRetryEvent, when);
+    } else if (admissionRetryEvent.when() > when) {
+        reschedule(admissionRetryEvent, when);
+    }
+
+    return false;
+}
+
 MemCtrl::BusState
 MemCtrl::selectNextBusState()
 {
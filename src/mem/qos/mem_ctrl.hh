@@ -154,6 +154,29 @@ class MemCtrl : public ClockedObject
     /** Pointer to the System object */
     System* _system;
 
+    /**
+     * Event sending the retry owed to requestors held back by the
+     * bandwidth limits of the policy
+     */
+    EventFunctionWrapper admissionRetryEvent;
+
+    /**
+     * Checks a packet against the bandwidth limits of the QoS policy.
+     * A packet that cannot be admitted must be rejected by the
+     * controller, which is then asked to retry its port through
+     * retryAdmission() once the requestor is within its limits again.
+     *
+     * @param pkt pointer to the Packet
+     * @return true if the packet can be admitted
+     */
+    bool admit(const PacketPtr pkt);
+
+    /**
+     * Sends the retry owed to a port whose request has been rejected by
+     * admit(), if it is still owed.
+     */
+    virtual void retryAdmission() = 0;
+
     /**
      * Initializes dynamically counters and
      * statistics for a given Requestor
@@ -145,12 +145,30 @@ MemSinkCtrl::recvTimingReq(PacketPtr pkt)
 
     assert(required_entries);
 
-    // Schedule packet
-    uint8_t pkt_priority = qosSchedule({&readQueue, &writeQueue},
-                                       memoryPacketSize, pkt);
+    // Hold back requestors above their bandwidth limit
+    if (!admit(pkt)) {
+        DPRINTF(QOS,
+                "%s Requestor over its bandwidth limit, not accepting\n",
+                __func__);
+        if (pkt->isRead()) {
+            retryRdReq = true;
+            numReadRetries++;
+        } else {
+            retryWrReq = true;
+            numWriteRetries++;
+        }
+        return false;
+    }
+
+    // Schedule packet, only once it can be queued so that the policy
+    // does not charge the requestor for a retried packet twice
+    const bool queue_full = pkt->isRead() ?
+        readQueueFull(required_entries) : writeQueueFull(required_entries);
+    uint8_t pkt_priority = queue_full ? pkt->qosValue() :
+        qosSchedule({&readQueue, &writeQueue}, memoryPacketSize, pkt);
 
     if (pkt->isRead()) {
-        if (readQueueFull(required_entries)) {
+        if (queue_full) {
             DPRINTF(QOS,
                     "%s Read queue full, not accepting\n", __func__);
             // Remember that we have to retry this port
@@ -164,7 +182,7 @@ MemSinkCtrl::recvTimingReq(PacketPtr pkt)
             queuePolicy->enqueuePacket(pkt);
         }
     } else {
-        if (writeQueueFull(required_entries)) {
+        if (queue_full) {
             DPRINTF(QOS,
                     "%s Write queue full, not accepting\n", __func__);
             // Remember that we have to retry this port
@@ -319,6 +337,16 @@ MemSinkCtrl::processNextReqEvent()
     }
 }
 
+void
+MemSinkCtrl::retryAdmission()
+{
+    if (retryRdReq || retryWrReq) {
+        retryRdReq = false;
+        retryWrReq = false;
+        port.sendRetryReq();
+    }
+}
+
 DrainState
 MemSinkCtrl::drain()
 {
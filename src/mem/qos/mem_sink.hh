@@ -208,6 +208,8 @@ class MemSinkCtrl : public MemCtrl
         MemSinkCtrl,
         &MemSinkCtrl::processNextReqEvent> nextReqEvent;
 
+    void retryAdmission() override;
+
     /**
      * Check if the read queue has room for more entries
      *
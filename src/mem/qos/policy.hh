@@ -106,6 +106,16 @@ class Policy : public SimObject
      */
     uint8_t schedule(const PacketPtr pkt);
 
+    /**
+     * Checks when a packet can be admitted by the memory controller.
+     * Policies enforcing hard bandwidth limits hold back the requestors
+     * that exceeded them; by default every packet is admitted at once.
+     *
+     * @param pkt pointer to the packet to admit
+     * @return tick at which the packet can be admitted
+     */
+    virtual Tick admissionTick(const PacketPtr pkt) { return curTick(); }
+
   protected:
     /** Pointer to parent memory controller implementing the policy */
     MemCtrl* memCtrl;
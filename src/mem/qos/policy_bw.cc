@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2020 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "mem/qos/policy_bw.hh"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mem/request.hh"
+#include "sim/core.hh"
+
+namespace QoS {
+
+BandwidthPolicy::BandwidthPolicy(const Params* p)
+  : Policy(p), bucketSize(p->bucket_size), stats(*this)
+{
+    fatal_if(bucketSize == 0, "%s: bucket_size must not be 0\n", name());
+}
+
+BandwidthPolicy::~BandwidthPolicy()
+{}
+
+void
+BandwidthPolicy::regStats()
+{
+    Policy::regStats();
+    stats.regStats();
+}
+
+void
+BandwidthPolicy::regProbePoints()
+{
+    ppThrottle.reset(new ProbePoints::Packet(getProbeManager(), "Throttle"));
+}
+
+template <typename Requestor>
+void
+BandwidthPolicy::initRequestor(const Requestor requestor, double min_bw,
+                               double max_bw, bool hard)
+{
+    RequestorID id = memCtrl->system()->lookupRequestorId(requestor);
+
+    panic_if(id == Request::invldRequestorId,
+             "Unable to find requestor %s\n", requestor);
+
+    fatal_if(min_bw < 0 || max_bw < 0,
+             "%s: bandwidth of requestor %s must not be negative\n",
+             name(), requestor);
+    fatal_if(max_bw != 0 && min_bw > max_bw,
+             "%s: minimum bandwidth of requestor %s exceeds its "
+             "maximum\n", name(), requestor);
+    fatal_if(hard && max_bw == 0,
+             "%s: hard limit of requestor %s needs a maximum bandwidth\n",
+             name(), requestor);
+
+    Regulator &reg = regulators[id];
+    reg.minTicksPerByte = min_bw ? SimClock::Float::s / min_bw : 0;
+    reg.maxTicksPerByte = max_bw ? SimClock::Float::s / max_bw : 0;
+    reg.hard = hard;
+    // start with full buckets, nothing has been used yet
+    reg.minTokens = bucketSize;
+    reg.maxTokens = bucketSize;
+    reg.lastRefill = curTick();
+
+    DPRINTF(QOS,
+            "Requestor %s [id %d] regulated to min %f max %f bytes/s%s\n",
+            requestor, id, min_bw, max_bw, hard ? " (hard)" : "");
+}
+
+void
+BandwidthPolicy::initRequestorName(std::string requestor, double min_bw,
+                                   double max_bw, bool hard)
+{
+    initRequestor(requestor, min_bw, max_bw, hard);
+}
+
+void
+BandwidthPolicy::initRequestorObj(const SimObject* requestor, double min_bw,
+                                  double max_bw, bool hard)
+{
+    initRequestor(requestor, min_bw, max_bw, hard);
+}
+
+void
+BandwidthPolicy::refill(Regulator &reg) const
+{
+    const double elapsed = curTick() - reg.lastRefill;
+    reg.lastRefill = curTick();
+
+    if (reg.minTicksPerByte) {
+        reg.minTokens = std::min(bucketSize,
+            reg.minTokens + elapsed / reg.minTicksPerByte);
+    }
+    if (reg.maxTicksPerByte) {
+        reg.maxTokens = std::min(bucketSize,
+            reg.maxTokens + elapsed / reg.maxTicksPerByte);
+    }
+}
+
+uint8_t
+BandwidthPolicy::schedule(const RequestorID id, const uint64_t pkt_size)
+{
+    auto it = regulators.find(id);
+    if (it == regulators.end())
+        return midPriority();
+
+    Regulator &reg = it->second;
+    refill(reg);
+
+    uint8_t priority = midPriority();
+    if (reg.minTicksPerByte && reg.minTokens > 0) {
+        priority = highPriority();
+        if (pkt_size)
+            stats.numBoosted[id]++;
+    } else if (reg.maxTicksPerByte && reg.maxTokens < 0) {
+        // only soft limits get here, hard ones are not admitted
+        priority = lowPriority();
+        if (pkt_size)
+            stats.numDemoted[id]++;
+    }
+
+    // Charge the request, the debt is bounded so that a requestor is
+    // not penalised forever for an old burst
+    reg.minTokens = std::max(-bucketSize, reg.minTokens - pkt_size);
+    reg.maxTokens = std::max(-bucketSize, reg.maxTokens - pkt_size);
+    stats.bytesScheduled[id] += pkt_size;
+
+    DPRINTF(QOS,
+            "QoSBandwidthPolicy::schedule requestor id [%d] size %d "
+            "priority %d (tokens min %f max %f)\n",
+            id, pkt_size, priority, reg.minTokens, reg.maxTokens);
+
+    return priority;
+}
+
+Tick
+BandwidthPolicy::admissionTick(const PacketPtr pkt)
+{
+    auto it = regulators.find(pkt->req->requestorId());
+    if (it == regulators.end() || !it->second.hard)
+        return curTick();
+
+    Regulator &reg = it->second;
+    refill(reg);
+
+    if (reg.maxTokens >= 0)
+        return curTick();
+
+    stats.numThrottled[pkt->req->requestorId()]++;
+    ppThrottle->notify(ProbePoints::PacketInfo(pkt));
+
+    // admit again once the debt has been paid back
+    return curTick() + std::ceil(-reg.maxTokens * reg.maxTicksPerByte);
+}
+
+BandwidthPolicy::BandwidthPolicyStats::BandwidthPolicyStats(
+    BandwidthPolicy &_policy)
+    : Stats::Group(&_policy),
+    policy(_policy),
+
+    ADD_STAT(bytesScheduled, "Number of bytes scheduled per requestor"),
+    ADD_STAT(numBoosted,
+             "Number of requests served below the minimum bandwidth"),
+    ADD_STAT(numDemoted,
+             "Number of requests served above a soft maximum bandwidth"),
+    ADD_STAT(numThrottled,
+             "Number of requests held back by a hard maximum bandwidth")
+{
+}
+
+void
+BandwidthPolicy::BandwidthPolicyStats::regStats()
+{
+    Stats::Group::regStats();
+
+    using namespace Stats;
+
+    System *system = policy.memCtrl->system();
+    const auto max_requestors = system->maxRequestors();
+
+    bytesScheduled.init(max_requestors).flags(nozero);
+    numBoosted.init(max_requestors).flags(nozero);
+    numDemoted.init(max_requestors).flags(nozero);
+    numThrottled.init(max_requestors).flags(nozero);
+
+    for (int i = 0; i < max_requestors; i++) {
+        const std::string name = system->getRequestorName(i);
+        bytesScheduled.subname(i, name);
+        numBoosted.subname(i, name);
+        numDemoted.subname(i, name);
+        numThrottled.subname(i, name);
+    }
+}
+
+} // namespace QoS
+
+QoS::BandwidthPolicy *
+QoSBandwidthPolicyParams::create()
+{
+    return new QoS::BandwidthPolicy(this);
+}
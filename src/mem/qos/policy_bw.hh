@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2020 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef __MEM_QOS_POLICY_BW_HH__
+#define __MEM_QOS_POLICY_BW_HH__
+
+#include <unordered_map>
+
+#include "base/statistics.hh"
+#include "mem/qos/policy.hh"
+#include "params/QoSBandwidthPolicy.hh"
+#include "sim/probe/mem.hh"
+
+namespace QoS {
+
+/**
+ * Bandwidth Regulation QoS Policy
+ *
+ * Partitions the memory bandwidth among the requestors, in the style
+ * of the memory bandwidth controls of Arm MPAM. Every configured
+ * requestor can be given a minimum and a maximum bandwidth, each
+ * tracked with a token bucket refilled at that rate:
+ *
+ * - a requestor that used less than its minimum bandwidth is served
+ *   at the highest QoS priority,
+ * - a requestor that used more than its maximum bandwidth is served
+ *   at the lowest QoS priority (soft limit) or, if the limit is hard,
+ *   is not admitted by the memory controller until the bucket has
+ *   refilled,
+ * - any other requestor is served at the middle QoS priority.
+ *
+ * Note that a requestor held back by a hard limit blocks the port of
+ * the memory controller, and with it the requestors sharing that port,
+ * until it is admitted again.
+ */
+class BandwidthPolicy : public Policy
+{
+    using Params = QoSBandwidthPolicyParams;
+
+  public:
+    BandwidthPolicy(const Params*);
+    virtual ~BandwidthPolicy();
+
+    void regStats() override;
+    void regProbePoints() override;
+
+    /**
+     * Initialize the bandwidth limits of a requestor by providing
+     * the requestor's name. The requestor's name has to match a name
+     * in the system.
+     *
+     * @param requestor requestor's name to lookup.
+     * @param min_bw minimum bandwidth in bytes/s, 0 for none
+     * @param max_bw maximum bandwidth in bytes/s, 0 for none
+     * @param hard the maximum bandwidth is a hard limit
+     */
+    void initRequestorName(std::string requestor, double min_bw,
+                           double max_bw, bool hard);
+
+    /**
+     * Initialize the bandwidth limits of a requestor by providing
+     * the requestor's SimObject pointer.
+     *
+     * @param requestor requestor's SimObject pointer to lookup.
+     * @param min_bw minimum bandwidth in bytes/s, 0 for none
+     * @param max_bw maximum bandwidth in bytes/s, 0 for none
+     * @param hard the maximum bandwidth is a hard limit
+     */
+    void initRequestorObj(const SimObject* requestor, double min_bw,
+                          double max_bw, bool hard);
+
+    /**
+     * Schedules a packet based on the bandwidth used by its requestor,
+     * and charges the packet to the requestor
+     *
+     * @param id requestor id to schedule
+     * @param pkt_size size of the packet
+     * @return QoS priority value
+     */
+    virtual uint8_t
+    schedule(const RequestorID id, const uint64_t pkt_size) override;
+
+    Tick admissionTick(const PacketPtr pkt) override;
+
+  protected:
+    /** Token buckets of a regulated requestor, sizes are in bytes */
+    struct Regulator
+    {
+        /** Refill period of the buckets, 0 if not regulated */
+        double minTicksPerByte;
+        double maxTicksPerByte;
+
+        /** The maximum bandwidth is a hard limit */
+        bool hard;
+
+        /** Tokens left, negative when the requestor is in debt */
+        double minTokens;
+        double maxTokens;
+
+        /** Last time the buckets have been refilled */
+        Tick lastRefill;
+    };
+
+    template <typename Requestor>
+    void initRequestor(const Requestor requestor, double min_bw,
+                       double max_bw, bool hard);
+
+    /** Refill the buckets of a requestor up to the current tick */
+    void refill(Regulator &reg) const;
+
+    /** Highest, middle and lowest QoS priority */
+    uint8_t highPriority() const { return memCtrl->numPriorities() - 1; }
+    uint8_t midPriority() const { return highPriority() / 2; }
+    uint8_t lowPriority() const { return 0; }
+
+    /** Depth of the token buckets */
+    const double bucketSize;
+
+    /** Regulated requestors */
+    std::unordered_map<RequestorID, Regulator> regulators;
+
+    /** Notified when a requestor is held back by its hard limit */
+    ProbePoints::PacketUPtr ppThrottle;
+
+    struct BandwidthPolicyStats : public Stats::Group
+    {
+        BandwidthPolicyStats(BandwidthPolicy &policy);
+
+        void regStats() override;
+
+        const BandwidthPolicy &policy;
+
+        /** per-requestor bytes scheduled */
+        Stats::Vector bytesScheduled;
+        /** per-requestor requests served below the minimum bandwidth */
+        Stats::Vector numBoosted;
+        /** per-requestor requests served above a soft maximum */
+        Stats::Vector numDemoted;
+        /** per-requestor requests rejected by a hard maximum */
+        Stats::Vector numThrottled;
+    } stats;
+};
+
+} // namespace QoS
+
+#endif // __MEM_QOS_POLICY_BW_HH__
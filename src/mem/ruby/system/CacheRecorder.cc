@@ -46,18 +46,23 @@ TraceRecord::print(ostream& out) const
 CacheRecorder::CacheRecorder()
     : m_uncompressed_trace(NULL),
       m_uncompressed_trace_size(0),
-      m_block_size_bytes(RubySystem::getBlockSizeBytes())
+      m_block_size_bytes(RubySystem::getBlockSizeBytes()),
+      m_max_outstanding_fetches(1), m_outstanding_fetches(0)
 {
 }
 
 CacheRecorder::CacheRecorder(uint8_t* uncompressed_trace,
                              uint64_t uncompressed_trace_size,
                              std::vector<Sequencer*>& seq_map,
-                             uint64_t block_size_bytes)
+                             uint64_t block_size_bytes,
+                             int trace_version,
+                             unsigned max_outstanding_fetches)
     : m_uncompressed_trace(uncompressed_trace),
       m_uncompressed_trace_size(uncompressed_trace_size),
       m_seq_map(seq_map),  m_bytes_read(0), m_records_read(0),
-      m_records_flushed(0), m_block_size_bytes(block_size_bytes)
+      m_records_flushed(0), m_block_size_bytes(block_size_bytes),
+      m_max_outstanding_fetches(max_outstanding_fetches),
+      m_outstanding_fetches(0)
 {
     if (m_uncompressed_trace != NULL) {
         if (m_block_size_bytes < RubySystem::getBlockSizeBytes()) {
@@ -67,6 +72,50 @@ CacheRecorder::CacheRecorder(uint8_t* uncompressed_trace,
             panic("Recorded cache block size (%d) < current block size (%d) !!",
                     m_block_size_bytes, RubySystem::getBlockSizeBytes());
         }
+        fatal_if(m_max_outstanding_fetches == 0,
+                 "At least one cache warmup request must be allowed in "
+                 "flight");
+        parseTrace(trace_version);
+    }
+}
+
+void
+CacheRecorder::parseTrace(int trace_version)
+{
+    uint64_t record_size;
+    if (trace_version == LegacyTraceVersion) {
+        record_size = sizeof(TraceRecord) + m_block_size_bytes;
+    } else if (trace_version == CompactTraceVersion) {
+        record_size = sizeof(CompactTraceRecord) + m_block_size_bytes;
+    } else {
+        fatal("Unsupported cache trace version %d\n", trace_version);
+    }
+
+    fatal_if(m_uncompressed_trace_size % record_size,
+             "Cache trace size (%d) is not a multiple of the record size "
+             "(%d)\n", m_uncompressed_trace_size, record_size);
+
+    m_fetch_records.reserve(m_uncompressed_trace_size / record_size);
+    while (m_bytes_read < m_uncompressed_trace_size) {
+        uint8_t *raw = m_uncompressed_trace + m_bytes_read;
+        FetchRecord rec;
+        if (trace_version == LegacyTraceVersion) {
+            TraceRecord *trace_rec = (TraceRecord *)raw;
+            rec.addr = trace_rec->m_data_address;
+            rec.cntrl = trace_rec->m_cntrl_id;
+            rec.type = trace_rec->m_type;
+            rec.data = trace_rec->m_data;
+        } else {
+            CompactTraceRecord *trace_rec = (CompactTraceRecord *)raw;
+            rec.addr = trace_rec->m_data_address;
+            rec.cntrl = trace_rec->m_cntrl_id;
+            rec.type = (RubyRequestType)trace_rec->m_type;
+            rec.data = trace_rec->m_data;
+        }
+        fatal_if(rec.cntrl < 0 || rec.cntrl >= m_seq_map.size(),
+                 "Cache trace refers to unknown controller %d\n", rec.cntrl);
+        m_fetch_records.push_back(rec);
+        m_bytes_read += record_size;
     }
 }
 
@@ -104,52 +153,96 @@ CacheRecorder::enqueueNextFlushRequest()
 void
 CacheRecorder::enqueueNextFetchRequest()
 {
-    if (m_bytes_read < m_uncompressed_trace_size) {
-        TraceRecord* traceRecord = (TraceRecord*) (m_uncompressed_trace +
-                                                                m_bytes_read);
-
-        DPRINTF(RubyCacheTrace, "Issuing %s\n", *traceRecord);
-
-        for (int rec_bytes_read = 0; rec_bytes_read < m_block_size_bytes;
-                rec_bytes_read += RubySystem::getBlockSizeBytes()) {
-            RequestPtr req;
-            MemCmd::Command requestType;
-
-            if (traceRecord->m_type == RubyRequestType_LD) {
-                requestType = MemCmd::ReadReq;
-                req = std::make_shared<Request>(
-                    traceRecord->m_data_address + rec_bytes_read,
-                    RubySystem::getBlockSizeBytes(), 0,
-                                    Request::funcRequestorId);
-            }   else if (traceRecord->m_type == RubyRequestType_IFETCH) {
-                requestType = MemCmd::ReadReq;
-                req = std::make_shared<Request>(
-                        traceRecord->m_data_address + rec_bytes_read,
-                        RubySystem::getBlockSizeBytes(),
-                        Request::INST_FETCH, Request::funcRequestorId);
-            }   else {
-                requestType = MemCmd::WriteReq;
-                req = std::make_shared<Request>(
-                    traceRecord->m_data_address + rec_bytes_read,
-                    RubySystem::getBlockSizeBytes(), 0,
-                                Request::funcRequestorId);
-            }
+    const unsigned num_reqs =
+        m_block_size_bytes / RubySystem::getBlockSizeBytes();
 
-            Packet *pkt = new Packet(req, requestType);
-            pkt->dataStatic(traceRecord->m_data + rec_bytes_read);
+    while (m_records_read < m_fetch_records.size()) {
+        const FetchRecord &rec = m_fetch_records[m_records_read];
+        Sequencer* m_sequencer_ptr = m_seq_map[rec.cntrl];
+        assert(m_sequencer_ptr != NULL);
 
-            Sequencer* m_sequencer_ptr = m_seq_map[traceRecord->m_cntrl_id];
-            assert(m_sequencer_ptr != NULL);
-            m_sequencer_ptr->makeRequest(pkt);
+        // Records are issued in trace order. Once nothing is in flight the
+        // next record is always issued, so that replay makes progress even
+        // if a single record needs more requests than the window allows.
+        if (m_outstanding_fetches > 0 &&
+            (m_outstanding_fetches + num_reqs > m_max_outstanding_fetches ||
+             m_blocks_in_flight.count(rec.addr) ||
+             m_sequencer_ptr->outstandingCount() + num_reqs >
+             m_sequencer_ptr->maxOutstandingRequests())) {
+            return;
         }
 
-        m_bytes_read += (sizeof(TraceRecord) + m_block_size_bytes);
+        issueFetchRequest(rec);
         m_records_read++;
-    } else {
+    }
+
+    if (m_outstanding_fetches == 0) {
         DPRINTF(RubyCacheTrace, "Fetched all %d records\n", m_records_read);
     }
 }
 
+void
+CacheRecorder::issueFetchRequest(const FetchRecord &rec)
+{
+    DPRINTF(RubyCacheTrace, "Issuing record %d: Node %d, %#x, %s\n",
+            m_records_read, rec.cntrl, rec.addr, rec.type);
+
+    Sequencer* m_sequencer_ptr = m_seq_map[rec.cntrl];
+    for (int rec_bytes_read = 0; rec_bytes_read < m_block_size_bytes;
+            rec_bytes_read += RubySystem::getBlockSizeBytes()) {
+        RequestPtr req;
+        MemCmd::Command requestType;
+
+        if (rec.type == RubyRequestType_LD) {
+            requestType = MemCmd::ReadReq;
+            req = std::make_shared<Request>(
+                rec.addr + rec_bytes_read,
+                RubySystem::getBlockSizeBytes(), 0,
+                                Request::funcRequestorId);
+        }   else if (rec.type == RubyRequestType_IFETCH) {
+            requestType = MemCmd::ReadReq;
+            req = std::make_shared<Request>(
+                    rec.addr + rec_bytes_read,
+                    RubySystem::getBlockSizeBytes(),
+                    Request::INST_FETCH, Request::funcRequestorId);
+        }   else {
+            requestType = MemCmd::WriteReq;
+            req = std::make_shared<Request>(
+                rec.addr + rec_bytes_read,
+                RubySystem::getBlockSizeBytes(), 0,
+                            Request::funcRequestorId);
+        }
+
+        Packet *pkt = new Packet(req, requestType);
+        pkt->dataStatic(rec.data + rec_bytes_read);
+
+        // Account for the request before issuing it, as it may complete
+        // within makeRequest().
+        m_outstanding_fetches++;
+        m_blocks_in_flight[rec.addr]++;
+
+        RequestStatus status = m_sequencer_ptr->makeRequest(pkt);
+        panic_if(status != RequestStatus_Issued,
+                 "Cache warmup request for %#x was not issued (%s)\n",
+                 pkt->getAddr(), status);
+    }
+}
+
+void
+CacheRecorder::fetchRequestDone(const Packet *pkt)
+{
+    // Map the request back to the block it was recorded for.
+    Addr block_addr = pkt->getAddr() & ~(Addr)(m_block_size_bytes - 1);
+    auto it = m_blocks_in_flight.find(block_addr);
+    assert(it != m_blocks_in_flight.end());
+    assert(m_outstanding_fetches > 0);
+
+    m_outstanding_fetches--;
+    if (--it->second == 0) {
+        m_blocks_in_flight.erase(it);
+    }
+}
+
 void
 CacheRecorder::addRecord(int cntrl, Addr data_addr, Addr pc_addr,
                          RubyRequestType type, Tick time, DataBlock& data)
@@ -174,7 +267,7 @@ CacheRecorder::aggregateRecords(uint8_t **buf, uint64_t total_size)
 
     int size = m_records.size();
     uint64_t current_size = 0;
-    int record_size = sizeof(TraceRecord) + m_block_size_bytes;
+    int record_size = sizeof(CompactTraceRecord) + m_block_size_bytes;
 
     for (int i = 0; i < size; ++i) {
         // Determine if we need to expand the buffer size
@@ -191,8 +284,13 @@ CacheRecorder::aggregateRecords(uint8_t **buf, uint64_t total_size)
             delete [] old_buf;
         }
 
-        // Copy the current record into the buffer
-        memcpy(&((*buf)[current_size]), m_records[i], record_size);
+        // Copy the current record into the buffer, leaving out the fields
+        // that are only needed for ordering the records.
+        CompactTraceRecord *rec = (CompactTraceRecord *)&(*buf)[current_size];
+        rec->m_data_address = m_records[i]->m_data_address;
+        rec->m_cntrl_id = m_records[i]->m_cntrl_id;
+        rec->m_type = m_records[i]->m_type;
+        memcpy(rec->m_data, m_records[i]->m_data, m_block_size_bytes);
         current_size += record_size;
 
         free(m_records[i]);
@@ -35,6 +35,7 @@
 #ifndef __MEM_RUBY_SYSTEM_CACHERECORDER_HH__
 #define __MEM_RUBY_SYSTEM_CACHERECORDER_HH__
 
+#include <unordered_map>
 #include <vector>
 
 #include "base/types.hh"
@@ -43,6 +44,7 @@
 #include "mem/ruby/common/TypeDefines.hh"
 #include "mem/ruby/protocol/RubyRequestType.hh"
 
+class Packet;
 class Sequencer;
 
 /*!
@@ -63,16 +65,42 @@ class TraceRecord {
     void print(std::ostream& out) const;
 };
 
+/*!
+ * On-disk layout of a record in a compact (version 2) cache trace. The
+ * recording time and PC are only needed to order the records before they
+ * are written out, so they are dropped from the checkpoint. As with
+ * TraceRecord, the block data directly follows the header.
+ */
+struct CompactTraceRecord
+{
+    uint64_t m_data_address;
+    uint32_t m_cntrl_id;
+    uint32_t m_type;
+    uint8_t m_data[0];
+};
+
 class CacheRecorder
 {
   public:
+    /** Trace made of raw TraceRecords, as written by older checkpoints. */
+    static const int LegacyTraceVersion = 1;
+    /** Trace made of CompactTraceRecords. */
+    static const int CompactTraceVersion = 2;
+
     CacheRecorder();
     ~CacheRecorder();
 
+    /*!
+     * @param trace_version Layout of the records in uncompressed_trace.
+     * @param max_outstanding_fetches Number of warmup requests that may be
+     *        in flight at the same time.
+     */
     CacheRecorder(uint8_t* uncompressed_trace,
                   uint64_t uncompressed_trace_size,
                   std::vector<Sequencer*>& SequencerMap,
-                  uint64_t block_size_bytes);
+                  uint64_t block_size_bytes,
+                  int trace_version = CompactTraceVersion,
+                  unsigned max_outstanding_fetches = 1);
     void addRecord(int cntrl, Addr data_addr, Addr pc_addr,
                    RubyRequestType type, Tick time, DataBlock& data);
 
@@ -91,18 +119,44 @@ class CacheRecorder
     /*!
      * Function for fetching warming up the memory and the caches. It goes
      * through the recorded contents of the caches, as available in the
-     * checkpoint and issues fetch requests. Except for the first one, a
-     * fetch request is issued only after the previous one has completed.
-     * It should be possible to use this with any protocol.
+     * checkpoint and issues fetch requests in trace order until the
+     * number of requests in flight reaches max_outstanding_fetches. A
+     * record is held back while an earlier record for the same block is
+     * still in flight, so that the accesses to each block complete in the
+     * order in which they were recorded. It should be possible to use this
+     * with any protocol.
      */
     void enqueueNextFetchRequest();
 
+    /*!
+     * Called by the sequencer when a warmup request issued by
+     * enqueueNextFetchRequest() has completed, before the packet is
+     * deleted.
+     */
+    void fetchRequestDone(const Packet *pkt);
+
   private:
     // Private copy constructor and assignment operator
     CacheRecorder(const CacheRecorder& obj);
     CacheRecorder& operator=(const CacheRecorder& obj);
 
+    /** A record of the trace being replayed, independent of its layout. */
+    struct FetchRecord
+    {
+        Addr addr;
+        int cntrl;
+        RubyRequestType type;
+        uint8_t *data;
+    };
+
+    /** Split the uncompressed trace into m_fetch_records. */
+    void parseTrace(int trace_version);
+
+    /** Issue the requests covering one record of the trace. */
+    void issueFetchRequest(const FetchRecord &rec);
+
     std::vector<TraceRecord*> m_records;
+    std::vector<FetchRecord> m_fetch_records;
     uint8_t* m_uncompressed_trace;
     uint64_t m_uncompressed_trace_size;
     std::vector<Sequencer*> m_seq_map;
@@ -110,6 +164,13 @@ class CacheRecorder
     uint64_t m_records_read;
     uint64_t m_records_flushed;
     uint64_t m_block_size_bytes;
+
+    /** Number of warmup requests allowed in flight. */
+    unsigned m_max_outstanding_fetches;
+    /** Number of warmup requests currently in flight. */
+    unsigned m_outstanding_fetches;
+    /** Requests in flight, indexed by recorded block address. */
+    std::unordered_map<Addr, unsigned> m_blocks_in_flight;
 };
 
 inline bool
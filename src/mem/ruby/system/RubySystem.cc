@@ -170,7 +170,8 @@ RubySystem::~RubySystem()
 void
 RubySystem::makeCacheRecorder(uint8_t *uncompressed_trace,
                               uint64_t cache_trace_size,
-                              uint64_t block_size_bytes)
+                              uint64_t block_size_bytes,
+                              int cache_trace_version)
 {
     vector<Sequencer*> sequencer_map;
     Sequencer* sequencer_ptr = NULL;
@@ -197,7 +198,9 @@ RubySystem::makeCacheRecorder(uint8_t *uncompressed_trace,
 
     // Create the CacheRecorder and record the cache trace
     m_cache_recorder = new CacheRecorder(uncompressed_trace, cache_trace_size,
-                                         sequencer_map, block_size_bytes);
+                                         sequencer_map, block_size_bytes,
+                                         cache_trace_version,
+                                         params()->warmup_max_outstanding);
 }
 
 void
@@ -324,8 +327,11 @@ RubySystem::serialize(CheckpointOut &cp) const
     string cache_trace_file = name() + ".cache.gz";
     writeCompressedTrace(raw_data, cache_trace_file, cache_trace_size);
 
+    int cache_trace_version = CacheRecorder::CompactTraceVersion;
+
     SERIALIZE_SCALAR(cache_trace_file);
     SERIALIZE_SCALAR(cache_trace_size);
+    SERIALIZE_SCALAR(cache_trace_version);
 }
 
 void
@@ -383,9 +389,12 @@ RubySystem::unserialize(CheckpointIn &cp)
 
     string cache_trace_file;
     uint64_t cache_trace_size = 0;
+    // Checkpoints without a trace version hold raw TraceRecords.
+    int cache_trace_version = CacheRecorder::LegacyTraceVersion;
 
     UNSERIALIZE_SCALAR(cache_trace_file);
     UNSERIALIZE_SCALAR(cache_trace_size);
+    UNSERIALIZE_OPT_SCALAR(cache_trace_version);
     cache_trace_file = cp.getCptDir() + "/" + cache_trace_file;
 
     readCompressedTrace(cache_trace_file, uncompressed_trace,
@@ -394,7 +403,8 @@ RubySystem::unserialize(CheckpointIn &cp)
     m_systems_to_warmup++;
 
     // Create the cache recorder that will hang around until startup.
-    makeCacheRecorder(uncompressed_trace, cache_trace_size, block_size_bytes);
+    makeCacheRecorder(uncompressed_trace, cache_trace_size, block_size_bytes,
+                      cache_trace_version);
 }
 
 void
@@ -114,7 +114,9 @@ class RubySystem : public ClockedObject
 
     void makeCacheRecorder(uint8_t *uncompressed_trace,
                            uint64_t cache_trace_size,
-                           uint64_t block_size_bytes);
+                           uint64_t block_size_bytes,
+                           int cache_trace_version =
+                               CacheRecorder::CompactTraceVersion);
 
     static void readCompressedTrace(std::string filename,
                                     uint8_t *&raw_data,
@@ -47,6 +47,10 @@ class RubySystem(ClockedObject):
     access_backing_store = Param.Bool(False, "Use phys_mem as the functional \
         store and only use ruby for timing.")
 
+    warmup_max_outstanding = Param.Unsigned(1, "Number of cache warmup \
+        requests in flight at once when restoring from a checkpoint; \
+        requests to the same block are always issued in trace order")
+
     # Profiler related configuration variables
     hot_lines = Param.Bool(False, "")
     all_instructions = Param.Bool(False, "")
@@ -116,6 +116,7 @@ class Sequencer : public RubyPort
     RequestStatus makeRequest(PacketPtr pkt) override;
     virtual bool empty() const;
     int outstandingCount() const override { return m_outstanding_count; }
+    int maxOutstandingRequests() const { return m_max_outstanding_requests; }
 
     bool isDeadlockEventScheduled() const override
     { return deadlockCheckEvent.scheduled(); }
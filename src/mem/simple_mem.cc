@@ -81,8 +81,8 @@ SimpleMemory::recvAtomicBackdoor(PacketPtr pkt, MemBackdoorPtr &_backdoor)
 {
     Tick latency = recvAtomic(pkt);
 
-    if (backdoor.ptr())
-        _backdoor = &backdoor;
+    if (MemBackdoorPtr bd = getBackdoor())
+        _backdoor = bd;
     return latency;
 }
 
@@ -42,24 +42,139 @@
 
 #include "mem/snoop_filter.hh"
 
+#include "base/intmath.hh"
 #include "base/logging.hh"
 #include "base/trace.hh"
 #include "debug/SnoopFilter.hh"
 #include "sim/system.hh"
 
 const int SnoopFilter::SNOOP_MASK_SIZE;
+const SnoopFilter::EntryIndex SnoopFilter::NoEntry;
+const int SnoopFilter::MAX_PORT_LIST_PORTS;
+const Addr SnoopFilter::InvalidLine;
+
+SnoopFilter::SnoopFilter(const SnoopFilterParams *p)
+    : SimObject(p), useCount(0), assoc(p->assoc),
+      setMask(p->assoc ?
+              p->max_capacity / p->system->cacheLineSize() / p->assoc - 1 :
+              0),
+      linesize(p->system->cacheLineSize()), lookupLatency(p->lookup_latency),
+      maxEntryCount(p->max_capacity / p->system->cacheLineSize())
+{
+    // without an associativity the entries are allocated on demand
+    if (!assoc)
+        return;
+
+    fatal_if(maxEntryCount % assoc != 0 ||
+             !isPowerOf2(maxEntryCount / assoc),
+             "Snoop filter %s must have a power of two number of sets, "
+             "got %d entries and associativity %d\n", name(),
+             maxEntryCount, assoc);
+
+    lineAddrs.resize(maxEntryCount, InvalidLine);
+    items.resize(maxEntryCount, SnoopItem{0, 0});
+    lastUse.resize(maxEntryCount, 0);
+}
+
+SnoopFilter::EntryIndex
+SnoopFilter::findEntry(Addr line_addr) const
+{
+    if (!assoc) {
+        auto it = entryIndex.find(line_addr);
+        return it != entryIndex.end() ? it->second : NoEntry;
+    }
+
+    const EntryIndex first = ((line_addr / linesize) & setMask) * assoc;
+    for (EntryIndex entry = first; entry < first + assoc; entry++) {
+        if (lineAddrs[entry] == line_addr)
+            return entry;
+    }
+    return NoEntry;
+}
+
+SnoopFilter::EntryIndex
+SnoopFilter::allocateEntry(Addr line_addr)
+{
+    if (!assoc) {
+        EntryIndex entry;
+        if (freeEntries.empty()) {
+            entry = lineAddrs.size();
+            lineAddrs.push_back(line_addr);
+            items.push_back(SnoopItem{0, 0});
+            lastUse.push_back(0);
+        } else {
+            entry = freeEntries.back();
+            freeEntries.pop_back();
+            lineAddrs[entry] = line_addr;
+            items[entry] = SnoopItem{0, 0};
+        }
+        entryIndex.emplace(line_addr, entry);
+        return entry;
+    }
+
+    const EntryIndex first = ((line_addr / linesize) & setMask) * assoc;
+
+    // use a free entry if there is one, otherwise the least recently
+    // used one that has no requests in flight
+    EntryIndex victim = NoEntry;
+    for (EntryIndex entry = first; entry < first + assoc; entry++) {
+        if (lineAddrs[entry] == InvalidLine) {
+            victim = entry;
+            break;
+        }
+        if (items[entry].requested.none() &&
+            (victim == NoEntry || lastUse[entry] < lastUse[victim]))
+            victim = entry;
+    }
+
+    panic_if(victim == NoEntry, "%s: all %d entries of the set of %#x have "
+             "requests in flight, increase the associativity\n", name(),
+             assoc, line_addr);
+
+    if (lineAddrs[victim] != InvalidLine) {
+        SnoopItem& sf_item = items[victim];
+        DPRINTF(SnoopFilter, "%s:   evicting %#x SF value %x.%x\n",
+                __func__, lineAddrs[victim], sf_item.requested,
+                sf_item.holder);
+
+        evictions++;
+        if (sf_item.holder.any()) {
+            evictionInvalidations += sf_item.holder.count();
+            backInvalidations.push_back(BackInvalidation{
+                lineAddrs[victim] & ~Addr(LineSecure),
+                (lineAddrs[victim] & LineSecure) != 0,
+                maskToPortList(sf_item.holder)});
+        }
+    }
+
+    lineAddrs[victim] = line_addr;
+    items[victim] = SnoopItem{0, 0};
+    return victim;
+}
 
 void
-SnoopFilter::eraseIfNullEntry(SnoopFilterCache::iterator& sf_it)
+SnoopFilter::eraseIfNullEntry(EntryIndex entry)
 {
-    SnoopItem& sf_item = sf_it->second;
+    SnoopItem& sf_item = items[entry];
     if ((sf_item.requested | sf_item.holder).none()) {
-        cachedLocations.erase(sf_it);
+        if (!assoc) {
+            entryIndex.erase(lineAddrs[entry]);
+            freeEntries.push_back(entry);
+        }
+        lineAddrs[entry] = InvalidLine;
         DPRINTF(SnoopFilter, "%s:   Removed SF entry.\n",
                 __func__);
     }
 }
 
+std::vector<SnoopFilter::BackInvalidation>
+SnoopFilter::takeBackInvalidations()
+{
+    std::vector<BackInvalidation> res;
+    res.swap(backInvalidations);
+    return res;
+}
+
 std::pair<SnoopFilter::SnoopList, Cycles>
 SnoopFilter::lookupRequest(const Packet* cpkt, const ResponsePort&
                            cpu_side_port)
@@ -75,8 +190,8 @@ SnoopFilter::lookupRequest(const Packet* cpkt, const ResponsePort&
         line_addr |= LineSecure;
     }
     SnoopMask req_port = portToMask(cpu_side_port);
-    reqLookupResult.it = cachedLocations.find(line_addr);
-    bool is_hit = (reqLookupResult.it != cachedLocations.end());
+    reqLookupResult.entry = findEntry(line_addr);
+    bool is_hit = (reqLookupResult.entry != NoEntry);
 
     // If the snoop filter has no entry, and we should not allocate,
     // do not create a new snoop filter entry, simply return a NULL
@@ -84,12 +199,20 @@ SnoopFilter::lookupRequest(const Packet* cpkt, const ResponsePort&
     if (!is_hit && !allocate)
         return snoopDown(lookupLatency);
 
-    // If no hit in snoop filter create a new element and update iterator
+    // An eviction that misses leaves nothing to track, so do not
+    // evict another line to make room for it
+    if (!is_hit && !cpkt->needsResponse()) {
+        assert(cpkt->isEviction());
+        totRequests++;
+        return snoopDown(lookupLatency);
+    }
+
+    // If no hit in snoop filter allocate a new entry
     if (!is_hit) {
-        reqLookupResult.it =
-            cachedLocations.emplace(line_addr, SnoopItem()).first;
+        reqLookupResult.entry = allocateEntry(line_addr);
     }
-    SnoopItem& sf_item = reqLookupResult.it->second;
+    touch(reqLookupResult.entry);
+    SnoopItem& sf_item = items[reqLookupResult.entry];
     SnoopMask interested = sf_item.holder | sf_item.requested;
 
     // Store unmodified value of snoop filter item in temp storage in
@@ -156,26 +279,27 @@ SnoopFilter::lookupRequest(const Packet* cpkt, const ResponsePort&
 void
 SnoopFilter::finishRequest(bool will_retry, Addr addr, bool is_secure)
 {
-    if (reqLookupResult.it != cachedLocations.end()) {
+    if (reqLookupResult.entry != NoEntry) {
         // since we rely on the caller, do a basic check to ensure
         // that finishRequest is being called following lookupRequest
         Addr line_addr = (addr & ~(Addr(linesize - 1)));
         if (is_secure) {
             line_addr |= LineSecure;
         }
-        assert(reqLookupResult.it->first == line_addr);
+        assert(lineAddrs[reqLookupResult.entry] == line_addr);
         if (will_retry) {
             SnoopItem retry_item = reqLookupResult.retryItem;
             // Undo any changes made in lookupRequest to the snoop filter
             // entry if the request will come again. retryItem holds
             // the previous value of the snoopfilter entry.
-            reqLookupResult.it->second = retry_item;
+            items[reqLookupResult.entry] = retry_item;
 
             DPRINTF(SnoopFilter, "%s:   restored SF value %x.%x\n",
                     __func__,  retry_item.requested, retry_item.holder);
         }
 
-        eraseIfNullEntry(reqLookupResult.it);
+        eraseIfNullEntry(reqLookupResult.entry);
+        reqLookupResult.entry = NoEntry;
     }
 }
 
@@ -190,10 +314,10 @@ SnoopFilter::lookupSnoop(const Packet* cpkt)
     if (cpkt->isSecure()) {
         line_addr |= LineSecure;
     }
-    auto sf_it = cachedLocations.find(line_addr);
-    bool is_hit = (sf_it != cachedLocations.end());
+    EntryIndex entry = findEntry(line_addr);
+    bool is_hit = (entry != NoEntry);
 
-    panic_if(!is_hit && (cachedLocations.size() >= maxEntryCount),
+    panic_if(!assoc && !is_hit && (entryIndex.size() >= maxEntryCount),
              "snoop filter exceeded capacity of %d cache blocks\n",
              maxEntryCount);
 
@@ -203,7 +327,8 @@ SnoopFilter::lookupSnoop(const Packet* cpkt)
     if (!is_hit)
         return snoopDown(lookupLatency);
 
-    SnoopItem& sf_item = sf_it->second;
+    touch(entry);
+    SnoopItem& sf_item = items[entry];
 
     SnoopMask interested = (sf_item.holder | sf_item.requested);
 
@@ -233,7 +358,7 @@ SnoopFilter::lookupSnoop(const Packet* cpkt)
         sf_item.holder = 0;
         DPRINTF(SnoopFilter, "%s:   new SF value %x.%x\n",
                 __func__, sf_item.requested, sf_item.holder);
-        eraseIfNullEntry(sf_it);
+        eraseIfNullEntry(entry);
     }
 
     return snoopSelected(maskToPortList(interested), lookupLatency);
@@ -263,7 +388,10 @@ SnoopFilter::updateSnoopResponse(const Packet* cpkt,
     }
     SnoopMask rsp_mask = portToMask(rsp_port);
     SnoopMask req_mask = portToMask(req_port);
-    SnoopItem& sf_item = cachedLocations[line_addr];
+    EntryIndex entry = findEntry(line_addr);
+    // entries with requests in flight are never evicted
+    panic_if(entry == NoEntry, "SF has no entry for %#x\n", line_addr);
+    SnoopItem& sf_item = items[entry];
 
     DPRINTF(SnoopFilter, "%s:   old SF value %x.%x\n",
             __func__,  sf_item.requested, sf_item.holder);
@@ -310,8 +438,8 @@ SnoopFilter::updateSnoopForward(const Packet* cpkt,
     if (cpkt->isSecure()) {
         line_addr |= LineSecure;
     }
-    auto sf_it = cachedLocations.find(line_addr);
-    bool is_hit = sf_it != cachedLocations.end();
+    EntryIndex entry = findEntry(line_addr);
+    bool is_hit = entry != NoEntry;
 
     // Nothing to do if it is not a hit
     if (!is_hit)
@@ -321,7 +449,7 @@ SnoopFilter::updateSnoopForward(const Packet* cpkt,
     // Modified state, and we know that there are no other copies, or
     // they will all be invalidated imminently
     if (!cpkt->hasSharers()) {
-        SnoopItem& sf_item = sf_it->second;
+        SnoopItem& sf_item = items[entry];
 
         DPRINTF(SnoopFilter, "%s:   old SF value %x.%x\n",
                 __func__, sf_item.requested, sf_item.holder);
@@ -329,7 +457,7 @@ SnoopFilter::updateSnoopForward(const Packet* cpkt,
         DPRINTF(SnoopFilter, "%s:   new SF value %x.%x\n",
                 __func__, sf_item.requested, sf_item.holder);
 
-        eraseIfNullEntry(sf_it);
+        eraseIfNullEntry(entry);
     }
 }
 
@@ -352,12 +480,12 @@ SnoopFilter::updateResponse(const Packet* cpkt, const ResponsePort&
     if (cpkt->isSecure()) {
         line_addr |= LineSecure;
     }
-    auto sf_it = cachedLocations.find(line_addr);
-    if (sf_it == cachedLocations.end())
+    EntryIndex entry = findEntry(line_addr);
+    if (entry == NoEntry)
         return;
 
     SnoopMask response_mask = portToMask(cpu_side_port);
-    SnoopItem& sf_item = sf_it->second;
+    SnoopItem& sf_item = items[entry];
 
     DPRINTF(SnoopFilter, "%s:   old SF value %x.%x\n",
             __func__,  sf_item.requested, sf_item.holder);
@@ -376,7 +504,7 @@ SnoopFilter::updateResponse(const Packet* cpkt, const ResponsePort&
         if (cpkt->isInvalidate()) {
             sf_item.holder &= ~response_mask;
         }
-        eraseIfNullEntry(sf_it);
+        eraseIfNullEntry(entry);
     } else {
         // Any other response implies that a cache above will have the
         // block.
@@ -419,6 +547,16 @@ SnoopFilter::regStats()
         .name(name() + ".hit_multi_snoops")
         .desc("Number of snoops hitting in the snoop filter with multiple "\
               "(>1) holders of the requested data.");
+
+    evictions
+        .name(name() + ".evictions")
+        .desc("Number of lines evicted from the snoop filter to make room "\
+              "for new ones.");
+
+    evictionInvalidations
+        .name(name() + ".eviction_invalidations")
+        .desc("Number of back-invalidations sent to holders of lines "\
+              "evicted from the snoop filter.");
 }
 
 SnoopFilter *
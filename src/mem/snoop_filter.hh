@@ -46,6 +46,7 @@
 #include <bitset>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "mem/packet.hh"
 #include "mem/port.hh"
@@ -82,6 +83,13 @@
  *     upper cache dropped a line, making the snoop filter pessimistic for now
  * (4) ordering: there is no single point of order in the system.  Instead,
  *     requesting MSHRs track order between local requests and remote snoops
+ *
+ * With an associativity, the lines are tracked in a set-associative
+ * structure of bounded capacity. When a request needs a new entry in a
+ * full set, the least recently used entry without outstanding requests
+ * is evicted, and the crossbar back-invalidates the line in the caches
+ * holding it. Without one, entries are allocated as needed and never
+ * evicted, and exceeding the capacity is only checked on snoops.
  */
 class SnoopFilter : public SimObject {
   public:
@@ -91,12 +99,17 @@ class SnoopFilter : public SimObject {
 
     typedef std::vector<QueuedResponsePort*> SnoopList;
 
-    SnoopFilter (const SnoopFilterParams *p) :
-        SimObject(p), reqLookupResult(cachedLocations.end()),
-        linesize(p->system->cacheLineSize()), lookupLatency(p->lookup_latency),
-        maxEntryCount(p->max_capacity / p->system->cacheLineSize())
-    {
-    }
+    SnoopFilter (const SnoopFilterParams *p);
+
+    /**
+     * A line evicted from the snoop filter, and the CPU-side ports
+     * holding it that need to be back-invalidated.
+     */
+    struct BackInvalidation {
+        Addr addr;
+        bool isSecure;
+        SnoopList ports;
+    };
 
     /**
      * Init a new snoop filter and tell it about all the cpu_sideports
@@ -120,6 +133,17 @@ class SnoopFilter : public SimObject {
         fatal_if(id > SNOOP_MASK_SIZE,
                  "Snoop filter only supports %d snooping ports, got %d\n",
                  SNOOP_MASK_SIZE, id);
+
+        // with few enough ports, keep the port list of every mask
+        if (id <= MAX_PORT_LIST_PORTS) {
+            portLists.resize(1 << id);
+            for (unsigned mask = 1; mask < portLists.size(); mask++) {
+                for (PortID i = 0; i < id; i++) {
+                    if (mask & (1 << i))
+                        portLists[mask].push_back(cpuSidePorts[i]);
+                }
+            }
+        }
     }
 
     /**
@@ -195,6 +219,21 @@ class SnoopFilter : public SimObject {
      */
     void updateResponse(const Packet *cpkt, const ResponsePort& cpu_side_port);
 
+    /**
+     * Are there evicted lines that still have to be back-invalidated?
+     */
+    bool needsBackInvalidation() const { return !backInvalidations.empty(); }
+
+    /**
+     * Hand the lines evicted since the last call over to the caller,
+     * which is responsible for invalidating them in the caches above.
+     * This is kept separate from the lookup as the invalidations can
+     * cause new requests to the snoop filter.
+     *
+     * @return The evicted lines and the ports holding them.
+     */
+    std::vector<BackInvalidation> takeBackInvalidations();
+
     virtual void regStats();
 
   protected:
@@ -214,10 +253,9 @@ class SnoopFilter : public SimObject {
         SnoopMask requested;
         SnoopMask holder;
     };
-    /**
-     * HashMap of SnoopItems indexed by line address
-     */
-    typedef std::unordered_map<Addr, SnoopItem> SnoopFilterCache;
+    /** Index of an entry in the set-associative storage. */
+    typedef int EntryIndex;
+    static const EntryIndex NoEntry = -1;
 
     /**
      * Simple factory methods for standard return values.
@@ -252,13 +290,66 @@ class SnoopFilter : public SimObject {
 
   private:
 
+    /** Most snooping ports for which all port lists are precomputed. */
+    static const int MAX_PORT_LIST_PORTS = 8;
+
+    /** Address of an invalid entry, which no line address can match. */
+    static const Addr InvalidLine = MaxAddr;
+
+    /**
+     * Find the entry tracking a line.
+     *
+     * @param line_addr Line address, including the line status bits
+     * @return Index of the entry, or NoEntry if the line is not tracked
+     */
+    EntryIndex findEntry(Addr line_addr) const;
+
+    /**
+     * Allocate an entry for a line that is not tracked yet. If the set
+     * is full, the least recently used entry without outstanding
+     * requests is evicted and queued for back-invalidation.
+     *
+     * @param line_addr Line address, including the line status bits
+     * @return Index of the new, empty entry
+     */
+    EntryIndex allocateEntry(Addr line_addr);
+
     /**
      * Removes snoop filter items which have no requestors and no holders.
      */
-    void eraseIfNullEntry(SnoopFilterCache::iterator& sf_it);
+    void eraseIfNullEntry(EntryIndex entry);
+
+    /** Mark an entry as most recently used. */
+    void touch(EntryIndex entry) { lastUse[entry] = ++useCount; }
+
+    /**
+     * Line addresses of the entries, stored set by set so that a
+     * lookup only scans a few consecutive elements.
+     */
+    std::vector<Addr> lineAddrs;
+    /** Tracking information of the entries. */
+    std::vector<SnoopItem> items;
+    /** Last use of the entries, for the replacement. */
+    std::vector<uint64_t> lastUse;
+    /** Running count of entry uses. */
+    uint64_t useCount;
+
+    /**
+     * Entries of the lines without an associativity, where the entries
+     * are allocated on demand, and the entries that have been freed.
+     */
+    std::unordered_map<Addr, EntryIndex> entryIndex;
+    std::vector<EntryIndex> freeEntries;
 
-    /** Simple hash set of cached addresses. */
-    SnoopFilterCache cachedLocations;
+    /** Number of entries per set, zero for on demand allocation. */
+    const unsigned assoc;
+    /** Mask to extract the set from a line number. */
+    const Addr setMask;
+    /** Lines evicted that still have to be back-invalidated. */
+    std::vector<BackInvalidation> backInvalidations;
+
+    /** Precomputed port lists, indexed by the snoop mask. */
+    std::vector<SnoopList> portLists;
 
     /**
      * A request lookup must be followed by a call to finishRequest to inform
@@ -267,8 +358,8 @@ class SnoopFilter : public SimObject {
      * This structure keeps track of the state previous to such changes.
      */
     struct ReqLookupResult {
-        /** Iterator used to store the result from lookupRequest. */
-        SnoopFilterCache::iterator it;
+        /** Entry used to store the result from lookupRequest. */
+        EntryIndex entry;
 
         /**
          * Variable to temporarily store value of snoopfilter entry
@@ -277,17 +368,10 @@ class SnoopFilter : public SimObject {
          */
         SnoopItem retryItem;
 
-        /**
-         * The constructor must be informed of the internal cache's end
-         * iterator, so do not allow the compiler to implictly define it.
-         *
-         * @param end_it Iterator to the end of the internal cache.
-         */
-        ReqLookupResult(SnoopFilterCache::iterator end_it)
-            : it(end_it), retryItem{0, 0}
+        ReqLookupResult()
+            : entry(NoEntry), retryItem{0, 0}
         {
         }
-        ReqLookupResult() = delete;
     } reqLookupResult;
 
     /** List of all attached snooping CPU-side ports. */
@@ -298,7 +382,7 @@ class SnoopFilter : public SimObject {
     const unsigned linesize;
     /** Latency for doing a lookup in the filter */
     const Cycles lookupLatency;
-    /** Max capacity in terms of cache blocks tracked, for sanity checking */
+    /** Capacity in terms of cache blocks tracked */
     const unsigned maxEntryCount;
 
     /**
@@ -317,6 +401,9 @@ class SnoopFilter : public SimObject {
     Stats::Scalar totSnoops;
     Stats::Scalar hitSingleSnoops;
     Stats::Scalar hitMultiSnoops;
+
+    Stats::Scalar evictions;
+    Stats::Scalar evictionInvalidations;
 };
 
 inline SnoopFilter::SnoopMask
@@ -331,10 +418,13 @@ SnoopFilter::portToMask(const ResponsePort& port) const
 inline SnoopFilter::SnoopList
 SnoopFilter::maskToPortList(SnoopMask port_mask) const
 {
+    if (!portLists.empty())
+        return portLists[port_mask.to_ulong()];
+
     SnoopList res;
-    for (const auto& p : cpuSidePorts)
-        if ((port_mask & portToMask(*p)).any())
-            res.push_back(p);
+    for (int i = 0; i < cpuSidePorts.size(); i++)
+        if (port_mask[i])
+            res.push_back(cpuSidePorts[i]);
     return res;
 }
 
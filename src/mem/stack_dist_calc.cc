@@ -37,458 +37,197 @@
 
 #include "mem/stack_dist_calc.hh"
 
-#include "base/chunk_generator.hh"
+#include <algorithm>
+
 #include "base/intmath.hh"
+#include "base/logging.hh"
 #include "base/trace.hh"
 #include "debug/StackDist.hh"
 
-StackDistCalc::StackDistCalc(bool verify_stack)
-    : index(0),
-      verifyStack(verify_stack)
+namespace
 {
-    // Instantiate a new root and leaf layer
-    // Map type variable, representing a layer in the tree
-    IndexNodeMap tree_level;
-
-    // Initialize tree count for leaves
-    nextIndex.push_back(0);
 
-    // Add the initial leaf layer to the tree
-    tree.push_back(tree_level);
+// Number of slots the calculator starts with
+const uint64_t initialSlots = 64;
 
-    // Create a root node. Node type variable in the topmost layer
-    Node* root_node = new Node();
+} // anonymous namespace
 
-    // Initialize tree count for root
-    nextIndex.push_back(1);
-
-    // Add the empty root layer to the tree
-    tree.push_back(tree_level);
-
-    // Add the initial root to the tree
-    tree[1][root_node->nodeIndex] = root_node;
+StackDistCalc::StackDistCalc(bool verify_stack, uint64_t max_dist)
+    : tree(initialSlots + 1, 0),
+      slotAddrs(initialSlots, 0),
+      nextFree(0),
+      maxDist(max_dist ? max_dist : Infinity),
+      verifyStack(verify_stack)
+{
 }
 
-StackDistCalc::~StackDistCalc()
+void
+StackDistCalc::updateSlot(uint64_t slot, int64_t delta)
 {
-    // Walk through each layer and destroy the nodes
-    for (auto& layer : tree) {
-        for (auto& index_node : layer) {
-            // each map entry contains an index and a node
-            delete index_node.second;
-        }
-        // Clear each layer in the tree
-        layer.clear();
-    }
-
-    // Clear the tree
-    tree.clear();
-    aiMap.clear();
-    nextIndex.clear();
-
-    // For verification
-    stack.clear();
+    for (uint64_t i = slot + 1; i < tree.size(); i += i & -i)
+        tree[i] += delta;
 }
 
-// The updateSum method is a recursive function which updates
-// the node sums till the root. It also deletes the nodes that
-// are not used anymore.
 uint64_t
-StackDistCalc::updateSum(Node* node, bool from_left,
-                         uint64_t sum_from_below, uint64_t level,
-                         uint64_t stack_dist, bool discard_node)
+StackDistCalc::countAfter(uint64_t slot) const
 {
-    ++level;
-
-    // Make a copy of the node variables and work on them
-    // as a node may be deleted by this function
-    uint64_t node_sum_l = node->sumLeft;
-    uint64_t node_sum_r = node->sumRight;
-    bool node_left = node->isLeftNode;
-    bool node_discard_left = node->discardLeft;
-    bool node_discard_right = node->discardRight;
-    uint64_t node_n_index = node->nodeIndex;
-    Node* node_parent_ptr = node->parent;
-
-    // For verification
-    if (verifyStack) {
-        // This sanity check makes sure that the left_sum and
-        // right_sum of the node is not greater than the
-        // maximum possible value given by the leaves below it
-        // for example a node in layer 3 (tree[3]) can at most
-        // have 8 leaves (4 to the left and 4 to the right)
-        // thus left_sum and right_sum should be <= 4
-        panic_if(node_sum_l > (1 << (level - 1)),
-                 "Error in sum left of level %ul, node index %ull, "
-                 "Sum =  %ull \n", level, node_n_index, node_sum_l);
-
-        panic_if(node_sum_r > (1 << (level - 1)),
-                 "Error in sum right of level %ul, node index %ull, "
-                 "Sum =  %ull \n", level, node_n_index, node_sum_r);
-    }
-
-    // Update the left sum or the right sum depending on the
-    // from_left flag. Variable stack_dist is updated only
-    // when arriving from Left.
-    if (from_left) {
-        // update sumLeft
-        node_sum_l = sum_from_below;
-        stack_dist +=  node_sum_r;
-    } else {
-        // update sum_r
-        node_sum_r = sum_from_below;
-    }
-
-    // sum_from_below == 0 can be a leaf discard operation
-    if (discard_node && !sum_from_below) {
-        if (from_left)
-            node_discard_left = true;
-        else
-            node_discard_right = true;
-    }
-
-    // Update the node variables with new values
-    node->nodeIndex = node_n_index;
-    node->sumLeft = node_sum_l;
-    node->sumRight = node_sum_r;
-    node->isLeftNode = node_left;
-    node->discardLeft = node_discard_left;
-    node->discardRight = node_discard_right;
-
-    // Delete the node if it is not required anymore
-    if (node_discard_left && node_discard_right &&
-        discard_node && node_parent_ptr && !sum_from_below) {
-        delete node;
-        tree[level].erase(node_n_index);
-        discard_node = true;
-    } else {
-        // propogate discard_node as false upwards if the
-        // above conditions are not met.
-        discard_node = false;
-    }
-
-    // Recursively call the updateSum operation till the
-    // root node is reached
-    if (node_parent_ptr) {
-        stack_dist = updateSum(node_parent_ptr, node_left,
-                               node_sum_l + node_sum_r,
-                               level, stack_dist, discard_node);
-    }
-
-    return stack_dist;
+    // Sum the slots up to and including this one, all other
+    // addresses were last accessed later
+    uint64_t count = 0;
+    for (uint64_t i = slot + 1; i > 0; i -= i & -i)
+        count += tree[i];
+    return lines.size() - count;
 }
 
-// This function is called by the calcStackDistAndUpdate function
-// If is_new_leaf is true then a new leaf is added otherwise a leaf
-// removed from the tree. In both cases the tree is updated using
-// the updateSum operation.
 uint64_t
-StackDistCalc::updateSumsLeavesToRoot(Node* node, bool is_new_leaf)
+StackDistCalc::firstSlot() const
 {
-    uint64_t level = 0;
-    uint64_t stack_dist = 0;
-
-    if (is_new_leaf) {
-        node->sumLeft = 1;
-        updateSum(node->parent,
-                  node->isLeftNode, node->sumLeft,
-                  level, 0, false);
-
-        stack_dist = Infinity;
-    } else {
-        node->sumLeft = 0;
-        stack_dist = updateSum(node->parent,
-                                  node->isLeftNode, 0,
-                                  level, stack_dist, true);
+    assert(!lines.empty());
+
+    // Descend the tree to the last slot before the first one in use
+    uint64_t pos = 0;
+    for (uint64_t step = 1ULL << floorLog2(tree.size() - 1); step;
+         step >>= 1) {
+        if (pos + step < tree.size() && tree[pos + step] == 0)
+            pos += step;
     }
-
-    return stack_dist;
+    return pos;
 }
 
-// This method is a recursive function which calculates
-// the node sums till the root.
 uint64_t
-StackDistCalc::getSum(Node* node, bool from_left, uint64_t sum_from_below,
-                      uint64_t stack_dist, uint64_t level) const
+StackDistCalc::nextSlot()
 {
-    ++level;
-    // Variable stack_dist is updated only
-    // when arriving from Left.
-    if (from_left) {
-        stack_dist += node->sumRight;
-    }
+    if (nextFree == slotAddrs.size()) {
+        // Renumber the addresses in the order of their last access
+        std::vector<std::pair<uint64_t, Addr>> order;
+        order.reserve(lines.size());
+        for (const auto &line : lines)
+            order.emplace_back(line.second.slot, line.first);
+        std::sort(order.begin(), order.end());
+
+        // Keep at least as many free slots as there are addresses
+        uint64_t num_slots = slotAddrs.size();
+        while (num_slots < 2 * (order.size() + 1))
+            num_slots *= 2;
+
+        slotAddrs.assign(num_slots, 0);
+        tree.assign(num_slots + 1, 0);
+        for (uint64_t slot = 0; slot < order.size(); ++slot) {
+            lines[order[slot].second].slot = slot;
+            slotAddrs[slot] = order[slot].second;
+            tree[slot + 1] = 1;
+        }
 
-    // Recursively call the getSum operation till the
-    // root node is reached
-    if (node->parent) {
-        stack_dist = getSum(node->parent, node->isLeftNode,
-                            node->sumLeft + node->sumRight,
-                            stack_dist, level);
-    }
+        // Build the partial sums in place
+        for (uint64_t i = 1; i < tree.size(); ++i) {
+            const uint64_t parent = i + (i & -i);
+            if (parent < tree.size())
+                tree[parent] += tree[i];
+        }
 
-    return stack_dist;
-}
+        nextFree = order.size();
+        DPRINTF(StackDist, "Renumbered %d addresses, %d slots\n",
+                order.size(), num_slots);
+    }
 
-// This function is called by the calcStackDistance function
-uint64_t
-StackDistCalc::getSumsLeavesToRoot(Node* node) const
-{
-    return  getSum(node->parent, node->isLeftNode, 0, 0, 0);
+    return nextFree++;
 }
 
-// Update tree is a tree balancing operation which maintains
-// the binary tree structure. This method is called whenever
-// index%2 == 0 (i.e. every alternate cycle)
-// The two main operation are :
-// OP1. moving the root node one layer up if index counter
-//    crosses power of 2
-// OP2. Addition of intermediate nodes as and when required
-//      and linking them to their parents in the layer above.
 void
-StackDistCalc::updateTree()
+StackDistCalc::removeLine(AddressLineMap::iterator line)
 {
-    uint64_t i;
-
-    if (isPowerOf2(index)) {
-        // OP1. moving the root node one layer up if index counter
-        //    crosses power of 2
-        // If index counter crosses a power of 2, then add a
-        // new tree layer above and create a new Root node in it.
-        // After the root is created the old node
-        // in the layer below is updated to point to this
-        // newly created root node. The sum_l of this new root node
-        // becomes the sum_l + sum_r of the old node.
-        //
-        // After this root update operation a chain of intermediate
-        // nodes is created from root layer to tree[1](one layer
-        // above the leaf layer)
-
-        // Create a new root node
-        Node* newRootNode = new Node();
-
-        // Update its sum_l as the sum_l+sum_r from below
-        newRootNode->sumLeft = tree[getTreeDepth()][0]->sumRight +
-            tree[getTreeDepth()][0]->sumLeft;
-        // Update its discard left flag if the node below has
-        // has both discardLeft and discardRight set.
-        newRootNode->discardLeft = tree[getTreeDepth()][0]->discardLeft &&
-            tree[getTreeDepth()][0]->discardRight;
-
-        // Map type variable, representing a layer in the tree
-        IndexNodeMap treeLevel;
-        // Add a new layer to the tree
-        tree.push_back(treeLevel);
-        nextIndex.push_back(1);
-        tree[getTreeDepth()][newRootNode->nodeIndex] = newRootNode;
-
-        // Update the parent pointer at lower layer to
-        // point to newly created root node
-        tree[getTreeDepth() - 1][0]->parent = tree[getTreeDepth()][0];
-
-        // Add intermediate nodes from root till bottom (one layer above the
-        // leaf layer)
-        for (i = getTreeDepth() - 1; i >= 1; --i) {
-            Node* newINode = new Node();
-            // newNode is left or right child depending on the number of nodes
-            // in that layer
-            if (nextIndex[i] % 2 == 0) {
-                newINode->isLeftNode = true;
-            } else {
-                newINode->isLeftNode = false;
-            }
-
-            newINode->parent = tree[i + 1][nextIndex[i + 1] - 1];
-            newINode->nodeIndex = ++nextIndex[i] - 1;
-            tree[i][newINode->nodeIndex] = newINode;
-        }
-    } else {
-        // OP2. Addition of intermediate nodes as and when required
-        //      and linking them to their parents in the layer above.
-        //
-        // At layer 1 a new INode is added whenever index%(2^1)==0
-        // (multiples of 2)
-        //
-        // At layer 2 a new INode is added whenever index%(2^2)==0
-        // (multiples of 4)
-        //
-        // At layer 3 a new INode is added whenever index%(2^3)==0
-        // (multiples of 8)
-        //...
-        //
-        // At layer N a new INode is added whenever index%(2^N)==0
-        // (multiples of 2^N)
-        for (i = getTreeDepth() - 1; i >= 1; --i) {
-            // Traverse each layer from root to leaves and add a new
-            // intermediate node if required. Link the parent_ptr of
-            // the new node to the parent in the above layer.
-
-            if ((index % (1 << i)) == 0) {
-                // Checks if current (index % 2^treeDepth) == 0 if true
-                // a new node at that layer is created
-                Node* newINode = new Node();
-
-                // newNode is left or right child depending on the
-                // number of nodes in that layer.
-                if (nextIndex[i] % 2 == 0) {
-                    newINode->isLeftNode = true;
-                } else {
-                    newINode->isLeftNode = false;
-                }
-
-                // Pointing to its parent in the upper layer
-                newINode->parent = tree[i + 1][nextIndex[i + 1] - 1];
-                newINode->nodeIndex = ++nextIndex[i] - 1;
-                tree[i][newINode->nodeIndex] = newINode;
-            }
-        }
-    }
+    updateSlot(line->second.slot, -1);
+    lines.erase(line);
 }
 
-// This function is called everytime to get the stack distance and add
-// a new node. A feature to mark an old node in the tree is
-// added. This is useful if it is required to see the reuse
+// This function is called everytime to get the stack distance and
+// push the address on the stack. A feature to mark an address on the
+// stack is added. This is useful if it is required to see the reuse
 // pattern. For example, BackInvalidates from the lower level (Membus)
-// to L2, can be marked (isMarked flag of Node set to True). And then
-// later if this same address is accessed by L1, the value of the
-// isMarked flag would be True. This would give some insight on how
-// the BackInvalidates policy of the lower level affect the read/write
-// accesses in an application.
+// to L2, can be marked. And then later if this same address is
+// accessed by L1, the value of the mark would be returned. This would
+// give some insight on how the BackInvalidates policy of the lower
+// level affect the read/write accesses in an application.
 std::pair< uint64_t, bool>
 StackDistCalc::calcStackDistAndUpdate(const Addr r_address, bool addNewNode)
 {
-    Node* newLeafNode;
-
-    auto ai = aiMap.lower_bound(r_address);
-
-    // Default value of flag indicating as the left or right leaf
-    bool isLeft     = true;
-    // Default value of isMarked flag for each node.
+    // Default value of isMarked flag for each address.
     bool _mark = false;
     // By default stackDistacne is treated as infinity
-    uint64_t stack_dist;
-
-    // Lookup aiMap by giving address as the key:
-    // If found take address and Lookup in tree
-    // Update tree from leaves by making B(found index) = 0
-    // Add sums to right till root while Updating them
-    // Stack Distance of that address sums to right
-    if (ai != aiMap.end() && !(aiMap.key_comp()(r_address, ai->first))) {
-        // key already exists
-        // save the index counter value when this address was
-        // encountered before and update it to the current index value
-        uint64_t r_index = ai->second;
+    uint64_t stack_dist = Infinity;
+
+    auto line = lines.find(r_address);
+    if (line != lines.end()) {
+        stack_dist = countAfter(line->second.slot);
+        _mark = line->second.isMarked;
 
         if (addNewNode) {
-            // Update aiMap aiMap(Address) = current index
-            ai->second   = index;
+            // Move the address to the top of the stack, the slot is
+            // taken first as renumbering changes the old slot
+            const uint64_t slot = nextSlot();
+            updateSlot(line->second.slot, -1);
+            line->second.slot = slot;
+            line->second.isMarked = false;
+            slotAddrs[slot] = r_address;
+            updateSlot(slot, 1);
         } else {
-            aiMap.erase(r_address);
+            removeLine(line);
         }
-
-        // Call update tree operation on the tree starting with
-        // the r_index value found above. This function would return
-        // the value of the stack distcance.
-        stack_dist = updateSumsLeavesToRoot(tree[0][r_index], false);
-        newLeafNode = tree[0][r_index];
-        // determine if this node was marked earlier
-        _mark = newLeafNode->isMarked;
-        delete newLeafNode;
-        tree[0].erase(r_index);
-    } else {
-        if (addNewNode) {
-            // Update aiMap aiMap(Address) = current index
-            aiMap[r_address] = index;
+    } else if (addNewNode) {
+        const uint64_t slot = nextSlot();
+        lines.emplace(r_address, Line{slot, false});
+        slotAddrs[slot] = r_address;
+        updateSlot(slot, 1);
+
+        // Drop the least recently used address once it is further
+        // down the stack than the distances tracked
+        if (lines.size() - 1 > maxDist) {
+            const Addr lru_address = slotAddrs[firstSlot()];
+            removeLine(lines.find(lru_address));
+
+            // For verification, drop it from the debug stack as well
+            if (verifyStack) {
+                stack.erase(std::find(stack.begin(), stack.end(),
+                                      lru_address));
+            }
         }
-        // Update infinity bin count
-        // By default stackDistacne is treated as infinity
-        stack_dist = Infinity;
     }
 
-    if (addNewNode) {
-        // If index%2 == 0 then update tree
-        if (index % 2 == 0) {
-            updateTree();
-        } else {
-            // At odd values of index counter, a new right-type node is
-            // added to the leaf layer, else a left-type node is added
-            isLeft = false;
-        }
-
-        // Add new leaf node in the leaf layer (tree[0])
-        // set n_index = current index
-        newLeafNode = new Node();
-        ++nextIndex[0];
-        newLeafNode->nodeIndex=index;
-        newLeafNode->isLeftNode=isLeft;
-        // Point the parent pointer to the intermediate node above
-        newLeafNode->parent = tree[1][nextIndex[1] - 1];
-        tree[0][index] = newLeafNode;
-        // call an update operation which would update the tree after
-        // addition of this new leaf node.
-        updateSumsLeavesToRoot(tree[0][index], true);
-
-        // For verification
-        if (verifyStack) {
-            // This function checks the sanity of the tree to make sure the
-            // last node in the link of parent pointers is the root node.
-            // It takes a leaf node as an argument and traveses upwards till
-            // the root layer to check if the last parent is null
-            sanityCheckTree(tree[0][index]);
-
-            // Push the same element in debug stack, and check
-            uint64_t verify_stack_dist = verifyStackDist(r_address, true);
-            panic_if(verify_stack_dist != stack_dist,
-                     "Expected stack-distance for address \
+    // For verification
+    if (verifyStack) {
+        // Push the same element in debug stack, and check
+        uint64_t verify_stack_dist = verifyStackDist(r_address, true);
+        if (!addNewNode)
+            stack.pop_back();
+        panic_if(verify_stack_dist != stack_dist,
+                 "Expected stack-distance for address \
                              %#lx is %#lx but found %#lx",
-                     r_address, verify_stack_dist, stack_dist);
-            printStack();
-        }
-
-        // The index counter is updated at the end of each transaction
-        // (unique or non-unique)
-        ++index;
+                 r_address, verify_stack_dist, stack_dist);
+        printStack();
     }
 
     return (std::make_pair(stack_dist, _mark));
 }
 
 // This function is called everytime to get the stack distance
-// no new node is added. It can be used to mark a previous access
+// the stack is not modified. It can be used to mark a previous access
 // and inspect the value of the mark flag.
 std::pair< uint64_t, bool>
 StackDistCalc::calcStackDist(const Addr r_address, bool mark)
 {
-    // Default value of isMarked flag for each node.
+    // Default value of isMarked flag for each address.
     bool _mark = false;
-
-    auto ai = aiMap.lower_bound(r_address);
-
     // By default stackDistacne is treated as infinity
-    uint64_t stack_dist = 0;
-
-    // Lookup aiMap by giving address as the key:
-    // If found take address and Lookup in tree
-    // Add sums to right till root
-    // Stack Distance of that address sums to right
-    if (ai != aiMap.end() && !(aiMap.key_comp()(r_address, ai->first))) {
-        // key already exists
-        // save the index counter value when this address was
-        // encountered before
-        uint64_t r_index = ai->second;
+    uint64_t stack_dist = Infinity;
 
+    auto line = lines.find(r_address);
+    if (line != lines.end()) {
         // Get the value of mark flag if previously marked
-        _mark = tree[0][r_index]->isMarked;
-        // Mark the leaf node if required
-        tree[0][r_index]->isMarked = mark;
-
-        // Call get sums operation on the tree starting with
-        // the r_index value found above. This function would return
-        // the value of the stack distcance.
-        stack_dist = getSumsLeavesToRoot(tree[0][r_index]);
-    } else {
-        // Update infinity bin count
-        // By default stackDistacne is treated as infinity
-        stack_dist = Infinity;
+        _mark = line->second.isMarked;
+        // Mark the address if required
+        line->second.isMarked = mark;
+
+        stack_dist = countAfter(line->second.slot);
     }
 
     // For verification
@@ -505,25 +244,6 @@ StackDistCalc::calcStackDist(const Addr r_address, bool mark)
 
     return std::make_pair(stack_dist, _mark);
 }
-
-// For verification
-// Simple sanity check for the tree
-void
-StackDistCalc::sanityCheckTree(const Node* node, uint64_t level) const
-{
-    const Node* next_up = node->parent;
-
-    for (uint64_t i = level + 1; i < getTreeDepth() - level; ++i) {
-        next_up = next_up->parent;
-        panic_if(!next_up, "Sanity check failed for node %ull \n",
-                 node->nodeIndex);
-    }
-
-    // At the root layer the parent_ptr should be null
-    panic_if(next_up->parent, "Sanity check failed for node %ull \n",
-             node->nodeIndex);
-}
-
 // This method can be called to compute the stack distance in a naive
 // way It can be used to verify the functionality of the stack
 // distance calculator. It uses std::vector to compute the stack
@@ -562,28 +282,23 @@ StackDistCalc::verifyStackDist(const Addr r_address, bool update_stack)
 void
 StackDistCalc::printStack(int n) const
 {
-    Node* node;
     int count = 0;
 
-    DPRINTF(StackDist, "Printing last %d entries in tree\n", n);
+    DPRINTF(StackDist, "Printing last %d entries on the stack\n", n);
 
-    // Walk through leaf layer to display the last n nodes
-    for (auto it = tree[0].rbegin(); (count < n) && (it != tree[0].rend());
-         ++it, ++count) {
-        node = it->second;
-        uint64_t r_index = node->nodeIndex;
-
-        // Lookup aiMap using the index returned by the leaf iterator
-        for (auto ai = aiMap.rbegin(); ai != aiMap.rend(); ++ai) {
-            if (ai->second == r_index) {
-                DPRINTF(StackDist,"Tree leaves, Rightmost-[%d] = %#lx\n",
-                        count, ai->first);
-                break;
-            }
+    // Walk the slots down from the top of the stack, skipping the
+    // ones whose address has been accessed again since
+    for (uint64_t slot = nextFree; (count < n) && (slot > 0); --slot) {
+        auto line = lines.find(slotAddrs[slot - 1]);
+        if (line != lines.end() && line->second.slot == slot - 1) {
+            DPRINTF(StackDist, "Stack, Top-[%d] = %#lx\n", count,
+                    line->first);
+            ++count;
         }
     }
 
-    DPRINTF(StackDist,"Tree depth = %#ld\n", getTreeDepth());
+    DPRINTF(StackDist, "Stack size = %d, slots = %d\n", lines.size(),
+            slotAddrs.size());
 
     if (verifyStack) {
         DPRINTF(StackDist,"Printing Last %d entries in VerifStack \n", n);
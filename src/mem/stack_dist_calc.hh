@@ -39,88 +39,66 @@
 #define __MEM_STACK_DIST_CALC_HH__
 
 #include <limits>
-#include <map>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "base/types.hh"
 
 /**
   * The stack distance calculator is a passive object that merely
-  * observes the addresses pass to it. It calculates stack distances
-  * of incoming addresses based on the partial sum hierarchy tree
-  * algorithm described by Alamasi et al.
-  * http://doi.acm.org/10.1145/773039.773043.
+  * observes the addresses pass to it. It calculates the stack
+  * distance of every address, i.e. the number of distinct addresses
+  * accessed since the previous access to it.
   *
-  * A tree structure is maintained and updated at each transaction
-  * (unique or non-unique). The tree is implemented as an STL vector
-  * with layers of the form <map> Each layer in this tree is an
-  * ordered map <uint64_t, Node*>. Nodes are structs which take form
-  * of leaf, intermediate and root nodes. For example, in a tree with 3
-  * layers, tree[0][5] gives a leaf node pointer for key=5 tree[1][1]
-  * gives an intermediate node pointer for key=1 tree[2][0] gives the
-  * root node in the tree.
+  * Every access is given a time slot from an increasing counter. A
+  * hash map (lines) holds the slot of the last access to each
+  * address, and a Fenwick tree over the slots counts the addresses
+  * whose last access took place in each slot. The stack distance of
+  * an address is then the number of addresses last accessed after
+  * its own slot, a prefix sum over the tree, and moving an address
+  * to the top of the stack is a decrement of its old slot and an
+  * increment of a new one. Both are O(log n) in the number of
+  * addresses on the stack.
   *
-  * At every transaction a hash-map (aiMap) is looked up to check if
-  * the address was already encountered before. Based on this lookup a
-  * transaction can be termed as unique or non-unique.
+  * Only the slots of the addresses still on the stack are needed, so
+  * when the slots run out the addresses are renumbered in the order
+  * of their last access and the tree is rebuilt, growing it if more
+  * than half of the slots are in use. The memory used is thus a
+  * constant per address on the stack.
   *
-  * In addition to the normal stack distance calculation, a feature to
-  * mark an old node in the tree is added. This is useful if it is
-  * required to see the reuse pattern. For example, BackInvalidates
-  * from a lower level (e.g. membus to L2), can be marked (isMarked
-  * flag of Node set to True). Then later if this same address is
-  * accessed (by L1), the value of the isMarked flag would be
-  * True. This would give some insight on how the BackInvalidates
-  * policy of the lower level affect the read/write accesses in an
-  * application.
+  * Optionally the stack can be pruned to a maximum distance: once
+  * it holds more than max_dist + 1 addresses the least recently used
+  * one is dropped. Distances up to max_dist are exact, larger ones
+  * are reported as Infinity, and the memory used is bounded by the
+  * maximum distance instead of the footprint of the workload. Note
+  * that removing addresses from the stack brings the ones below it
+  * closer to the top, a dropped address is still reported as
+  * Infinity when it is accessed again.
+  *
+  * In addition to the normal stack distance calculation, an address
+  * on the stack can be marked. This is useful if it is required to
+  * see the reuse pattern. For example, BackInvalidates from a lower
+  * level (e.g. membus to L2), can be marked. Then later if this same
+  * address is accessed (by L1), the mark would be returned. This
+  * would give some insight on how the BackInvalidates policy of the
+  * lower level affect the read/write accesses in an application.
   *
   * There are two functions provided to interface with the calculator:
   * 1. pair<uint64_t, bool> calcStackDistAndUpdate(Addr r_address,
   *                                                bool addNewNode)
-  * At every unique transaction a new leaf node is added at tree[0](leaf layer)
-  * and linked to the layer above (if addNewNode is True). The sums of all
-  * the intermediate nodes is updated till the root. The stack-distance is
-  * returned as a Constant representing INFINITY.
-  *
-  * At every non-unique transaction the tree is traversed from the
-  * leaf at the returned index to the root, the old node is deleted
-  * from the tree, and the sums (to the right are collected) and
-  * decremented. The collected sum represets the stack distance of the
-  * found node. If this node was marked then a bool flag set to True
-  * is returned with the stack_distance. During this operation a node
-  * is discarded at the leaf layer always. Moreover during the
-  * traversal upwards using the updateSum() method, if an intermediate
-  * node is found with no children connected to it, then that is
-  * discarded too.
-  *
-  * The return value of this function is a pair representing the
-  * stack_distance and the value of the marked flag.
+  * Returns the stack distance of the address and removes it from
+  * the stack. If addNewNode is true, it is then pushed on the top of
+  * the stack (i.e. it is accessed).
   *
   * 2. pair<uint64_t , bool> calcStackDist(Addr r_address, bool mark)
-  * This is a stripped down version of the above function which is used to
-  * just inspect the tree, and mark a leaf node (if mark flag is set). The
-  * functionality to add a new node is removed.
-  *
-  * At every unique transaction the stack-distance is returned as a constant
-  * representing INFINITY.
+  * Returns the stack distance of the address without modifying the
+  * stack, and sets or clears its mark.
   *
-  * At every non-unique transaction the tree is traversed from the
-  * leaf at the returned index to the root, and the sums (to the right)
-  * are collected. The collected sum represets the stack distance of
-  * the found node.
+  * The return value of both functions is a pair representing the
+  * stack distance and the previous value of the mark.
   *
-  * This function does NOT Modify the stack. (No node is added or
-  * deleted).  It is just used to mark a node already created and get
-  * its stack distance.
-  *
-  * The return value of this function is a pair representing the stack
-  * distance and the value of the marked flag.
-  *
-  * The table below depicts the usage of the Algorithm using the functions:
-  * pair<uint64_t Stack_dist, bool isMarked> calcStackDistAndUpdate
-  *                                      (Addr r_address, bool addNewNode)
-  * pair<uint64_t Stack_dist, bool isMarked> calcStackDist
-  *                                              (Addr r_address, bool mark)
+  * The table below depicts the usage of the functions:
   *
   * |   Function           |   Arguments   |Return Val |Use For|
   * |calcStackDistAndUpdate|r_address, True|I/SD,False |A,GD,GM|
@@ -135,8 +113,8 @@
   *                                                                  before,
   *  *I: stack-distance = infinity,
   *  *SD: Stack Distance
-  *  *r_address: address to be added, *prevMark: value of isMarked flag
-  *                                                              of the Node)
+  *  *r_address: address to be added, *prevMark: value of the mark
+  *                                                     of the address)
   *
   * Invalidates refer to a type of packet that removes something from
   * a cache, either autonoumously (due-to cache's own replacement
@@ -148,15 +126,6 @@
   * Delete Old Entry |calcStackDistAndUpdate|Writebacks/Cleanevicts|
   * Dist.of Old entry|calcStackDist         |Cleanevicts/Invalidate|
   *
-  * Node Balancing: The tree structure is maintained by an
-  * updateTree() operation called when an intermediate node is
-  * required. The update operation is roughly categorized as a root
-  * update or intermediate layer update. When number of leaf nodes
-  * grow over a power of 2 then a new layer is added at the top of the
-  * tree and a new root node is initialized. The old node at the lower
-  * layer is connected to this.  In an intermediate node update
-  * operation a new intermediate node is added to the required layer.
-  *
   * Debugging: Debugging can be enabled by setting the verifyStack flag
   * true. Debugging is implemented using a dummy stack that behaves in
   * a naive way, using STL vectors (i.e each unique address is pushed
@@ -166,122 +135,76 @@
   * pushed down, and the address is pushed at the top of the stack).
   *
   * A printStack(int numOfEntitiesToPrint) is provided to print top n entities
-  * in both (tree and STL based dummy stack).
+  * in both (calculator and STL based dummy stack).
   */
 class StackDistCalc
 {
 
   private:
 
-    struct Node;
-
-    typedef std::map<uint64_t, Node*> IndexNodeMap;
-    typedef std::map<Addr, uint64_t> AddressIndexMap;
-    typedef std::vector<IndexNodeMap> TreeType;
-
     /**
-     * Gets sum from the node upwards recursively till the root.  This
-     * function is called first by getSumsLeavesToRoot, and then
-     * recursively calls itself.
-     *
-     * @param node pointer to the node which is updated
-     * @param from_left variable which says that the request arrived
-     *        from the left
-     * @param sum_from_below Sum of left and right children below
-     * @param level level in the tree the calling node is located
-     * @param stack_dist stack distance of the node below
-     * @return The stack distance of the current address.
-     *
+     * An address on the stack
      */
-    uint64_t getSum(Node* node, bool from_left, uint64_t sum_from_below,
-                    uint64_t stack_dist, uint64_t level) const;
+    struct Line
+    {
+        // Slot of the last access to the address
+        uint64_t slot;
 
-    /**
-     * Gets the sum from the leaf node specified. This function
-     * is called by calcStackDist.
-     *
-     * @param node pointer to the node which is updated
-     * @return The stack distance of the current address.
-     *
-     */
-    uint64_t getSumsLeavesToRoot(Node* node) const;
+        /**
+         * Flag to indicate if this address is marked. Used in case
+         * where stack distance of a touched address is required.
+         */
+        bool isMarked;
+    };
 
-    /**
-     * Updates the nodes upwards recursively till the root.
-     * This function is first called by updateSumsLeavesToRoot,
-     * and then it recursively calls itself.
-     *
-     * @param node pointer to the node which is updated
-     * @param from_left variable which says that the request arrived
-     * from the left
-     * @param sum_from_below Sum of left and right children below
-     * @param level level in the tree the calling node is located
-     * @param stack_dist stack distance of the node below
-     * @param discard_node whether the calling node was discarded or not
-     * @return The stack distance of the current address.
-     *
-     */
-    uint64_t updateSum(Node* node,
-                       bool from_left, uint64_t sum_from_below, uint64_t level,
-                       uint64_t stack_dist, bool discard_node);
+    typedef std::unordered_map<Addr, Line> AddressLineMap;
 
     /**
-     * Updates the leaf nodes and nodes above. This function is
-     * called by the calcStackDistAndUpdate.
-     *
-     * @param node pointer to the node which is updated
-     * @param is_new_leaf is true if this is a newly added node
-     * @return The stack distance of the current address.
+     * Add to the number of addresses last accessed in a slot.
      *
+     * @param slot slot to update
+     * @param delta value to add
      */
-    uint64_t updateSumsLeavesToRoot(Node* node, bool is_new_leaf);
+    void updateSlot(uint64_t slot, int64_t delta);
 
     /**
-     * updateTree is a tree balancing operation, which maintains the
-     * binary tree structure.
-     * This method is called whenever index%2 == 0 (i.e. every
-     * alternate cycle) The two main operation are :
-     * OP1. Moving the root node one layer up if index counter
-     *       crosses power of 2
-     * OP2. Addition of intermediate nodes as and when required
-     *      and linking them to their parents in the layer above.
+     * Count the addresses last accessed after a slot, i.e. the stack
+     * distance of the address last accessed in the slot.
+     *
+     * @param slot slot of the address
+     * @return The number of addresses in later slots.
      */
-    void updateTree();
+    uint64_t countAfter(uint64_t slot) const;
 
     /**
-     * This method is used for verification purposes
-     * It recursively traverses upwards from the given node till
-     * the root to check if the ultimate parent node (root-node) points
-     * to null.
-     *
-     * @param node pointer to the node whose sanity is being checked
-     * @param level the level at which this node is located in the tree
+     * Find the earliest slot in use, i.e. the slot of the least
+     * recently used address on the stack.
      *
+     * @return The earliest slot in use.
      */
-    void sanityCheckTree(const Node* node, uint64_t level = 0) const;
+    uint64_t firstSlot() const;
 
     /**
-     * Return the counter for address accesses (unique and
-     * non-unique). This is further used to dump stats at
-     * regular intervals.
+     * Take a new slot at the top of the stack. If all slots have
+     * been used, the addresses on the stack are renumbered in the
+     * order of their last access and the tree is rebuilt, growing it
+     * if more than half of it would be in use.
      *
-     * @return The stack distance of the current address.
+     * @return The new slot.
      */
-    uint64_t getIndex() const { return index; }
+    uint64_t nextSlot();
 
     /**
-     * Query depth of the tree (tree[0] represents leaf layer while
-     * tree[treeDepth] represents the root layer, all layers in
-     * between contain intermediate nodes)
+     * Remove an address from the stack.
      *
-     * @return Tree depth
+     * @param line iterator to the address to remove
      */
-    uint64_t getTreeDepth() const { return tree.size() - 1; }
+    void removeLine(AddressLineMap::iterator line);
 
     /**
      * Print the last n items on the stack.
-     * This method prints top n entries in the tree based implementation as
-     * well as dummy stack.
+     * This method prints top n entries in the calculator as well as
+     * the dummy stack.
      * @param n Number of entries to print
      */
     void printStack(int n = 5) const;
@@ -290,7 +213,6 @@ class StackDistCalc
      * This is an alternative implementation of the stack-distance
      * in a naive way. It uses simple STL vector to represent the stack.
      * It can be used in parallel for debugging purposes.
-     * It is 10x slower than the tree based implemenation.
      *
      * @param r_address The current address to process
      * @param update_stack Flag to indicate if stack should be updated
@@ -302,9 +224,11 @@ class StackDistCalc
                              bool update_stack = false);
 
   public:
-    StackDistCalc(bool verify_stack = false);
-
-    ~StackDistCalc();
+    /**
+     * @param verify_stack check every distance against a naive stack
+     * @param max_dist largest distance to track, 0 for no limit
+     */
+    StackDistCalc(bool verify_stack = false, uint64_t max_dist = 0);
 
     /**
      * A convenient way of refering to infinity.
@@ -314,7 +238,7 @@ class StackDistCalc
 
     /**
      * Process the given address. If Mark is true then set the
-     * mark flag of the leaf node.
+     * mark flag of the address.
      * This function returns the stack distance of the incoming
      * address and the previous status of the mark flag.
      *
@@ -327,14 +251,14 @@ class StackDistCalc
 
     /**
      * Process the given address:
-     *  - Lookup the tree for the given address
-     *  - delete old node if found in tree
-     *  - add a new node (if addNewNode flag is set)
+     *  - Lookup the stack for the given address
+     *  - remove it from the stack if found
+     *  - push it on the top of the stack (if addNewNode flag is set)
      * This function returns the stack distance of the incoming
      * address and the status of the mark flag.
      *
      * @param r_address The current address to process
-     * @param addNewNode If true, a new node is added to the tree
+     * @param addNewNode If true, the address is pushed on the stack
      * @return The stack distance of the current address and the mark flag.
      */
     std::pair<uint64_t, bool> calcStackDistAndUpdate(const Addr r_address,
@@ -342,66 +266,20 @@ class StackDistCalc
 
   private:
 
-    /**
-     * Node which takes form of Leaf, INode or Root
-     */
-    struct Node{
-        // Sum of the left children
-        uint64_t sumLeft;
-
-        // Sum of the right children
-        uint64_t sumRight;
-
-        // Flag to indicate that sumLeft has gone from non-zero value to 0
-        bool discardLeft;
-
-        // Flag to indicate that sumRight has gone from non-zero value to 0
-        bool discardRight;
-
-        // Index of the current element in the Map
-        uint64_t nodeIndex;
-
-        // Pointer to the parent
-        Node* parent;
-
-        // Flag to mark the node as the right/left child
-        bool isLeftNode;
+    // Addresses on the stack and the slot of their last access
+    AddressLineMap lines;
 
-        /**
-         * Flag to indicate if this address is marked. Used in case
-         * where stack distance of a touched address is required.
-         */
-        bool isMarked;
-
-        /**
-         * The discard flags are false by default they become true if
-         * the node is reached again in a future lookup.
-         */
-        Node() : sumLeft(0), sumRight(0), discardLeft(false),
-                 discardRight(false), nodeIndex(0),
-                 parent(nullptr), isLeftNode(true), isMarked(false)
-        { }
-    };
-
-    /**
-     * Internal counter for address accesses (unique and non-unique)
-     * This counter increments everytime the calcStackDist() method is
-     * called. This counter is used as a key for the hash- map at the
-     * leaf layer. Practically at every call to the calculator this
-     * counter is incremented and a new leaf node is added in the tree
-     * at the leaf layer using this counter value as the key.
-     */
-    uint64_t index;
+    // Fenwick tree counting the addresses last accessed in each slot
+    std::vector<uint64_t> tree;
 
-    // Binary tree of partial sums
-    TreeType tree;
+    // Address last accessed in each slot, valid for the slots in use
+    std::vector<Addr> slotAddrs;
 
-    // Hash map which returns last seen index of each address
-    AddressIndexMap aiMap;
+    // Next free slot
+    uint64_t nextFree;
 
-    // Keeps count of number of the next unique index for each
-    // level in the tree
-    std::vector<uint64_t> nextIndex;
+    // Largest distance tracked, Infinity for no limit
+    const uint64_t maxDist;
 
     // Dummy Stack for verification
     std::vector<uint64_t> stack;
@@ -411,4 +289,4 @@ class StackDistCalc
 };
 
 
-#endif //__STACK_DIST_CALC_HH__
+#endif //__MEM_STACK_DIST_CALC_HH__
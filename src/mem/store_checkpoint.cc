@@ -0,0 +1,388 @@
+/*
+ * Copyright (c) 2020 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/store_checkpoint.hh"
+
+#include <fcntl.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "base/intmath.hh"
+#include "base/logging.hh"
+#include "sim/byteswap.hh"
+
+using namespace std;
+
+namespace
+{
+
+/**
+ * Layout of a chunked memory checkpoint file: a header, followed by the
+ * data of all the stored chunks, followed by an index with one entry per
+ * chunk of the backing store. All fields are stored little endian.
+ */
+const char chunkedMagic[8] = { 'G', '5', 'P', 'M', 'E', 'M', 'C', 'K' };
+const uint32_t chunkedVersion = 1;
+
+/** Size of the independently compressed chunks. */
+const uint32_t chunkedChunkSize = 256 * 1024;
+
+struct ChunkedHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t chunkSize;
+    uint64_t rangeSize;
+    /** File offset of the chunk index. */
+    uint64_t indexOffset;
+};
+
+struct ChunkedIndexEntry
+{
+    /** File offset of the chunk data. */
+    uint64_t offset;
+    /** Size of the stored data, zero if the chunk only holds zeros. */
+    uint32_t size;
+    /** Whether the data is deflated, or stored as is. */
+    uint32_t compressed;
+};
+
+/**
+ * Call func(item, worker) for every item in [0, num_items) using a pool
+ * of worker threads, each claiming the next unprocessed item.
+ */
+void
+parallelFor(unsigned threads, uint64_t num_items,
+            const std::function<void(uint64_t, unsigned)> &func)
+{
+    threads = std::min<uint64_t>(threads, num_items);
+    std::atomic<uint64_t> next(0);
+    auto worker = [&](unsigned id) {
+        for (uint64_t i = next++; i < num_items; i = next++)
+            func(i, id);
+    };
+
+    if (threads <= 1) {
+        worker(0);
+        return;
+    }
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t)
+        pool.emplace_back(worker, t);
+    worker(0);
+    for (auto &t : pool)
+        t.join();
+}
+
+bool
+isZero(const uint8_t *data, size_t size)
+{
+    for (size_t i = 0; i < size / sizeof(uint64_t); ++i) {
+        uint64_t word;
+        memcpy(&word, data + i * sizeof(uint64_t), sizeof(word));
+        if (word)
+            return false;
+    }
+    for (size_t i = size - size % sizeof(uint64_t); i < size; ++i) {
+        if (data[i])
+            return false;
+    }
+    return true;
+}
+
+bool
+preadAll(int fd, void *buf, size_t size, off_t offset)
+{
+    uint8_t *dst = static_cast<uint8_t *>(buf);
+    while (size) {
+        ssize_t ret = pread(fd, dst, size, offset);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0)
+            return false;
+        dst += ret;
+        offset += ret;
+        size -= ret;
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+namespace StoreCheckpoint
+{
+
+unsigned
+hostThreads(unsigned threads)
+{
+    if (threads)
+        return threads;
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void
+writeChunked(const string &filepath, const uint8_t *pmem,
+             uint64_t range_size, unsigned threads)
+{
+    FILE *mem_file = fopen(filepath.c_str(), "wb");
+    if (mem_file == NULL)
+        fatal("Can't open physical memory checkpoint file '%s'\n",
+              filepath);
+
+    const uint64_t nbr_of_chunks = divCeil(range_size, chunkedChunkSize);
+    vector<ChunkedIndexEntry> index(nbr_of_chunks);
+
+    // leave room for the header, which is written once the location of
+    // the index is known
+    ChunkedHeader header;
+    memset(&header, 0, sizeof(header));
+    if (fwrite(&header, sizeof(header), 1, mem_file) != 1)
+        fatal("Write failed on physical memory checkpoint file '%s'\n",
+              filepath);
+    uint64_t offset = sizeof(header);
+
+    // compress the chunks in batches to bound the amount of host memory
+    // holding compressed data that is still to be written
+    const uint64_t batch_size = threads * 16;
+    vector<vector<uint8_t>> batch(batch_size);
+    vector<uint8_t> deflated(batch_size);
+    atomic<bool> failed(false);
+
+    for (uint64_t first = 0; first < nbr_of_chunks; first += batch_size) {
+        const uint64_t count = min(batch_size, nbr_of_chunks - first);
+
+        parallelFor(threads, count,
+                    [&](uint64_t i, unsigned worker) {
+            const uint64_t start = (first + i) * chunkedChunkSize;
+            const uint8_t *data = pmem + start;
+            const uLong len = min<uint64_t>(chunkedChunkSize,
+                                            range_size - start);
+            vector<uint8_t> &out = batch[i];
+
+            if (isZero(data, len)) {
+                out.clear();
+                return;
+            }
+
+            uLongf out_len = compressBound(len);
+            out.resize(out_len);
+            if (compress2(out.data(), &out_len, data, len,
+                          Z_BEST_SPEED) != Z_OK) {
+                failed = true;
+                return;
+            }
+
+            // keep incompressible chunks as they are
+            deflated[i] = out_len < len;
+            if (deflated[i])
+                out.resize(out_len);
+            else
+                out.assign(data, data + len);
+        });
+
+        if (failed)
+            fatal("Compression failed on physical memory checkpoint "
+                  "file '%s'\n", filepath);
+
+        for (uint64_t i = 0; i < count; ++i) {
+            ChunkedIndexEntry &entry = index[first + i];
+            entry.offset = htole(offset);
+            entry.size = htole<uint32_t>(batch[i].size());
+            entry.compressed = htole<uint32_t>(deflated[i]);
+            if (batch[i].empty())
+                continue;
+
+            if (fwrite(batch[i].data(), batch[i].size(), 1, mem_file) != 1)
+                fatal("Write failed on physical memory checkpoint "
+                      "file '%s'\n", filepath);
+            offset += batch[i].size();
+        }
+    }
+
+    if (nbr_of_chunks && fwrite(index.data(), sizeof(ChunkedIndexEntry),
+                                nbr_of_chunks, mem_file) != nbr_of_chunks) {
+        fatal("Write failed on physical memory checkpoint file '%s'\n",
+              filepath);
+    }
+
+    memcpy(header.magic, chunkedMagic, sizeof(header.magic));
+    header.version = htole(chunkedVersion);
+    header.chunkSize = htole(chunkedChunkSize);
+    header.rangeSize = htole(range_size);
+    header.indexOffset = htole(offset);
+    if (fseek(mem_file, 0, SEEK_SET) ||
+        fwrite(&header, sizeof(header), 1, mem_file) != 1) {
+        fatal("Write failed on physical memory checkpoint file '%s'\n",
+              filepath);
+    }
+
+    if (fclose(mem_file))
+        fatal("Close failed on physical memory checkpoint file '%s'\n",
+              filepath);
+}
+
+void
+readChunked(const string &filepath, uint8_t *pmem, uint64_t range_size,
+            unsigned threads)
+{
+    int fd = open(filepath.c_str(), O_RDONLY);
+    if (fd == -1)
+        fatal("Can't open physical memory checkpoint file '%s'\n", filepath);
+
+    ChunkedHeader header;
+    if (!preadAll(fd, &header, sizeof(header), 0) ||
+        memcmp(header.magic, chunkedMagic, sizeof(header.magic)) ||
+        letoh(header.version) != chunkedVersion) {
+        fatal("Physical memory checkpoint file '%s' is not a chunked "
+              "checkpoint\n", filepath);
+    }
+
+    const uint32_t chunk_size = letoh(header.chunkSize);
+    fatal_if(letoh(header.rangeSize) != range_size || chunk_size == 0,
+             "Physical memory checkpoint file '%s' does not match the "
+             "size of the backing store\n", filepath);
+
+    const uint64_t nbr_of_chunks = divCeil(range_size, chunk_size);
+    vector<ChunkedIndexEntry> index(nbr_of_chunks);
+    if (!preadAll(fd, index.data(), nbr_of_chunks * sizeof(index[0]),
+                  letoh(header.indexOffset))) {
+        fatal("Read failed on physical memory checkpoint file '%s'\n",
+              filepath);
+    }
+
+    // only copy host pages that are non-zero, so we don't give the VM
+    // system hell; the backing store is freshly mapped and reads as zero
+    const size_t page_size = sysconf(_SC_PAGESIZE);
+
+    vector<vector<uint8_t>> in_bufs(threads);
+    vector<vector<uint8_t>> out_bufs(threads);
+    atomic<bool> failed(false);
+
+    parallelFor(threads, nbr_of_chunks,
+                [&](uint64_t i, unsigned worker) {
+        const ChunkedIndexEntry &entry = index[i];
+        const uint32_t size = letoh(entry.size);
+        if (size == 0)
+            return;
+
+        const uint64_t start = i * chunk_size;
+        const uLong len = min<uint64_t>(chunk_size, range_size - start);
+        vector<uint8_t> &in = in_bufs[worker];
+        vector<uint8_t> &out = out_bufs[worker];
+
+        in.resize(size);
+        if (!preadAll(fd, in.data(), size, letoh(entry.offset))) {
+            failed = true;
+            return;
+        }
+
+        const uint8_t *data = in.data();
+        if (letoh(entry.compressed)) {
+            uLongf out_len = len;
+            out.resize(len);
+            if (uncompress(out.data(), &out_len, in.data(), size) != Z_OK ||
+                out_len != len) {
+                failed = true;
+                return;
+            }
+            data = out.data();
+        } else if (size != len) {
+            failed = true;
+            return;
+        }
+
+        for (uint64_t off = 0; off < len; off += page_size) {
+            const size_t bytes = min<uint64_t>(page_size, len - off);
+            if (!isZero(data + off, bytes))
+                memcpy(pmem + start + off, data + off, bytes);
+        }
+    });
+
+    close(fd);
+
+    if (failed)
+        fatal("Read failed on physical memory checkpoint file '%s'\n",
+              filepath);
+}
+
+void
+writeImage(const string &filepath, const uint8_t *pmem,
+           uint64_t range_size, unsigned threads)
+{
+    int fd = open(filepath.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+    if (fd == -1)
+        fatal("Can't open physical memory checkpoint file '%s'\n",
+              filepath);
+
+    // size the file up front so that pages that only contain zeros can
+    // be left as holes, keeping the image sparse on disk
+    if (ftruncate(fd, range_size))
+        fatal("Setting size of physical memory checkpoint file '%s' "
+              "failed\n", filepath);
+
+    const size_t page_size = sysconf(_SC_PAGESIZE);
+    const uint64_t nbr_of_chunks = divCeil(range_size, chunkedChunkSize);
+    atomic<bool> failed(false);
+
+    parallelFor(threads, nbr_of_chunks,
+                [&](uint64_t i, unsigned worker) {
+        const uint64_t start = i * chunkedChunkSize;
+        const uint64_t end = min<uint64_t>(start + chunkedChunkSize,
+                                           range_size);
+        for (uint64_t off = start; off < end; off += page_size) {
+            const size_t bytes = min<uint64_t>(page_size, end - off);
+            if (isZero(pmem + off, bytes))
+                continue;
+            if (pwrite(fd, pmem + off, bytes, off) != (ssize_t)bytes) {
+                failed = true;
+                return;
+            }
+        }
+    });
+
+    if (failed)
+        fatal("Write failed on physical memory checkpoint file '%s'\n",
+              filepath);
+
+    if (close(fd))
+        fatal("Close failed on physical memory checkpoint file '%s'\n",
+              filepath);
+}
+
+} // namespace StoreCheckpoint
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2020 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Checkpoint files holding the contents of a physical memory backing
+ * store.
+ *
+ * The chunked format splits the store into independently compressed
+ * chunks, such that they can be compressed and decompressed in parallel,
+ * and leaves out the chunks that only contain zeros. The image format is
+ * an uncompressed copy of the store with the zero pages left as holes,
+ * meant to be mapped rather than read back.
+ */
+
+#ifndef __MEM_STORE_CHECKPOINT_HH__
+#define __MEM_STORE_CHECKPOINT_HH__
+
+#include <cstdint>
+#include <string>
+
+namespace StoreCheckpoint
+{
+
+/**
+ * Get the number of host threads to use for a checkpoint.
+ *
+ * @param threads The requested number of threads, zero for all the
+ *                host threads
+ * @return The number of threads to use
+ */
+unsigned hostThreads(unsigned threads);
+
+/**
+ * Write a backing store as a set of independently compressed chunks.
+ *
+ * @param filepath Path of the file to create
+ * @param pmem The host pointer to the backing store
+ * @param range_size The size of the backing store
+ * @param threads The number of host threads compressing chunks
+ */
+void writeChunked(const std::string &filepath, const uint8_t *pmem,
+                  uint64_t range_size, unsigned threads);
+
+/**
+ * Restore a backing store from a chunked checkpoint file. Only host
+ * pages holding non-zero data are written, so the store is expected to
+ * read as zero beforehand.
+ *
+ * @param filepath Path of the file to read
+ * @param pmem The host pointer to the backing store
+ * @param range_size The size of the backing store
+ * @param threads The number of host threads decompressing chunks
+ */
+void readChunked(const std::string &filepath, uint8_t *pmem,
+                 uint64_t range_size, unsigned threads);
+
+/**
+ * Write a backing store as an uncompressed image, with pages that only
+ * contain zeros left as holes in the file.
+ *
+ * @param filepath Path of the file to create
+ * @param pmem The host pointer to the backing store
+ * @param range_size The size of the backing store
+ * @param threads The number of host threads writing pages
+ */
+void writeImage(const std::string &filepath, const uint8_t *pmem,
+                uint64_t range_size, unsigned threads);
+
+} // namespace StoreCheckpoint
+
+#endif //__MEM_STORE_CHECKPOINT_HH__
@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2020 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "mem/store_checkpoint.hh"
+
+namespace
+{
+
+const uint64_t chunkSize = 256 * 1024;
+
+/** Create an empty temporary file and return its path. */
+std::string
+tempFile()
+{
+    char name[] = "/tmp/store_checkpoint.test.XXXXXX";
+    int fd = mkstemp(name);
+    EXPECT_GE(fd, 0);
+    close(fd);
+    return name;
+}
+
+uint64_t
+fileSize(const std::string &name)
+{
+    struct stat st;
+    EXPECT_EQ(stat(name.c_str(), &st), 0);
+    return st.st_size;
+}
+
+/**
+ * A store ending in a partial chunk, with chunks of random data, zeros,
+ * a repeating pattern and a few scattered bytes.
+ */
+std::vector<uint8_t>
+makeStore()
+{
+    std::vector<uint8_t> store(4 * chunkSize + 5000, 0);
+    std::mt19937 rng(0x5eed);
+    for (uint64_t i = 0; i < chunkSize; ++i)
+        store[i] = rng();
+    for (uint64_t i = 2 * chunkSize; i < 3 * chunkSize; ++i)
+        store[i] = i % 7;
+    for (uint64_t i = 3 * chunkSize; i < 4 * chunkSize; i += 10007)
+        store[i] = 0xff;
+    for (uint64_t i = 4 * chunkSize; i < store.size(); ++i)
+        store[i] = rng();
+    return store;
+}
+
+} // anonymous namespace
+
+TEST(StoreCheckpointTest, ChunkedRoundTrip)
+{
+    const std::vector<uint8_t> store = makeStore();
+    for (unsigned threads : { 1, 3 }) {
+        std::string name = tempFile();
+        StoreCheckpoint::writeChunked(name, store.data(), store.size(),
+                                      threads);
+
+        std::vector<uint8_t> restored(store.size(), 0);
+        StoreCheckpoint::readChunked(name, restored.data(), restored.size(),
+                                     threads);
+        EXPECT_EQ(restored, store);
+        unlink(name.c_str());
+    }
+}
+
+TEST(StoreCheckpointTest, ChunkedZeroStore)
+{
+    const std::vector<uint8_t> store(3 * chunkSize, 0);
+    std::string name = tempFile();
+    StoreCheckpoint::writeChunked(name, store.data(), store.size(), 2);
+
+    // only the header and the index are stored
+    EXPECT_LT(fileSize(name), 4096);
+
+    std::vector<uint8_t> restored(store.size(), 0);
+    StoreCheckpoint::readChunked(name, restored.data(), restored.size(), 2);
+    EXPECT_EQ(restored, store);
+    unlink(name.c_str());
+}
+
+TEST(StoreCheckpointTest, ChunkedSkipsZeroPages)
+{
+    const std::vector<uint8_t> store = makeStore();
+    std::string name = tempFile();
+    StoreCheckpoint::writeChunked(name, store.data(), store.size(), 1);
+
+    // pages that only hold zeros are left as they are
+    const uint64_t page_size = sysconf(_SC_PAGESIZE);
+    std::vector<uint8_t> restored(store.size(), 0xa5);
+    StoreCheckpoint::readChunked(name, restored.data(), restored.size(), 1);
+    for (uint64_t off = 0; off < store.size(); off += page_size) {
+        auto begin = store.begin() + off;
+        auto end = store.begin() + std::min(off + page_size, store.size());
+        bool zero = std::all_of(begin, end, [](uint8_t b) { return !b; });
+        if (zero) {
+            EXPECT_EQ(restored[off], 0xa5);
+        } else {
+            EXPECT_TRUE(std::equal(begin, end, restored.begin() + off));
+        }
+    }
+    unlink(name.c_str());
+}
+
+TEST(StoreCheckpointTest, ChunkedSizeMismatch)
+{
+    const std::vector<uint8_t> store = makeStore();
+    std::string name = tempFile();
+    StoreCheckpoint::writeChunked(name, store.data(), store.size(), 1);
+
+    std::vector<uint8_t> restored(store.size() + chunkSize, 0);
+    EXPECT_ANY_THROW(StoreCheckpoint::readChunked(name, restored.data(),
+                                                  restored.size(), 1));
+    unlink(name.c_str());
+}
+
+TEST(StoreCheckpointTest, NotChunked)
+{
+    std::string name = tempFile();
+    std::ofstream(name) << "not a memory checkpoint";
+
+    std::vector<uint8_t> restored(chunkSize, 0);
+    EXPECT_ANY_THROW(StoreCheckpoint::readChunked(name, restored.data(),
+                                                  restored.size(), 1));
+    unlink(name.c_str());
+}
+
+TEST(StoreCheckpointTest, ImageRoundTrip)
+{
+    const std::vector<uint8_t> store = makeStore();
+    std::string name = tempFile();
+    StoreCheckpoint::writeImage(name, store.data(), store.size(), 3);
+
+    std::ifstream in(name, std::ios::binary);
+    std::vector<uint8_t> image((std::istreambuf_iterator<char>(in)),
+                               std::istreambuf_iterator<char>());
+    EXPECT_EQ(image, store);
+    unlink(name.c_str());
+}
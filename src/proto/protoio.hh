@@ -49,7 +49,15 @@
 #include <google/protobuf/io/zero_copy_stream_impl.h>
 #include <google/protobuf/message.h>
 
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <deque>
 #include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 /**
  * A ProtoStream provides the shared functionality of the input and
@@ -201,4 +209,180 @@ class ProtoInputStream : public ProtoStream
 
 };
 
+/**
+ * A ProtoPrefetchStream reads messages of a single type from a
+ * ProtoInputStream on a background thread, so that decompressing and
+ * parsing the trace overlaps with the consumer. The parsed messages are
+ * handed over in batches through a bounded queue. Headers preceding the
+ * messages are read synchronously before the first message is requested
+ * and the thread is started. If the queue depth is zero, all messages
+ * are read on the calling thread.
+ */
+template <class Msg>
+class ProtoPrefetchStream
+{
+
+  public:
+
+    /**
+     * Create a prefetching stream for a given file name.
+     *
+     * @param filename Path to the file to read from
+     * @param max_batches Number of parsed batches to buffer ahead
+     * @param batch_size Number of messages in each batch
+     */
+    ProtoPrefetchStream(const std::string& filename, size_t max_batches,
+                        size_t batch_size)
+        : stream(filename), maxBatches(max_batches),
+          batchSize(std::max<size_t>(batch_size, 1)), pos(0),
+          running(false), stopping(false), done(false)
+    {}
+
+    /**
+     * Stop the reader thread, if any, before closing the file.
+     */
+    ~ProtoPrefetchStream() { stop(); }
+
+    /**
+     * Read a message synchronously, e.g., a header. This must only be
+     * used before the first call to read() after construction or reset.
+     *
+     * @param msg Message read from the stream
+     * @param return True if a message was read, false if reading fails
+     */
+    bool
+    readHeader(google::protobuf::Message& msg)
+    {
+        assert(!running);
+        return stream.read(msg);
+    }
+
+    /**
+     * Read the next message from the stream.
+     *
+     * @param msg Message read from the stream
+     * @param return True if a message was read, false at the end
+     */
+    bool
+    read(Msg& msg)
+    {
+        if (maxBatches == 0)
+            return stream.read(msg);
+
+        if (pos == current.size() && !nextBatch())
+            return false;
+
+        msg.Swap(&current[pos++]);
+        return true;
+    }
+
+    /**
+     * Stop prefetching and seek to the beginning of the file. Any
+     * headers have to be read again.
+     */
+    void
+    reset()
+    {
+        stop();
+        stream.reset();
+        current.clear();
+        pos = 0;
+        done = false;
+    }
+
+  private:
+
+    /** Wait for the next batch from the reader thread. */
+    bool
+    nextBatch()
+    {
+        if (!running) {
+            running = true;
+            reader = std::thread(&ProtoPrefetchStream::prefetch, this);
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [this]{ return !batches.empty() || done; });
+        if (batches.empty())
+            return false;
+
+        current.swap(batches.front());
+        batches.pop_front();
+        pos = 0;
+        notFull.notify_one();
+        return true;
+    }
+
+    /** Body of the reader thread. */
+    void
+    prefetch()
+    {
+        bool more = true;
+        while (more) {
+            std::vector<Msg> batch(batchSize);
+            size_t n = 0;
+            while (n < batchSize && stream.read(batch[n]))
+                ++n;
+            more = n == batchSize;
+            batch.resize(n);
+
+            std::unique_lock<std::mutex> lock(mutex);
+            notFull.wait(lock, [this]{
+                return batches.size() < maxBatches || stopping; });
+            if (stopping)
+                return;
+            if (n)
+                batches.push_back(std::move(batch));
+            done = !more;
+            notEmpty.notify_one();
+        }
+    }
+
+    /** Stop the reader thread and drop the prefetched batches. */
+    void
+    stop()
+    {
+        if (!running)
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        notFull.notify_all();
+        reader.join();
+
+        running = false;
+        stopping = false;
+        batches.clear();
+    }
+
+    /// Underlying input stream, only used by the reader thread once it
+    /// has been started
+    ProtoInputStream stream;
+
+    /// Maximum number of batches buffered ahead of the consumer
+    const size_t maxBatches;
+
+    /// Number of messages parsed per batch
+    const size_t batchSize;
+
+    /// Batch currently being consumed and the position in it
+    std::vector<Msg> current;
+    size_t pos;
+
+    /// Batches parsed ahead of the consumer
+    std::deque<std::vector<Msg>> batches;
+
+    /// Protects batches, stopping and done
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+
+    std::thread reader;
+    bool running;
+    bool stopping;
+    bool done;
+};
+
 #endif //__PROTO_PROTOIO_HH
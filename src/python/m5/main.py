@@ -118,6 +118,9 @@ def parse_options():
     option("--stats-help",
            action="callback", callback=_stats_help,
            help="Display documentation for available stat visitors")
+    option("--event-profile", metavar="FILE", default=None,
+        help="Measure the host time spent in each event and write a JSON " \
+             "report, grouped by event and SimObject, to FILE at exit")
 
     # Configuration Options
     group("Configuration Options")
@@ -366,6 +369,9 @@ def main(*args):
     # set stats options
     stats.addStatVisitor(options.stats_file)
 
+    if options.event_profile:
+        event.enableProfiling(options.event_profile)
+
     # Disable listeners unless running interactively or explicitly
     # enabled
     if options.listener_mode == "off":
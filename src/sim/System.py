@@ -48,6 +48,8 @@ from m5.objects.SimpleMemory import *
 class MemoryMode(Enum): vals = ['invalid', 'atomic', 'timing',
                                 'atomic_noncaching']
 
+class MemCheckpointFormat(Enum): vals = ['gzip', 'chunked', 'image']
+
 if buildEnv['TARGET_ISA'] in ('sparc', 'power'):
     default_byte_order = 'big'
 else:
@@ -87,6 +89,20 @@ class System(SimObject):
         "use to directly address the backstore from another host-OS process. "
         "Leave this empty to unset the MAP_SHARED flag.")
 
+    # The backing store can either be checkpointed as a single gzip
+    # stream, or as independently compressed chunks that are written and
+    # restored by multiple host threads, skipping chunks that only contain
+    # zeros. Alternatively, an uncompressed image of the store can be
+    # written, which is mapped copy-on-write when restoring, making the
+    # restore cost proportional to the memory touched and letting many
+    # simulations share the same pages. All formats can always be
+    # restored.
+    mem_checkpoint_format = Param.MemCheckpointFormat('gzip',
+        "Format of the backing store files written when checkpointing")
+    mem_checkpoint_threads = Param.Unsigned(0, "Number of host threads "
+        "used to (de)compress chunked memory checkpoints, 0 to use all "
+        "host cores")
+
     cache_line_size = Param.Unsigned(64, "Cache line size in bytes")
 
     byte_order = Param.ByteOrder(default_byte_order,
@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2020 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sim/event_profile.hh"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include "base/cprintf.hh"
+#include "base/logging.hh"
+#include "base/output.hh"
+#include "sim/core.hh"
+#include "sim/eventq.hh"
+#include "sim/sim_object.hh"
+
+bool EventProfile::_enabled = false;
+
+namespace
+{
+
+std::string profileFilename;
+
+//! Profiles of all event queues, merged when the report is written.
+std::mutex profilesMutex;
+std::vector<std::unique_ptr<EventProfile>> profiles;
+
+struct Totals
+{
+    uint64_t count = 0;
+    uint64_t hostNs = 0;
+};
+
+/**
+ * Find the SimObject an event belongs to. Event names are derived from the
+ * name of their owner (e.g., "system.cpu.wrapped_function_event"), so strip
+ * components from the end of the name until it names a SimObject.
+ */
+std::string
+findOwner(const std::string &event_name,
+          std::map<std::string, std::string> &cache)
+{
+    auto it = cache.find(event_name);
+    if (it != cache.end())
+        return it->second;
+
+    std::string owner = event_name;
+    while (!SimObject::find(owner.c_str())) {
+        std::string::size_type pos = owner.rfind('.');
+        if (pos == std::string::npos) {
+            owner = "";
+            break;
+        }
+        owner.erase(pos);
+    }
+
+    cache[event_name] = owner;
+    return owner;
+}
+
+void
+writeString(std::ostream &os, const std::string &str)
+{
+    os << '"';
+    for (char c : str) {
+        switch (c) {
+          case '"':
+            os << "\\\"";
+            break;
+          case '\\':
+            os << "\\\\";
+            break;
+          case '\n':
+            os << "\\n";
+            break;
+          default:
+            if ((unsigned char)c < 0x20)
+                ccprintf(os, "\\u%04x", (unsigned)c);
+            else
+                os << c;
+        }
+    }
+    os << '"';
+}
+
+} // anonymous namespace
+
+void
+EventProfile::enable(const std::string &filename)
+{
+    if (_enabled)
+        return;
+
+    _enabled = true;
+    profileFilename = filename;
+    registerExitCallback([]() { dump(); });
+}
+
+EventProfile *
+EventProfile::create()
+{
+    std::lock_guard<std::mutex> lock(profilesMutex);
+    profiles.emplace_back(new EventProfile());
+    return profiles.back().get();
+}
+
+void
+EventProfile::record(const Event *event, Clock::duration elapsed)
+{
+    Entry &entry = entries.emplace(event->name(),
+        Entry{event->description(), 0, 0}).first->second;
+    entry.count++;
+    entry.hostNs +=
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+}
+
+void
+EventProfile::dump()
+{
+    std::lock_guard<std::mutex> lock(profilesMutex);
+
+    // Merge the per-queue profiles.
+    std::map<std::string, Entry> events;
+    for (const auto &profile : profiles) {
+        for (const auto &entry : profile->entries) {
+            auto it = events.emplace(entry.first,
+                Entry{entry.second.description, 0, 0}).first;
+            it->second.count += entry.second.count;
+            it->second.hostNs += entry.second.hostNs;
+        }
+    }
+
+    std::map<std::string, std::string> owner_cache;
+    std::map<std::string, Totals> owners;
+    Totals total;
+    for (const auto &event : events) {
+        Totals &owner = owners[findOwner(event.first, owner_cache)];
+        owner.count += event.second.count;
+        owner.hostNs += event.second.hostNs;
+        total.count += event.second.count;
+        total.hostNs += event.second.hostNs;
+    }
+
+    // Report the most expensive entries first.
+    std::vector<std::map<std::string, Entry>::const_iterator> event_order;
+    for (auto it = events.cbegin(); it != events.cend(); ++it)
+        event_order.push_back(it);
+    std::stable_sort(event_order.begin(), event_order.end(),
+                     [](std::map<std::string, Entry>::const_iterator a,
+                        std::map<std::string, Entry>::const_iterator b) {
+                         return a->second.hostNs > b->second.hostNs;
+                     });
+
+    std::vector<std::map<std::string, Totals>::const_iterator> owner_order;
+    for (auto it = owners.cbegin(); it != owners.cend(); ++it)
+        owner_order.push_back(it);
+    std::stable_sort(owner_order.begin(), owner_order.end(),
+                     [](std::map<std::string, Totals>::const_iterator a,
+                        std::map<std::string, Totals>::const_iterator b) {
+                         return a->second.hostNs > b->second.hostNs;
+                     });
+
+    OutputStream *out = simout.create(profileFilename);
+    if (!out) {
+        warn("Unable to write event profile to %s\n", profileFilename);
+        return;
+    }
+    std::ostream &os = *out->stream();
+
+    ccprintf(os, "{\n  \"count\": %d,\n  \"host_ns\": %d,\n",
+             total.count, total.hostNs);
+
+    os << "  \"sim_objects\": [";
+    for (auto it = owner_order.begin(); it != owner_order.end(); ++it) {
+        os << (it == owner_order.begin() ? "\n" : ",\n") << "    {\"name\": ";
+        writeString(os, (*it)->first);
+        ccprintf(os, ", \"count\": %d, \"host_ns\": %d}",
+                 (*it)->second.count, (*it)->second.hostNs);
+    }
+    os << "\n  ],\n";
+
+    os << "  \"events\": [";
+    for (auto it = event_order.begin(); it != event_order.end(); ++it) {
+        os << (it == event_order.begin() ? "\n" : ",\n") << "    {\"name\": ";
+        writeString(os, (*it)->first);
+        os << ", \"description\": ";
+        writeString(os, (*it)->second.description);
+        os << ", \"sim_object\": ";
+        writeString(os, findOwner((*it)->first, owner_cache));
+        ccprintf(os, ", \"count\": %d, \"host_ns\": %d}",
+                 (*it)->second.count, (*it)->second.hostNs);
+    }
+    os << "\n  ]\n}\n";
+
+    simout.close(out);
+}
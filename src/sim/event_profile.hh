@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2020 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Host time accounting for simulator events.
+ *
+ * When enabled, EventQueue::serviceOne() measures the host time spent in
+ * every Event::process() call and charges it to the name of the event. At
+ * exit the samples from all event queues are merged, each event is
+ * attributed to the SimObject that owns it and a JSON report is written to
+ * the output directory.
+ */
+
+#ifndef __SIM_EVENT_PROFILE_HH__
+#define __SIM_EVENT_PROFILE_HH__
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+class Event;
+
+class EventProfile
+{
+  public:
+    typedef std::chrono::steady_clock Clock;
+
+    /** Samples charged to a single event name. */
+    struct Entry
+    {
+        const char *description;
+        uint64_t count;
+        uint64_t hostNs;
+    };
+
+    /**
+     * Turn on event profiling and write the report to the given file
+     * in the output directory when the simulator exits. Must be called
+     * before simulation starts.
+     */
+    static void enable(const std::string &filename);
+
+    /** Is event profiling turned on? */
+    static bool enabled() { return _enabled; }
+
+    /**
+     * Create the profile of an event queue. The profile stays alive until
+     * the report has been written.
+     */
+    static EventProfile *create();
+
+    /** Charge a processed event. */
+    void record(const Event *event, Clock::duration elapsed);
+
+    /** Merge the profiles of all event queues and write the report. */
+    static void dump();
+
+  private:
+    EventProfile() {}
+
+    static bool _enabled;
+
+    std::unordered_map<std::string, Entry> entries;
+};
+
+#endif // __SIM_EVENT_PROFILE_HH__
@@ -41,6 +41,7 @@
 #include "cpu/smt.hh"
 #include "debug/Checkpoint.hh"
 #include "sim/core.hh"
+#include "sim/event_profile.hh"
 
 using namespace std;
 
@@ -219,7 +220,16 @@ EventQueue::serviceOne()
         setCurTick(event->when());
         if (DTRACE(Event))
             event->trace("executed");
-        event->process();
+        if (EventProfile::enabled()) {
+            if (!profile)
+                profile = EventProfile::create();
+            EventProfile::Clock::time_point start =
+                EventProfile::Clock::now();
+            event->process();
+            profile->record(event, EventProfile::Clock::now() - start);
+        } else {
+            event->process();
+        }
         if (event->isExitEvent()) {
             assert(!event->flags.isSet(Event::Managed) ||
                    !event->flags.isSet(Event::IsMainQueue)); // would be silly
@@ -419,7 +429,7 @@ Event::dump() const
 }
 
 EventQueue::EventQueue(const string &n)
-    : objName(n), head(NULL), _curTick(0)
+    : objName(n), head(NULL), _curTick(0), profile(NULL)
 {
 }
 
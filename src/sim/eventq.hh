@@ -50,6 +50,7 @@
 #include "debug/Event.hh"
 #include "sim/serialize.hh"
 
+class EventProfile;
 class EventQueue;       // forward declaration
 class BaseGlobalEvent;
 
@@ -621,6 +622,9 @@ class EventQueue
     Event *head;
     Tick _curTick;
 
+    //! Host time spent in the events of this queue, if profiling is on.
+    EventProfile *profile;
+
     //! Mutex to protect async queue.
     std::mutex async_queue_mutex;
 
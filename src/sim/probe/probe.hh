@@ -279,6 +279,12 @@ class ProbePointArg : public ProbePoint
                         listeners.end());
     }
 
+    /**
+     * @brief checks whether any listener is attached, e.g., to skip work
+     * that only serves the listeners.
+     */
+    bool hasListeners() const { return !listeners.empty(); }
+
     /**
      * @brief called at the ProbePoint call site, passes arg to each listener.
      * @param arg the argument to pass to each listener.
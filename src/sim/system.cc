@@ -215,7 +215,8 @@ System::System(Params *p)
       kvmVM(nullptr),
 #endif
       physmem(name() + ".physmem", p->memories, p->mmap_using_noreserve,
-              p->shared_backstore),
+              p->shared_backstore, p->mem_checkpoint_format,
+              p->mem_checkpoint_threads),
       memoryMode(p->mem_mode),
       _cacheLineSize(p->cache_line_size),
       workItemsBegin(0),
@@ -0,0 +1,337 @@
+#!/usr/bin/env python
+
+# Copyright (c) 2020 The Regents of the University of California
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#/
+
+# This script converts packet traces (packet.proto) and instruction
+# dependency traces (inst_dep_record.proto) between the protobuf format and
+# the memory-mapped trace format read by src/base/mapped_trace.hh.
+#
+# The mapped format stores the records in blocks of delta-encoded columns
+# with a block index at the end of the file, so that gem5 can decode the
+# records straight from the mapped file and start replaying at any tick or
+# sequence number. See src/base/mapped_trace.hh for the layout. The
+# identifier of the object that captured a trace and the id strings of a
+# packet trace are not kept.
+#
+# Usage:
+#   mapped_trace.py encode {packet,inst-dep} <protobuf in> <mapped out>
+#   mapped_trace.py decode <mapped in> <protobuf out>
+#
+# The protobuf output is compressed if its name ends with .gz. It assumes
+# that protoc has been executed and already generated the Python packages
+# for the messages, e.g.:
+# protoc --python_out=util --proto_path=src/proto src/proto/packet.proto
+
+from __future__ import print_function
+
+import argparse
+import gzip
+import struct
+import sys
+
+import protolib
+
+MAGIC = b'gem5mtrc'
+VERSION = 1
+PACKET_TRACE = 1
+INST_DEP_TRACE = 2
+
+# FileHeader and BlockIndex in src/base/mapped_trace.hh
+HEADER = struct.Struct('<8sIIQIIQQQQ')
+INDEX = struct.Struct('<QQQII')
+
+MAX_DELTA = 1 << 32
+
+def import_proto(name):
+    try:
+        return __import__(name)
+    except ImportError:
+        print("Failed to import %s, generate it with protoc" % name)
+        sys.exit(-1)
+
+def column(fmt, values):
+    return struct.pack('<%d%s' % (len(values), fmt), *values)
+
+def pad(data):
+    return data + b'\0' * (-len(data) % 8)
+
+class Writer(object):
+    """Write records to a mapped trace one block at a time."""
+
+    def __init__(self, out, kind, tick_freq, window_size, block_records):
+        self.out = out
+        self.kind = kind
+        self.tick_freq = tick_freq
+        self.window_size = window_size
+        self.block_records = block_records
+        self.num_records = 0
+        self.index = []
+        self.records = []
+        out.write(b'\0' * HEADER.size)
+
+    def add(self, key, record):
+        """Add a record, starting a new block when its key cannot be
+        encoded relative to the first key of the current block."""
+        if self.records:
+            delta = key - self.records[0][0]
+            if len(self.records) == self.block_records or \
+               not 0 <= delta < MAX_DELTA:
+                self.flush()
+        self.records.append((key, record))
+
+    def flush(self):
+        if not self.records:
+            return
+        first = self.records[0][0]
+        if self.kind == PACKET_TRACE:
+            data = self.encode_packets(first)
+        else:
+            data = self.encode_inst_deps(first)
+        data = pad(data)
+        self.index.append((first, self.num_records, self.out.tell(),
+                           len(self.records), len(data)))
+        self.out.write(data)
+        self.num_records += len(self.records)
+        self.records = []
+
+    def encode_packets(self, first):
+        pkts = [r for k, r in self.records]
+        return b''.join([
+            column('Q', [p.addr for p in pkts]),
+            column('Q', [p.pc for p in pkts]),
+            column('Q', [p.pkt_id for p in pkts]),
+            column('I', [k - first for k, r in self.records]),
+            column('I', [p.size for p in pkts]),
+            column('I', [p.flags for p in pkts]),
+            column('B', [p.cmd for p in pkts])])
+
+    def encode_inst_deps(self, first):
+        recs = [r for k, r in self.records]
+        rob_start = [0]
+        reg_start = [0]
+        rob_deps = []
+        reg_deps = []
+        for r in recs:
+            for deps, start, dep_list in ((rob_deps, rob_start, r.rob_dep),
+                                          (reg_deps, reg_start, r.reg_dep)):
+                for dep in dep_list:
+                    delta = r.seq_num - dep
+                    if not 0 < delta < MAX_DELTA:
+                        print("Seq. num %d has unsupported dependency %d" %
+                              (r.seq_num, dep))
+                        sys.exit(-1)
+                    deps.append(delta)
+                start.append(len(deps))
+        return b''.join([
+            column('Q', [r.comp_delay for r in recs]),
+            column('Q', [r.p_addr for r in recs]),
+            column('Q', [r.v_addr for r in recs]),
+            column('Q', [r.pc for r in recs]),
+            column('I', [r.seq_num - first for r in recs]),
+            column('I', [r.size for r in recs]),
+            column('I', [r.flags for r in recs]),
+            column('I', [r.weight for r in recs]),
+            column('I', [r.asid for r in recs]),
+            column('I', rob_start),
+            column('I', reg_start),
+            column('I', rob_deps),
+            column('I', reg_deps),
+            column('B', [r.type for r in recs])])
+
+    def close(self):
+        self.flush()
+        index_offset = self.out.tell()
+        for entry in self.index:
+            self.out.write(INDEX.pack(*entry))
+        self.out.seek(0)
+        self.out.write(HEADER.pack(MAGIC, VERSION, self.kind,
+                                   self.tick_freq, self.window_size,
+                                   self.block_records, self.num_records,
+                                   len(self.index), index_offset, 0))
+        self.out.close()
+
+def encode(args):
+    proto_in = protolib.openFileRd(args.input)
+    if proto_in.read(4) != b'gem5':
+        print("Unrecognized file", args.input)
+        sys.exit(-1)
+
+    if args.kind == 'packet':
+        packet_pb2 = import_proto('packet_pb2')
+        header = packet_pb2.PacketHeader()
+        protolib.decodeMessage(proto_in, header)
+        writer = Writer(open(args.output, 'wb'), PACKET_TRACE,
+                        header.tick_freq, 0, args.block_records)
+        key = lambda msg: msg.tick
+        msg_type = packet_pb2.Packet
+    else:
+        inst_dep_record_pb2 = import_proto('inst_dep_record_pb2')
+        header = inst_dep_record_pb2.InstDepRecordHeader()
+        protolib.decodeMessage(proto_in, header)
+        writer = Writer(open(args.output, 'wb'), INST_DEP_TRACE,
+                        header.tick_freq, header.window_size,
+                        args.block_records)
+        key = lambda msg: msg.seq_num
+        msg_type = inst_dep_record_pb2.InstDepRecord
+
+    msg = msg_type()
+    while protolib.decodeMessage(proto_in, msg):
+        writer.add(key(msg), msg)
+        msg = msg_type()
+    writer.close()
+    print("Wrote %d records in %d blocks" %
+          (writer.num_records, len(writer.index)))
+
+def unpack(fmt, data, offset, n):
+    values = struct.unpack_from('<%d%s' % (n, fmt), data, offset)
+    return values, offset + n * struct.calcsize(fmt)
+
+def decode_packets(data, first, n, packet_pb2):
+    offset = 0
+    addr, offset = unpack('Q', data, offset, n)
+    pc, offset = unpack('Q', data, offset, n)
+    pkt_id, offset = unpack('Q', data, offset, n)
+    tick, offset = unpack('I', data, offset, n)
+    size, offset = unpack('I', data, offset, n)
+    flags, offset = unpack('I', data, offset, n)
+    cmd, offset = unpack('B', data, offset, n)
+    for i in range(n):
+        msg = packet_pb2.Packet()
+        msg.tick = first + tick[i]
+        msg.cmd = cmd[i]
+        msg.addr = addr[i]
+        msg.size = size[i]
+        if flags[i]:
+            msg.flags = flags[i]
+        if pkt_id[i]:
+            msg.pkt_id = pkt_id[i]
+        if pc[i]:
+            msg.pc = pc[i]
+        yield msg
+
+def decode_inst_deps(data, first, n, inst_dep_record_pb2):
+    offset = 0
+    comp_delay, offset = unpack('Q', data, offset, n)
+    p_addr, offset = unpack('Q', data, offset, n)
+    v_addr, offset = unpack('Q', data, offset, n)
+    pc, offset = unpack('Q', data, offset, n)
+    seq_num, offset = unpack('I', data, offset, n)
+    size, offset = unpack('I', data, offset, n)
+    flags, offset = unpack('I', data, offset, n)
+    weight, offset = unpack('I', data, offset, n)
+    asid, offset = unpack('I', data, offset, n)
+    rob_start, offset = unpack('I', data, offset, n + 1)
+    reg_start, offset = unpack('I', data, offset, n + 1)
+    rob_deps, offset = unpack('I', data, offset, rob_start[n])
+    reg_deps, offset = unpack('I', data, offset, reg_start[n])
+    rec_type, offset = unpack('B', data, offset, n)
+    for i in range(n):
+        msg = inst_dep_record_pb2.InstDepRecord()
+        msg.seq_num = first + seq_num[i]
+        msg.type = rec_type[i]
+        msg.comp_delay = comp_delay[i]
+        for j in range(rob_start[i], rob_start[i + 1]):
+            msg.rob_dep.append(msg.seq_num - rob_deps[j])
+        for j in range(reg_start[i], reg_start[i + 1]):
+            msg.reg_dep.append(msg.seq_num - reg_deps[j])
+        for field, values in (('p_addr', p_addr), ('v_addr', v_addr),
+                              ('size', size), ('flags', flags),
+                              ('weight', weight), ('asid', asid),
+                              ('pc', pc)):
+            if values[i]:
+                setattr(msg, field, values[i])
+        yield msg
+
+def decode(args):
+    with open(args.input, 'rb') as f:
+        data = f.read()
+
+    (magic, version, kind, tick_freq, window_size, block_records,
+     num_records, num_blocks, index_offset, _) = HEADER.unpack_from(data)
+    if magic != MAGIC or version != VERSION:
+        print("Unrecognized file", args.input)
+        sys.exit(-1)
+
+    if args.output.endswith('.gz'):
+        proto_out = gzip.open(args.output, 'wb')
+    else:
+        proto_out = open(args.output, 'wb')
+    proto_out.write(b'gem5')
+
+    if kind == PACKET_TRACE:
+        module = import_proto('packet_pb2')
+        header = module.PacketHeader()
+        decode_block = decode_packets
+    else:
+        module = import_proto('inst_dep_record_pb2')
+        header = module.InstDepRecordHeader()
+        header.window_size = window_size
+        decode_block = decode_inst_deps
+    header.obj_id = args.input
+    header.tick_freq = tick_freq
+    protolib.encodeMessage(proto_out, header)
+
+    for i in range(num_blocks):
+        first, _, offset, n, size = \
+            INDEX.unpack_from(data, index_offset + i * INDEX.size)
+        for msg in decode_block(data[offset:offset + size], first, n,
+                                module):
+            protolib.encodeMessage(proto_out, msg)
+    proto_out.close()
+    print("Wrote %d records" % num_records)
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Convert traces between the protobuf and the mapped "
+                    "trace format")
+    subparsers = parser.add_subparsers(dest='command')
+
+    enc = subparsers.add_parser('encode',
+                                help="Convert a protobuf trace")
+    enc.add_argument('kind', choices=['packet', 'inst-dep'],
+                     help="Type of the records in the trace")
+    enc.add_argument('input', help="Protobuf trace to read")
+    enc.add_argument('output', help="Mapped trace to write")
+    enc.add_argument('--block-records', type=int, default=4096,
+                     help="Maximum number of records in a block")
+
+    dec = subparsers.add_parser('decode',
+                                help="Convert a mapped trace")
+    dec.add_argument('input', help="Mapped trace to read")
+    dec.add_argument('output', help="Protobuf trace to write")
+
+    args = parser.parse_args()
+    if args.command == 'encode':
+        encode(args)
+    elif args.command == 'decode':
+        decode(args)
+    else:
+        parser.print_help()
+
+if __name__ == "__main__":
+    main()